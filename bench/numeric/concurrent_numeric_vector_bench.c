@@ -0,0 +1,91 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector.h>
+
+#define TOTAL_ADDS 16000000
+#define MAX_THREADS 64
+
+typedef struct {
+    NumericVector *vector;
+    ConcurrentNumericVector *concurrent;
+    pthread_mutex_t *mutex;
+    size_t adds;
+} Job;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void *add_locked(void *arg)
+{
+    Job *job = (Job *) arg;
+    for (size_t i = 0; i < job->adds; ++i) {
+        pthread_mutex_lock(job->mutex);
+        numeric_vector_add(job->vector, (double) i);
+        pthread_mutex_unlock(job->mutex);
+    }
+
+    return NULL;
+}
+
+static void *add_concurrent(void *arg)
+{
+    Job *job = (Job *) arg;
+    for (size_t i = 0; i < job->adds; ++i) {
+        concurrent_numeric_vector_add(job->concurrent, (double) i);
+    }
+
+    return NULL;
+}
+
+static double run(size_t threads, void *(*routine)(void *), Job *job)
+{
+    pthread_t ids[MAX_THREADS];
+    double start = now();
+
+    for (size_t i = 0; i < threads; ++i) {
+        pthread_create(&ids[i], NULL, routine, job);
+    }
+
+    for (size_t i = 0; i < threads; ++i) {
+        pthread_join(ids[i], NULL);
+    }
+
+    return now() - start;
+}
+
+int main(void)
+{
+    printf("Running %s.\n", libvector_version());
+
+    for (size_t threads = 1; threads <= MAX_THREADS; threads *= 2) {
+        pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+        NumericVector vector;
+        ConcurrentNumericVector concurrent;
+        NumericVector frozen;
+        Job job = { &vector, &concurrent, &mutex, TOTAL_ADDS / threads };
+
+        /* Reserve up front, so the locked path measures contention and not numeric_vector_reserve(). */
+        numeric_vector_init(&vector, TOTAL_ADDS);
+        double locked = run(threads, add_locked, &job);
+        numeric_vector_free(&vector);
+
+        concurrent_numeric_vector_init(&concurrent, DEFAULT_RESIZE_VALUE);
+        double lock_free = run(threads, add_concurrent, &job);
+
+        double start = now();
+        concurrent_numeric_vector_freeze(&concurrent, &frozen);
+        double freeze = now() - start;
+        numeric_vector_free(&frozen);
+
+        printf("[BENCH]: %2li threads: mutex + numeric_vector_add(): %7.2f Mops/s, concurrent_numeric_vector_add(): %7.2f Mops/s, freeze: %.3f s\n",
+                threads, TOTAL_ADDS / locked / 1e6, TOTAL_ADDS / lock_free / 1e6, freeze);
+    }
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector.h>
+
+#define ITEMS 50000000
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double transform(double value, void *context)
+{
+    (void) context;
+    return sqrt(value) * 0.5 + 1;
+}
+
+static double sum(double accumulator, double value, void *context)
+{
+    (void) context;
+    return accumulator + value;
+}
+
+int main(int argc, char *argv[])
+{
+    printf("Running %s.\n", libvector_version());
+
+    size_t items = argc > 1 ? strtoul(argv[1], NULL, 10) : ITEMS;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    NumericVector vector;
+    numeric_vector_init(&vector, items);
+    for (size_t i = 0; i < items; ++i) {
+        numeric_vector_add(&vector, (double) i);
+    }
+
+    double start = now();
+    double serial = 0;
+    for (size_t i = 0; i < items; ++i) {
+        serial += vector.data[i];
+    }
+    printf("[BENCH]: serial sum: %.3f s\n", now() - start);
+
+    /* Reductions first, so every thread count reduces the same numbers. */
+    for (long threads = 1; threads <= cpus * 2; threads *= 2) {
+        double result = 0;
+        libvector_set_threads(threads);
+
+        start = now();
+        numeric_vector_parallel_reduce(&vector, sum, 0, NULL, &result);
+        double reduce = now() - start;
+
+        printf("[BENCH]: %2li threads: reduce: %.3f s (%.1f M items/s), result: %.17g\n",
+                threads, reduce, items / reduce / 1e6, result);
+    }
+
+    for (long threads = 1; threads <= cpus * 2; threads *= 2) {
+        libvector_set_threads(threads);
+
+        start = now();
+        numeric_vector_parallel_map(&vector, transform, NULL);
+        double map = now() - start;
+
+        printf("[BENCH]: %2li threads: map: %.3f s (%.1f M items/s)\n", threads, map, items / map / 1e6);
+    }
+
+    numeric_vector_free(&vector);
+    return 0;
+}
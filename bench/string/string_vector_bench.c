@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector.h>
+
+#define ITEMS 200000
+#define SHORT_LENGTH 8
+#define LONG_LENGTH 4096
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char *operation, size_t length, size_t items, double seconds)
+{
+    printf("[BENCH]: %-12s %5li bytes/item: %10.2f ns/item, %10.2f MB/s\n",
+            operation, length, seconds * 1e9 / items, (double) items * length / seconds / 1e6);
+}
+
+static void bench(size_t length, size_t items)
+{
+    char *value = (char *) malloc(length + 1);
+    memset(value, 'x', length);
+    value[length] = '\0';
+
+    const char **values = (const char **) malloc(items * sizeof(char *));
+    for (size_t i = 0; i < items; ++i) {
+        values[i] = value;
+    }
+
+    StringVector vector;
+    string_vector_init(&vector, DEFAULT_RESIZE_VALUE);
+    double start = now();
+    for (size_t i = 0; i < items; ++i) {
+        string_vector_add(&vector, value);
+    }
+    report("add", length, items, now() - start);
+
+    StringVector copy;
+    start = now();
+    string_vector_copy(&vector, &copy, true);
+    report("copy", length, items, now() - start);
+    string_vector_free(&copy);
+
+    start = now();
+    for (size_t i = 0; i < items; ++i) {
+        string_vector_replace(&vector, i, value);
+    }
+    report("replace", length, items, now() - start);
+
+    start = now();
+    string_vector_reserve(&vector, items);
+    report("reserve", length, items, now() - start);
+
+    start = now();
+    string_vector_shrink_to_fit(&vector);
+    report("shrink", length, items, now() - start);
+    string_vector_free(&vector);
+
+    string_vector_init(&vector, DEFAULT_RESIZE_VALUE);
+    start = now();
+    string_vector_add_array(&vector, values, items);
+    report("add_array", length, items, now() - start);
+
+    size_t inserts = items / 100;
+    start = now();
+    for (size_t i = 0; i < inserts; ++i) {
+        string_vector_insert(&vector, value, 0);
+    }
+    report("insert", length, inserts, now() - start);
+    string_vector_free(&vector);
+
+    free(values);
+    free(value);
+}
+
+int main(void)
+{
+    printf("Running %s.\n", libvector_version());
+
+    bench(SHORT_LENGTH, ITEMS);
+    bench(LONG_LENGTH, ITEMS / 10);
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector.h>
+
+#define ITEMS 5000000
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Items are added one by one, so each of them has its own allocation. */
+static void fill(StringVector *vector, size_t items)
+{
+    char value[32];
+
+    string_vector_init(vector, items);
+    for (size_t i = 0; i < items; ++i) {
+        snprintf(value, sizeof(value), "config.key.%li", i);
+        string_vector_add(vector, value);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    printf("Running %s.\n", libvector_version());
+
+    size_t items = argc > 1 ? strtoul(argv[1], NULL, 10) : ITEMS;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    StringVector vector;
+    StringVector copy;
+
+    fill(&vector, items);
+
+    double start = now();
+    string_vector_copy(&vector, &copy, true);
+    printf("[BENCH]: string_vector_copy() %li items: %.3f s\n", items, now() - start);
+    string_vector_free(&copy);
+
+    for (long threads = 1; threads <= cpus * 2; threads *= 2) {
+        libvector_set_threads(threads);
+
+        start = now();
+        string_vector_parallel_copy(&vector, &copy, true);
+        printf("[BENCH]: string_vector_parallel_copy() %li items, %2li threads: %.3f s\n", items, threads, now() - start);
+        string_vector_free(&copy);
+    }
+
+    start = now();
+    string_vector_free(&vector);
+    printf("[BENCH]: string_vector_free() %li items: %.3f s\n", items, now() - start);
+
+    for (long threads = 1; threads <= cpus * 2; threads *= 2) {
+        libvector_set_threads(threads);
+        fill(&vector, items);
+
+        start = now();
+        string_vector_parallel_free(&vector);
+        printf("[BENCH]: string_vector_parallel_free() %li items, %2li threads: %.3f s\n", items, threads, now() - start);
+    }
+
+    return 0;
+}
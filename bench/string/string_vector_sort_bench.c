@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector.h>
+
+#define KEYS 10000000
+#define KEY_LENGTH 16
+#define DISTINCT_KEYS 4 /* For the run where most keys are duplicates. */
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int compare(const void *a, const void *b)
+{
+    return strcmp(*(const char **) a, *(const char **) b);
+}
+
+int main(int argc, char *argv[])
+{
+    printf("Running %s.\n", libvector_version());
+
+    size_t keys = argc > 1 ? strtoul(argv[1], NULL, 10) : KEYS;
+    char *buffer = (char *) malloc(keys * (KEY_LENGTH + 1));
+    const char **values = (const char **) malloc(keys * sizeof(char *));
+    size_t *permutation = (size_t *) malloc(keys * sizeof(size_t));
+
+    /* Keys share a few leading bytes, as real-world keys (paths, URLs, ids) usually do. */
+    srand(42);
+    for (size_t i = 0; i < keys; ++i) {
+        char *key = buffer + i * (KEY_LENGTH + 1);
+        memcpy(key, "key:", 4);
+        for (size_t j = 4; j < KEY_LENGTH; ++j) {
+            key[j] = 'a' + rand() % 26;
+        }
+        key[KEY_LENGTH] = '\0';
+        values[i] = key;
+    }
+
+    StringVector vector;
+    string_vector_init(&vector, keys);
+    string_vector_add_array(&vector, values, keys);
+
+    double start = now();
+    string_vector_sort_permutation(&vector, permutation, true);
+    printf("[BENCH]: sort_permutation (stable) %li keys: %.3f s\n", keys, now() - start);
+
+    StringVector copy;
+    string_vector_copy(&vector, &copy, true);
+    start = now();
+    string_vector_sort(&copy, true);
+    printf("[BENCH]: sort (stable) %li keys: %.3f s\n", keys, now() - start);
+    string_vector_free(&copy);
+
+    start = now();
+    string_vector_sort(&vector, false);
+    printf("[BENCH]: sort %li keys: %.3f s\n", keys, now() - start);
+
+    start = now();
+    qsort(values, keys, sizeof(char *), compare);
+    printf("[BENCH]: qsort() + strcmp() %li keys: %.3f s\n", keys, now() - start);
+
+    string_vector_free(&vector);
+
+    /* Few distinct keys, so that stable sorts order big groups of identical items by position. */
+    for (size_t i = 0; i < keys; ++i) {
+        values[i] = buffer + (i % DISTINCT_KEYS) * (KEY_LENGTH + 1);
+    }
+
+    string_vector_init(&vector, keys);
+    string_vector_add_array(&vector, values, keys);
+
+    start = now();
+    string_vector_sort_permutation(&vector, permutation, true);
+    printf("[BENCH]: sort_permutation (stable) %li keys, %i distinct: %.3f s\n", keys, DISTINCT_KEYS, now() - start);
+
+    start = now();
+    string_vector_sort(&vector, true);
+    printf("[BENCH]: sort (stable) %li keys, %i distinct: %.3f s\n", keys, DISTINCT_KEYS, now() - start);
+
+    string_vector_free(&vector);
+    free(permutation);
+    free(values);
+    free(buffer);
+    return 0;
+}
@@ -0,0 +1,1109 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+/* Each operation runs on vectors adding up to TARGET_ITEMS items, and at least MIN_RUNS times. */
+#define MIN_SIZE 10
+#define DEFAULT_MAX_SIZE 100000
+#define TARGET_ITEMS 1000000
+#define MIN_RUNS 3
+
+/* Per-item operations are timed in groups, as a single call may take less than the clock's resolution. */
+#define LATENCY_GROUP 64
+
+/* Inserts and erases move every item after them, so only a few of them are done on big vectors. */
+#define MAX_EDITS 1000
+#define EDIT_WORK 10000000
+
+/* Checkpoints save an operation's items spread over up to this many vectors. */
+#define CHECKPOINT_VECTORS 100
+/* Bytes logged between syncs of a journal. */
+#define JOURNAL_SYNC_BYTES (1 << 20)
+
+#define STRING_VALUE "benchmark value!"
+#define DEFAULT_THRESHOLD 10.0
+#define MAX_RESULTS 512
+
+/* Hardware and software counters read around every timed section, when the kernel lets us. */
+#define COUNTERS 5
+
+typedef union {
+    NumericVector numeric;
+    StringVector string;
+} BenchVector;
+
+/* The operations measured, over either vector type. */
+typedef struct {
+    const char *name;
+    bool (*init)(BenchVector *vector, size_t capacity);
+    void (*free)(BenchVector *vector);
+    bool (*add)(BenchVector *vector, size_t i);
+    bool (*add_array)(BenchVector *vector, size_t n);
+    bool (*insert)(BenchVector *vector, size_t position);
+    bool (*erase)(BenchVector *vector, size_t start, size_t length);
+    bool (*reserve)(BenchVector *vector, size_t spaces);
+    bool (*shrink_to_fit)(BenchVector *vector);
+    bool (*copy)(BenchVector *source, BenchVector *destination, bool initialize);
+    double (*get_at)(BenchVector *vector, size_t position);
+    void (*print)(BenchVector *vector);
+    bool (*write)(BenchVector *vector, int fd);
+    bool (*save)(VectorIO *io, BenchVector *vector, int fd, uint64_t offset, uint64_t *size, size_t *saved);
+    bool (*load)(VectorIO *io, BenchVector *vector, int fd, uint64_t offset, size_t *loaded);
+    bool (*open_journal)(BenchVector *vector, const char *path, size_t sync_bytes);
+    bool (*close_journal)(BenchVector *vector);
+} BenchType;
+
+typedef struct {
+    double *latencies; /* ns per item, one per timed group. */
+    size_t count;
+    size_t capacity;
+    double seconds;
+    size_t items;
+    size_t runs;
+    double counters[COUNTERS];
+    double counter_starts[COUNTERS];
+} Samples;
+
+typedef struct {
+    char type[16];
+    char operation[32];
+    size_t size;
+    size_t runs;
+    double items_per_second;
+    double ns_per_item;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+    double counters[COUNTERS]; /* Per item, negative when unavailable. */
+} Result;
+
+typedef void (*BenchOperation)(const BenchType *type, size_t size, Samples *samples);
+
+static double *numeric_values;
+static const char **string_values;
+static volatile double sink;
+
+static const char *counter_names[COUNTERS] = {"cycles", "instructions", "llc_misses", "branch_misses", "page_faults"};
+static int counter_fds[COUNTERS] = {-1, -1, -1, -1, -1};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Counters only count user space, which is all that an unprivileged process may count. The
+ * kernel may share hardware counters among events, so values are scaled by the time they ran.
+ */
+static void counters_open(void)
+{
+#ifdef __linux__
+    const struct {
+        uint32_t type;
+        uint64_t config;
+    } events[COUNTERS] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}
+    };
+
+    for (size_t i = 0; i < COUNTERS; ++i) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = events[i].type;
+        attr.config = events[i].config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        counter_fds[i] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (counter_fds[i] < 0) {
+            printf("[BENCH]: Counter %s is unavailable: %s.\n", counter_names[i], strerror(errno));
+        }
+    }
+#else
+    printf("[BENCH]: Counters are only available on Linux.\n");
+#endif
+}
+
+static void counters_close(void)
+{
+    for (size_t i = 0; i < COUNTERS; ++i) {
+        if (counter_fds[i] >= 0) {
+#ifdef __linux__
+            close(counter_fds[i]);
+#endif
+            counter_fds[i] = -1;
+        }
+    }
+}
+
+static double counter_read(size_t counter)
+{
+    uint64_t values[3] = {0};
+
+#ifdef __linux__
+    if (read(counter_fds[counter], values, sizeof(values)) != sizeof(values) || values[2] == 0) {
+        return 0;
+    }
+#endif
+
+    return (double) values[0] * values[1] / values[2];
+}
+
+static void counters_start(Samples *samples)
+{
+    for (size_t i = 0; i < COUNTERS; ++i) {
+        if (counter_fds[i] >= 0) {
+            samples->counter_starts[i] = counter_read(i);
+        }
+    }
+}
+
+static void counters_stop(Samples *samples)
+{
+    for (size_t i = 0; i < COUNTERS; ++i) {
+        if (counter_fds[i] >= 0) {
+            samples->counters[i] += counter_read(i) - samples->counter_starts[i];
+        }
+    }
+}
+
+/* Counts the saves and loads done, which a checkpoint waits for. */
+static void count_transfer(void *context, bool succeeded)
+{
+    *(size_t *) context += succeeded ? 1 : 0;
+}
+
+static bool numeric_init(BenchVector *vector, size_t capacity)
+{
+    return numeric_vector_init(&vector->numeric, capacity);
+}
+
+static void numeric_free(BenchVector *vector)
+{
+    numeric_vector_free(&vector->numeric);
+}
+
+static bool numeric_add(BenchVector *vector, size_t i)
+{
+    return numeric_vector_add(&vector->numeric, (double) i);
+}
+
+static bool numeric_add_array(BenchVector *vector, size_t n)
+{
+    return numeric_vector_add_array(&vector->numeric, numeric_values, n);
+}
+
+static bool numeric_insert(BenchVector *vector, size_t position)
+{
+    return numeric_vector_insert(&vector->numeric, 1.0, position);
+}
+
+static bool numeric_erase(BenchVector *vector, size_t start, size_t length)
+{
+    return numeric_vector_erase(&vector->numeric, start, length);
+}
+
+static bool numeric_reserve(BenchVector *vector, size_t spaces)
+{
+    return numeric_vector_reserve(&vector->numeric, spaces);
+}
+
+static bool numeric_shrink_to_fit(BenchVector *vector)
+{
+    return numeric_vector_shrink_to_fit(&vector->numeric);
+}
+
+static bool numeric_copy(BenchVector *source, BenchVector *destination, bool initialize)
+{
+    return numeric_vector_copy(&source->numeric, &destination->numeric, initialize);
+}
+
+static double numeric_get_at(BenchVector *vector, size_t position)
+{
+    return numeric_vector_get_at(&vector->numeric, position);
+}
+
+static void numeric_print(BenchVector *vector)
+{
+    numeric_vector_print(&vector->numeric);
+}
+
+static bool numeric_write(BenchVector *vector, int fd)
+{
+    return numeric_vector_write(&vector->numeric, fd, NULL);
+}
+
+static bool numeric_save(VectorIO *io, BenchVector *vector, int fd, uint64_t offset, uint64_t *size, size_t *saved)
+{
+    return numeric_vector_save_async(io, &vector->numeric, fd, offset, size, count_transfer, saved);
+}
+
+static bool numeric_load(VectorIO *io, BenchVector *vector, int fd, uint64_t offset, size_t *loaded)
+{
+    return numeric_vector_load_async(io, &vector->numeric, fd, offset, NULL, count_transfer, loaded);
+}
+
+static bool numeric_open_journal(BenchVector *vector, const char *path, size_t sync_bytes)
+{
+    return numeric_vector_open_journal(&vector->numeric, path, sync_bytes);
+}
+
+static bool numeric_close_journal(BenchVector *vector)
+{
+    return numeric_vector_close_journal(&vector->numeric);
+}
+
+static bool string_init(BenchVector *vector, size_t capacity)
+{
+    return string_vector_init(&vector->string, capacity);
+}
+
+static void string_free(BenchVector *vector)
+{
+    string_vector_free(&vector->string);
+}
+
+static bool string_add(BenchVector *vector, size_t i)
+{
+    (void) i;
+    return string_vector_add(&vector->string, STRING_VALUE);
+}
+
+static bool string_add_array(BenchVector *vector, size_t n)
+{
+    return string_vector_add_array(&vector->string, string_values, n);
+}
+
+static bool string_insert(BenchVector *vector, size_t position)
+{
+    return string_vector_insert(&vector->string, STRING_VALUE, position);
+}
+
+static bool string_erase(BenchVector *vector, size_t start, size_t length)
+{
+    return string_vector_erase(&vector->string, start, length);
+}
+
+static bool string_reserve(BenchVector *vector, size_t spaces)
+{
+    return string_vector_reserve(&vector->string, spaces);
+}
+
+static bool string_shrink_to_fit(BenchVector *vector)
+{
+    return string_vector_shrink_to_fit(&vector->string);
+}
+
+static bool string_copy(BenchVector *source, BenchVector *destination, bool initialize)
+{
+    return string_vector_copy(&source->string, &destination->string, initialize);
+}
+
+static double string_get_at(BenchVector *vector, size_t position)
+{
+    return (double) string_vector_get_at(&vector->string, position)[0];
+}
+
+static void string_print(BenchVector *vector)
+{
+    string_vector_print(&vector->string);
+}
+
+static bool string_write(BenchVector *vector, int fd)
+{
+    return string_vector_write(&vector->string, fd, NULL);
+}
+
+static bool string_save(VectorIO *io, BenchVector *vector, int fd, uint64_t offset, uint64_t *size, size_t *saved)
+{
+    return string_vector_save_async(io, &vector->string, fd, offset, size, count_transfer, saved);
+}
+
+static bool string_load(VectorIO *io, BenchVector *vector, int fd, uint64_t offset, size_t *loaded)
+{
+    return string_vector_load_async(io, &vector->string, fd, offset, NULL, count_transfer, loaded);
+}
+
+static bool string_open_journal(BenchVector *vector, const char *path, size_t sync_bytes)
+{
+    return string_vector_open_journal(&vector->string, path, sync_bytes);
+}
+
+static bool string_close_journal(BenchVector *vector)
+{
+    return string_vector_close_journal(&vector->string);
+}
+
+static const BenchType types[] = {
+    {
+        "numeric", numeric_init, numeric_free, numeric_add, numeric_add_array, numeric_insert, numeric_erase,
+        numeric_reserve, numeric_shrink_to_fit, numeric_copy, numeric_get_at, numeric_print, numeric_write,
+        numeric_save, numeric_load, numeric_open_journal, numeric_close_journal
+    },
+    {
+        "string", string_init, string_free, string_add, string_add_array, string_insert, string_erase,
+        string_reserve, string_shrink_to_fit, string_copy, string_get_at, string_print, string_write,
+        string_save, string_load, string_open_journal, string_close_journal
+    }
+};
+
+static void record(Samples *samples, double seconds, size_t items)
+{
+    if (samples->count == samples->capacity) {
+        samples->capacity = samples->capacity == 0 ? 1024 : samples->capacity * 2;
+        samples->latencies = (double *) realloc(samples->latencies, samples->capacity * sizeof(double));
+
+        if (samples->latencies == NULL) {
+            fprintf(stderr, "[BENCH]: Out of memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    samples->latencies[samples->count++] = seconds * 1e9 / items;
+    samples->seconds += seconds;
+    samples->items += items;
+}
+
+static void fill(const BenchType *type, BenchVector *vector, size_t size)
+{
+    if (!type->init(vector, size) || !type->add_array(vector, size)) {
+        fprintf(stderr, "[BENCH]: Couldn't fill a %s vector with %li items.\n", type->name, size);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static size_t edits(size_t size)
+{
+    size_t count = EDIT_WORK / size;
+    count = count > MAX_EDITS ? MAX_EDITS : count;
+    count = count > size ? size : count;
+    return count == 0 ? 1 : count;
+}
+
+static void bench_add(const BenchType *type, size_t size, Samples *samples)
+{
+    BenchVector vector;
+    type->init(&vector, DEFAULT_RESIZE_VALUE);
+
+    counters_start(samples);
+    for (size_t i = 0; i < size; i += LATENCY_GROUP) {
+        size_t end = i + LATENCY_GROUP > size ? size : i + LATENCY_GROUP;
+        double start = now();
+        for (size_t j = i; j < end; ++j) {
+            type->add(&vector, j);
+        }
+        record(samples, now() - start, end - i);
+    }
+    counters_stop(samples);
+
+    type->free(&vector);
+}
+
+static void bench_add_array(const BenchType *type, size_t size, Samples *samples)
+{
+    BenchVector vector;
+    type->init(&vector, DEFAULT_RESIZE_VALUE);
+
+    counters_start(samples);
+    double start = now();
+    type->add_array(&vector, size);
+    record(samples, now() - start, size);
+    counters_stop(samples);
+
+    type->free(&vector);
+}
+
+static void bench_insert_at(const BenchType *type, size_t size, Samples *samples, int where)
+{
+    BenchVector vector;
+    fill(type, &vector, size);
+    size_t count = edits(size);
+
+    counters_start(samples);
+    for (size_t i = 0; i < count; i += LATENCY_GROUP) {
+        size_t end = i + LATENCY_GROUP > count ? count : i + LATENCY_GROUP;
+        double start = now();
+        for (size_t j = i; j < end; ++j) {
+            size_t items = size + j;
+            type->insert(&vector, where == 0 ? 0 : where == 1 ? items / 2 : items);
+        }
+        record(samples, now() - start, end - i);
+    }
+    counters_stop(samples);
+
+    type->free(&vector);
+}
+
+static void bench_insert_front(const BenchType *type, size_t size, Samples *samples)
+{
+    bench_insert_at(type, size, samples, 0);
+}
+
+static void bench_insert_middle(const BenchType *type, size_t size, Samples *samples)
+{
+    bench_insert_at(type, size, samples, 1);
+}
+
+static void bench_insert_back(const BenchType *type, size_t size, Samples *samples)
+{
+    bench_insert_at(type, size, samples, 2);
+}
+
+/* Erases single items from the middle. */
+static void bench_erase(const BenchType *type, size_t size, Samples *samples)
+{
+    BenchVector vector;
+    fill(type, &vector, size);
+    size_t count = edits(size);
+
+    counters_start(samples);
+    for (size_t i = 0; i < count; i += LATENCY_GROUP) {
+        size_t end = i + LATENCY_GROUP > count ? count : i + LATENCY_GROUP;
+        double start = now();
+        for (size_t j = i; j < end; ++j) {
+            type->erase(&vector, (size - j) / 2, 1);
+        }
+        record(samples, now() - start, end - i);
+    }
+    counters_stop(samples);
+
+    type->free(&vector);
+}
+
+static void bench_reserve(const BenchType *type, size_t size, Samples *samples)
+{
+    BenchVector vector;
+    fill(type, &vector, size);
+
+    counters_start(samples);
+    double start = now();
+    type->reserve(&vector, size);
+    record(samples, now() - start, size);
+    counters_stop(samples);
+
+    type->free(&vector);
+}
+
+static void bench_shrink_to_fit(const BenchType *type, size_t size, Samples *samples)
+{
+    BenchVector vector;
+    fill(type, &vector, size);
+    type->reserve(&vector, size);
+
+    counters_start(samples);
+    double start = now();
+    type->shrink_to_fit(&vector);
+    record(samples, now() - start, size);
+    counters_stop(samples);
+
+    type->free(&vector);
+}
+
+/* Copies into an initialized vector, so items are really copied. */
+static void bench_copy(const BenchType *type, size_t size, Samples *samples)
+{
+    BenchVector vector;
+    BenchVector copy;
+    fill(type, &vector, size);
+    type->init(&copy, size);
+
+    counters_start(samples);
+    double start = now();
+    type->copy(&vector, &copy, false);
+    record(samples, now() - start, size);
+    counters_stop(samples);
+
+    type->free(&copy);
+    type->free(&vector);
+}
+
+/* Copies into a new vector, which shares items with the original until either one is modified. */
+static void bench_copy_shared(const BenchType *type, size_t size, Samples *samples)
+{
+    BenchVector vector;
+    BenchVector copy;
+    fill(type, &vector, size);
+
+    counters_start(samples);
+    double start = now();
+    type->copy(&vector, &copy, true);
+    record(samples, now() - start, size);
+    counters_stop(samples);
+
+    type->free(&copy);
+    type->free(&vector);
+}
+
+static void bench_get_at(const BenchType *type, size_t size, Samples *samples)
+{
+    BenchVector vector;
+    fill(type, &vector, size);
+    double sum = 0;
+
+    counters_start(samples);
+    for (size_t i = 0; i < size; i += LATENCY_GROUP) {
+        size_t end = i + LATENCY_GROUP > size ? size : i + LATENCY_GROUP;
+        double start = now();
+        for (size_t j = i; j < end; ++j) {
+            sum += type->get_at(&vector, j);
+        }
+        record(samples, now() - start, end - i);
+    }
+    counters_stop(samples);
+
+    sink = sum;
+    type->free(&vector);
+}
+
+static void bench_free(const BenchType *type, size_t size, Samples *samples)
+{
+    BenchVector vector;
+    fill(type, &vector, size);
+
+    counters_start(samples);
+    double start = now();
+    type->free(&vector);
+    record(samples, now() - start, size);
+    counters_stop(samples);
+}
+
+/* Printing goes to /dev/null through stdout, so it's measured the same way as writing. */
+static void bench_print(const BenchType *type, size_t size, Samples *samples)
+{
+    BenchVector vector;
+    fill(type, &vector, size);
+
+    int null_fd = open("/dev/null", O_WRONLY);
+    int stdout_fd = dup(STDOUT_FILENO);
+    fflush(stdout);
+    dup2(null_fd, STDOUT_FILENO);
+
+    counters_start(samples);
+    double start = now();
+    type->print(&vector);
+    fflush(stdout);
+    record(samples, now() - start, size);
+    counters_stop(samples);
+
+    dup2(stdout_fd, STDOUT_FILENO);
+    close(stdout_fd);
+    close(null_fd);
+    type->free(&vector);
+}
+
+static void bench_write(const BenchType *type, size_t size, Samples *samples)
+{
+    BenchVector vector;
+    fill(type, &vector, size);
+    int null_fd = open("/dev/null", O_WRONLY);
+
+    counters_start(samples);
+    double start = now();
+    if (!type->write(&vector, null_fd)) {
+        fprintf(stderr, "[BENCH]: Couldn't write a %s vector with %li items.\n", type->name, size);
+        exit(EXIT_FAILURE);
+    }
+    record(samples, now() - start, size);
+    counters_stop(samples);
+
+    close(null_fd);
+    type->free(&vector);
+}
+
+/* Saves every vector back to back in fd, each one at offsets[i], and waits for all of them to be written. */
+static void checkpoint(const BenchType *type, VectorIO *io, BenchVector *vectors, size_t count, int fd, uint64_t *offsets)
+{
+    uint64_t offset = 0;
+    size_t saved = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t size = 0;
+        offsets[i] = offset;
+
+        if (!type->save(io, &vectors[i], fd, offset, &size, &saved)) {
+            break;
+        }
+
+        offset += size;
+    }
+
+    vector_io_poll(io, true);
+
+    if (saved != count) {
+        fprintf(stderr, "[BENCH]: Couldn't save %li %s vectors.\n", count, type->name);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* A checkpoint of size items spread over up to CHECKPOINT_VECTORS vectors, timed from the first save
+ * submitted until the last one is written. restore times loading them back instead.
+ */
+static void bench_checkpoint_with(const BenchType *type, size_t size, Samples *samples, bool threads_only, bool restore)
+{
+    size_t count = size < CHECKPOINT_VECTORS ? size : CHECKPOINT_VECTORS;
+    BenchVector *vectors = (BenchVector *) malloc(count * sizeof(BenchVector));
+    uint64_t *offsets = (uint64_t *) malloc(count * sizeof(uint64_t));
+    char path[] = "/tmp/vector_bench_XXXXXX";
+    int fd = mkstemp(path);
+    VectorIO *io = vector_io_create(count, threads_only);
+
+    if (vectors == NULL || offsets == NULL || fd < 0 || io == NULL) {
+        fprintf(stderr, "[BENCH]: Couldn't set up a checkpoint of %li %s vectors.\n", count, type->name);
+        exit(EXIT_FAILURE);
+    }
+
+    unlink(path);
+
+    for (size_t i = 0; i < count; ++i) {
+        fill(type, &vectors[i], size / count);
+    }
+
+    if (restore) {
+        checkpoint(type, io, vectors, count, fd, offsets);
+
+        for (size_t i = 0; i < count; ++i) {
+            type->free(&vectors[i]);
+            type->init(&vectors[i], 1);
+        }
+    }
+
+    counters_start(samples);
+    double start = now();
+
+    if (restore) {
+        size_t loaded = 0;
+
+        for (size_t i = 0; i < count; ++i) {
+            type->load(io, &vectors[i], fd, offsets[i], &loaded);
+        }
+
+        vector_io_poll(io, true);
+
+        if (loaded != count) {
+            fprintf(stderr, "[BENCH]: Couldn't load %li %s vectors.\n", count, type->name);
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        checkpoint(type, io, vectors, count, fd, offsets);
+    }
+
+    record(samples, now() - start, size);
+    counters_stop(samples);
+
+    vector_io_destroy(io);
+    close(fd);
+
+    for (size_t i = 0; i < count; ++i) {
+        type->free(&vectors[i]);
+    }
+
+    free(offsets);
+    free(vectors);
+}
+
+static void bench_checkpoint(const BenchType *type, size_t size, Samples *samples)
+{
+    bench_checkpoint_with(type, size, samples, false, false);
+}
+
+static void bench_checkpoint_threads(const BenchType *type, size_t size, Samples *samples)
+{
+    bench_checkpoint_with(type, size, samples, true, false);
+}
+
+static void bench_restore(const BenchType *type, size_t size, Samples *samples)
+{
+    bench_checkpoint_with(type, size, samples, false, true);
+}
+
+/* Adds size items to a journaled vector, syncing every JOURNAL_SYNC_BYTES. recover times opening the
+ * journal again, which replays them all from the log.
+ */
+static void bench_journal_with(const BenchType *type, size_t size, Samples *samples, bool recover)
+{
+    char directory[] = "/tmp/vector_bench_XXXXXX";
+    char path[sizeof(directory) + 16];
+    char log_path[sizeof(path) + 4];
+    BenchVector vector;
+
+    if (mkdtemp(directory) == NULL) {
+        fprintf(stderr, "[BENCH]: Couldn't set up a journal of %li %s items.\n", size, type->name);
+        exit(EXIT_FAILURE);
+    }
+
+    snprintf(path, sizeof(path), "%s/journal", directory);
+    snprintf(log_path, sizeof(log_path), "%s.log", path);
+    type->init(&vector, DEFAULT_RESIZE_VALUE);
+
+    if (!type->open_journal(&vector, path, JOURNAL_SYNC_BYTES)) {
+        fprintf(stderr, "[BENCH]: Couldn't open a journal for a %s vector.\n", type->name);
+        exit(EXIT_FAILURE);
+    }
+
+    if (recover) {
+        for (size_t i = 0; i < size; ++i) {
+            type->add(&vector, i);
+        }
+
+        type->close_journal(&vector);
+        type->free(&vector);
+        type->init(&vector, 1);
+
+        counters_start(samples);
+        double start = now();
+        if (!type->open_journal(&vector, path, JOURNAL_SYNC_BYTES)) {
+            fprintf(stderr, "[BENCH]: Couldn't recover a %s vector with %li items.\n", type->name, size);
+            exit(EXIT_FAILURE);
+        }
+        record(samples, now() - start, size);
+        counters_stop(samples);
+    } else {
+        counters_start(samples);
+        for (size_t i = 0; i < size; i += LATENCY_GROUP) {
+            size_t end = i + LATENCY_GROUP > size ? size : i + LATENCY_GROUP;
+            double start = now();
+            for (size_t j = i; j < end; ++j) {
+                type->add(&vector, j);
+            }
+            record(samples, now() - start, end - i);
+        }
+        counters_stop(samples);
+    }
+
+    type->close_journal(&vector);
+    type->free(&vector);
+    unlink(log_path);
+    unlink(path);
+    rmdir(directory);
+}
+
+static void bench_journal(const BenchType *type, size_t size, Samples *samples)
+{
+    bench_journal_with(type, size, samples, false);
+}
+
+static void bench_recover(const BenchType *type, size_t size, Samples *samples)
+{
+    bench_journal_with(type, size, samples, true);
+}
+
+static const struct {
+    const char *name;
+    BenchOperation run;
+} operations[] = {
+    {"add", bench_add},
+    {"add_array", bench_add_array},
+    {"insert_front", bench_insert_front},
+    {"insert_middle", bench_insert_middle},
+    {"insert_back", bench_insert_back},
+    {"erase", bench_erase},
+    {"reserve", bench_reserve},
+    {"shrink_to_fit", bench_shrink_to_fit},
+    {"copy", bench_copy},
+    {"copy_shared", bench_copy_shared},
+    {"get_at", bench_get_at},
+    {"print", bench_print},
+    {"write", bench_write},
+    {"checkpoint", bench_checkpoint},
+    {"checkpoint_threads", bench_checkpoint_threads},
+    {"restore", bench_restore},
+    {"journal", bench_journal},
+    {"recover", bench_recover},
+    {"free", bench_free}
+};
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const Samples *samples, double p)
+{
+    size_t at = (size_t) (p * (samples->count - 1) + 0.5);
+    return samples->latencies[at];
+}
+
+static Result measure(const BenchType *type, const char *operation, BenchOperation run, size_t size)
+{
+    Samples samples = {0};
+
+    while (samples.runs < MIN_RUNS || samples.runs * size < TARGET_ITEMS) {
+        run(type, size, &samples);
+        ++samples.runs;
+    }
+
+    qsort(samples.latencies, samples.count, sizeof(double), compare_doubles);
+
+    Result result = {0};
+    snprintf(result.type, sizeof(result.type), "%s", type->name);
+    snprintf(result.operation, sizeof(result.operation), "%s", operation);
+    result.size = size;
+    result.runs = samples.runs;
+    result.items_per_second = samples.items / samples.seconds;
+    result.ns_per_item = samples.seconds * 1e9 / samples.items;
+    result.p50 = percentile(&samples, 0.50);
+    result.p90 = percentile(&samples, 0.90);
+    result.p99 = percentile(&samples, 0.99);
+    result.max = samples.latencies[samples.count - 1];
+
+    for (size_t i = 0; i < COUNTERS; ++i) {
+        result.counters[i] = counter_fds[i] >= 0 ? samples.counters[i] / samples.items : -1;
+    }
+
+    free(samples.latencies);
+    return result;
+}
+
+static void write_json(FILE *file, const Result *results, size_t count)
+{
+    /* One result per line, which is what read_baseline() expects. */
+    fprintf(file, "{\n  \"library\": \"%s\",\n  \"results\": [\n", libvector_version());
+
+    for (size_t i = 0; i < count; ++i) {
+        const Result *r = &results[i];
+        fprintf(
+                file,
+                "    {\"type\": \"%s\", \"operation\": \"%s\", \"size\": %li, \"runs\": %li, "
+                "\"items_per_second\": %.6g, \"ns_per_item\": %.6g, "
+                "\"latency_ns\": {\"p50\": %.6g, \"p90\": %.6g, \"p99\": %.6g, \"max\": %.6g}, \"per_item\": {",
+                r->type, r->operation, r->size, r->runs, r->items_per_second, r->ns_per_item,
+                r->p50, r->p90, r->p99, r->max
+        );
+
+        for (size_t c = 0; c < COUNTERS; ++c) {
+            if (r->counters[c] < 0) {
+                fprintf(file, "%s\"%s\": null", c > 0 ? ", " : "", counter_names[c]);
+            } else {
+                fprintf(file, "%s\"%s\": %.6g", c > 0 ? ", " : "", counter_names[c], r->counters[c]);
+            }
+        }
+
+        fprintf(file, "}}%s\n", i + 1 < count ? "," : "");
+    }
+
+    fprintf(file, "  ]\n}\n");
+}
+
+static size_t read_baseline(const char *path, Result *results, size_t max)
+{
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) {
+        fprintf(stderr, "[BENCH]: Couldn't open baseline: %s.\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    char line[1024];
+    size_t count = 0;
+
+    while (count < max && fgets(line, sizeof(line), file) != NULL) {
+        Result *r = &results[count];
+
+        if (sscanf(
+                line,
+                " {\"type\": \"%15[^\"]\", \"operation\": \"%31[^\"]\", \"size\": %zu, \"runs\": %zu, "
+                "\"items_per_second\": %lf, \"ns_per_item\": %lf, \"latency_ns\": {\"p50\": %lf",
+                r->type, r->operation, &r->size, &r->runs, &r->items_per_second, &r->ns_per_item, &r->p50) == 7)
+        {
+            ++count;
+        }
+    }
+
+    fclose(file);
+    return count;
+}
+
+/* Returns the number of results whose median latency is over their baseline's by more than threshold
+ * percent. Medians are steadier than means, which a single page fault may skew.
+ */
+static size_t compare(const Result *results, size_t count, const Result *baseline, size_t baseline_count, double threshold)
+{
+    size_t regressions = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        const Result *r = &results[i];
+
+        for (size_t j = 0; j < baseline_count; ++j) {
+            const Result *b = &baseline[j];
+
+            if (r->size != b->size || strcmp(r->type, b->type) != 0 || strcmp(r->operation, b->operation) != 0) {
+                continue;
+            }
+
+            double change = (r->p50 - b->p50) * 100.0 / b->p50;
+            bool regressed = change > threshold;
+            regressions += regressed;
+
+            printf(
+                    "[BENCH]: %-7s %-13s %10li items: p50 %10.2f -> %10.2f ns/item (%+7.1f%%)%s\n",
+                    r->type, r->operation, r->size, b->p50, r->p50, change,
+                    regressed ? " REGRESSION" : ""
+            );
+            break;
+        }
+    }
+
+    return regressions;
+}
+
+/* Only prints the counters that are available. */
+static void print_counters(const Result *result)
+{
+    bool any = false;
+
+    for (size_t i = 0; i < COUNTERS; ++i) {
+        if (result->counters[i] >= 0) {
+            printf("%s %.4g %s", any ? "," : "[BENCH]:         per item:", result->counters[i], counter_names[i]);
+            any = true;
+        }
+    }
+
+    if (result->counters[0] > 0 && result->counters[1] >= 0) {
+        printf(", IPC %.2f", result->counters[1] / result->counters[0]);
+    }
+
+    if (any) {
+        printf("\n");
+    }
+}
+
+static void usage(const char *program)
+{
+    fprintf(
+            stderr,
+            "Usage: %s [--max-size N] [--type numeric|string] [--operation NAME] [--output FILE] "
+            "[--baseline FILE] [--threshold PERCENT] [--counters yes|no]\n",
+            program
+    );
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_size = DEFAULT_MAX_SIZE;
+    const char *only_type = NULL;
+    const char *only_operation = NULL;
+    const char *output = "vector_bench.json";
+    const char *baseline_path = NULL;
+    double threshold = DEFAULT_THRESHOLD;
+    bool use_counters = true;
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 == argc) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        } else if (strcmp(argv[i], "--max-size") == 0) {
+            max_size = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--type") == 0) {
+            only_type = argv[++i];
+        } else if (strcmp(argv[i], "--operation") == 0) {
+            only_operation = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0) {
+            threshold = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--counters") == 0) {
+            use_counters = strcmp(argv[++i], "no") != 0;
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("Running %s.\n", libvector_version());
+
+    if (use_counters) {
+        counters_open();
+    }
+
+    numeric_values = (double *) malloc(max_size * sizeof(double));
+    string_values = (const char **) malloc(max_size * sizeof(char *));
+
+    if (numeric_values == NULL || string_values == NULL) {
+        fprintf(stderr, "[BENCH]: Out of memory.\n");
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < max_size; ++i) {
+        numeric_values[i] = (double) i;
+        string_values[i] = STRING_VALUE;
+    }
+
+    Result *results = (Result *) malloc(MAX_RESULTS * sizeof(Result));
+    size_t count = 0;
+
+    for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t) {
+        if (only_type != NULL && strcmp(only_type, types[t].name) != 0) {
+            continue;
+        }
+
+        for (size_t size = MIN_SIZE; size <= max_size; size *= 10) {
+            for (size_t o = 0; o < sizeof(operations) / sizeof(operations[0]) && count < MAX_RESULTS; ++o) {
+                if (only_operation != NULL && strcmp(only_operation, operations[o].name) != 0) {
+                    continue;
+                }
+
+                Result *r = &results[count++];
+                *r = measure(&types[t], operations[o].name, operations[o].run, size);
+
+                printf(
+                        "[BENCH]: %-7s %-13s %10li items: %10.2f ns/item, %12.0f items/s, "
+                        "p50: %8.2f, p90: %8.2f, p99: %8.2f, max: %10.2f ns\n",
+                        r->type, r->operation, r->size, r->ns_per_item, r->items_per_second,
+                        r->p50, r->p90, r->p99, r->max
+                );
+
+                print_counters(r);
+            }
+        }
+    }
+
+    FILE *file = fopen(output, "w");
+    if (file == NULL) {
+        fprintf(stderr, "[BENCH]: Couldn't write results to: %s.\n", output);
+        return EXIT_FAILURE;
+    }
+
+    write_json(file, results, count);
+    fclose(file);
+    printf("[BENCH]: Results written to %s.\n", output);
+
+    size_t regressions = 0;
+    if (baseline_path != NULL) {
+        Result *baseline = (Result *) malloc(MAX_RESULTS * sizeof(Result));
+        size_t baseline_count = read_baseline(baseline_path, baseline, MAX_RESULTS);
+
+        printf("[BENCH]: Comparing against %s, %li results.\n", baseline_path, baseline_count);
+        regressions = compare(results, count, baseline, baseline_count, threshold);
+        printf("[BENCH]: %li regressions over %.1f%%.\n", regressions, threshold);
+        free(baseline);
+    }
+
+    counters_close();
+    free(results);
+    free(string_values);
+    free(numeric_values);
+    return regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
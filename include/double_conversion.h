@@ -0,0 +1,12 @@
+#ifndef DOUBLE_CONVERSION_H
+#define DOUBLE_CONVERSION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define DOUBLE_CONVERSION_MAX_LENGTH 32 /* Longest number written by double_conversion_format(). */
+
+const char *double_conversion_parse(const char *start, const char *end, double *value);
+size_t double_conversion_format(double value, char *buffer);
+
+#endif // DOUBLE_CONVERSION_H
@@ -0,0 +1,16 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include "vector.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+void string_pool_retain(StringPool *pool);
+bool string_pool_is_shared(const StringPool *pool);
+char *string_pool_alloc(StringPool *pool, size_t size);
+bool string_pool_owns(const StringPool *pool, const char *item);
+void string_pool_free(StringPool *pool, char *item);
+size_t string_pool_buffer_size(const char *item);
+
+#endif // STRING_POOL_H
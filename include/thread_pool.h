@@ -0,0 +1,14 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Processes chunk number chunk of a job. */
+typedef void (*ThreadPoolTask)(void *context, size_t chunk);
+
+bool thread_pool_run(ThreadPoolTask task, void *context, size_t chunks);
+bool thread_pool_set_size(size_t threads);
+size_t thread_pool_get_size(void);
+
+#endif // THREAD_POOL_H
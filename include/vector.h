@@ -2,30 +2,170 @@
 #define VECTOR_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
 #define DEFAULT_RESIZE_VALUE 10
+#define CONCURRENT_NUMERIC_VECTOR_SEGMENTS 48
+#define NUMERIC_VECTOR_PARALLEL_CHUNK 65536 /* Items processed at a time by numeric_vector_parallel_*() */
+#define STRING_VECTOR_PARALLEL_CHUNK 65536 /* Items processed at a time by string_vector_parallel_*() */
+#define VERSIONED_VECTOR_BLOCK_SIZE 64 /* Items per block shared between versions of versioned vectors */
+#define STRING_VECTOR_COMPRESSED_BLOCK_SIZE 65536 /* Bytes of items compressed together by string_vector_save_compressed() */
 
+/* Snapshot and log of the modifications made since, a vector is recovered from. See *_vector_open_journal(). */
+typedef struct VectorJournal VectorJournal;
+
+/* references is shared by vectors made with *_vector_copy(), which share their data until one of them
+ * is modified. It's NULL for vectors which have never been copied. libvector only accesses it
+ * atomically, so the header stays plain C that C++ can include too.
+ */
 typedef struct {
     double* data;
     size_t capacity;
     size_t offset;
+    size_t *references;
+    VectorJournal *journal; /* Where modifications are logged, when set. */
 } NumericVector;
 
+/* NumericVector several threads can add to at once. Numbers live in segments that never move,
+ * segment k being twice as big as segment k - 1. See concurrent_numeric_vector_add(). Members other
+ * than first_segment_size are only accessed atomically, through the concurrent_numeric_vector_*()
+ * functions.
+ */
+typedef struct {
+    double *segments[CONCURRENT_NUMERIC_VECTOR_SEGMENTS];
+    size_t offset; /* Positions claimed by adds. */
+    size_t committed; /* Positions below it hold their numbers, the ones readers see. */
+    size_t first_segment_size;
+} ConcurrentNumericVector;
+
+/* Shards are plain vectors, each filled by a single thread, e.g., the one which claimed it with
+ * sharded_*_vector_claim_shard(), and merged at once with sharded_*_vector_merge().
+ */
+typedef struct {
+    NumericVector *shards;
+    size_t shard_count;
+    size_t claimed; /* Shards handed out so far, counted atomically. */
+} ShardedNumericVector;
+
+typedef double (*NumericVectorMapFunction)(double value, void *context);
+typedef double (*NumericVectorReduceFunction)(double accumulator, double value, void *context);
+
+/* Size-classed free lists for StringVector items. See string_pool_create(). */
+typedef struct StringPool StringPool;
+
 typedef struct {
     char **data;
     size_t capacity;
     size_t offset;
     size_t *item_sizes;
+    char **batches; /* Buffers holding several items at once. See string_vector_add_array(). */
+    size_t *batch_sizes;
+    size_t *batch_items; /* Items still held by each batch, which is freed along with its last one. */
+    size_t batch_count;
+    uint64_t *hashes; /* Hash index, only when enabled. See string_vector_enable_index(). */
+    size_t *hash_index; /* One slot per distinct item, holding its first position + 1. */
+    size_t *hash_counts; /* How many times the item of each slot is in the vector. */
+    size_t hash_index_capacity;
+    size_t spares; /* Buffers kept after offset for reuse. See string_vector_clear_retaining(). */
+    size_t *buffer_sizes; /* Bytes of each item's buffer, once spares were kept. Reused ones may be bigger than their items. */
+    StringPool *pool; /* Where items are allocated, when set. See string_vector_use_pool(). */
+    char *mapped; /* Private mapping of the file items were loaded from. See string_vector_map_file(). */
+    size_t mapped_size;
+    size_t *references; /* See NumericVector. */
+    VectorJournal *journal; /* See NumericVector. */
 } StringVector;
 
+typedef struct {
+    StringVector *shards;
+    size_t shard_count;
+    size_t claimed; /* See ShardedNumericVector. */
+} ShardedStringVector;
+
+/* StringVector variant keeping a gap of free slots at the last edit position (the cursor).
+ * Insertions and erasures at the cursor don't move any other item; moving the cursor costs
+ * as many slot moves as the distance travelled. offset holds the number of items.
+ */
+typedef struct {
+    char **data;
+    size_t capacity;
+    size_t offset;
+    size_t *item_sizes;
+    size_t gap_start;
+    size_t gap_end;
+} StringGapVector;
+
+/* Non-owning (pointer, length) pairs into a buffer owned by the caller, which must outlive the vector.
+ * Views aren't \0-terminated, and item_sizes don't count any \0 character.
+ */
+typedef struct {
+    const char **data;
+    size_t capacity;
+    size_t offset;
+    size_t *item_sizes;
+    const char *mapped; /* Read-only mapping of the file views point into, owned by the vector. See string_view_vector_map_file(). */
+    size_t mapped_size;
+} StringViewVector;
+
+/* Read-mostly vectors. Writers build the next version, sharing the blocks they don't modify with the
+ * current one, and publish it atomically. Readers pin a published version, which is reclaimed once no
+ * reader has it pinned anymore.
+ */
+typedef struct VersionedSnapshot VersionedSnapshot;
+
+typedef struct {
+    struct VersionedVector *versioned;
+} VersionedNumericVector;
+
+typedef struct {
+    struct VersionedVector *versioned;
+} VersionedStringVector;
+
+/* Where a vector's memory goes, in bytes. See *_vector_memory_usage(). */
+typedef struct {
+    size_t payload; /* The items: numbers, or strings with their terminators. */
+    size_t slots; /* Pointers to the items held. Only StringVector has them. */
+    size_t metadata; /* Item sizes, hash index, batch lists and reference counter. */
+    size_t slack; /* Reserved but unused: free slots, retained buffers and dead bytes in batches. */
+    size_t overhead; /* Estimated allocator headers and rounding, including StringPool size classes. */
+    size_t total;
+} VectorMemoryUsage;
+
+/* How *_vector_write() lays items out. A zeroed struct writes an item per line, and numbers in the
+ * shortest form reading back as the same double.
+ */
+typedef struct {
+    const char *separator; /* Between items. "\n" when NULL. */
+    const char *terminator; /* After the last item. "\n" when NULL, "" for nothing. */
+    bool fixed; /* Numbers with precision digits after the decimal point, as printf("%.*f") does. */
+    int precision;
+} VectorWriteOptions;
+
+/* Saves and loads in flight, run in batches by vector_io_poll(). See vector_io_create(). */
+typedef struct VectorIO VectorIO;
+
+/* Run by vector_io_poll() once a save or load is over. */
+typedef void (*VectorIOCallback)(void *context, bool succeeded);
+
 const char *libvector_version(void);
 
 void libvector_set_debug(bool value);
+bool libvector_set_threads(size_t threads);
+void libvector_get_copy_stats(size_t *shared, size_t *materialized);
+void libvector_track_memory(bool value);
+bool libvector_get_memory_usage(VectorMemoryUsage *usage, size_t *vectors);
+bool numeric_vector_memory_usage(const NumericVector *vector, VectorMemoryUsage *usage);
+bool string_vector_memory_usage(const StringVector *vector, VectorMemoryUsage *usage);
+VectorIO *vector_io_create(size_t queue_depth, bool threads_only);
+void vector_io_destroy(VectorIO *io);
+bool vector_io_uses_io_uring(const VectorIO *io);
+size_t vector_io_poll(VectorIO *io, bool wait);
 bool numeric_vector_init(NumericVector *vector, size_t initial_size);
 void numeric_vector_free(NumericVector *vector);
 bool numeric_vector_add(NumericVector *vector, double value);
 bool numeric_vector_add_array(NumericVector *vector, double *values, size_t n);
+bool numeric_vector_parse(NumericVector *vector, const char *buffer, size_t size, char delimiter);
+bool numeric_vector_parse_fd(NumericVector *vector, int fd, char delimiter);
 bool numeric_vector_reserve(NumericVector *vector, size_t spaces); /* With spaces I mean, e.g., 1 space = 4 bytes */
 bool numeric_vector_shrink_to_fit(NumericVector *vector);
 bool numeric_vector_clear(NumericVector *vector);
@@ -34,31 +174,156 @@ bool numeric_vector_insert(NumericVector *vector, double value, size_t position)
 bool numeric_vector_replace(NumericVector *vector, size_t position, double new_value);
 bool numeric_vector_erase(NumericVector *vector, size_t start, size_t length);
 bool numeric_vector_swap(NumericVector *one, NumericVector *another);
+bool numeric_vector_move(NumericVector *source, NumericVector *destination);
+double *numeric_vector_release(NumericVector *vector, size_t *size);
 size_t numeric_vector_get_capacity(const NumericVector *vector);
 double numeric_vector_pop(NumericVector *vector);
 double numeric_vector_get_first(const NumericVector *vector);
 double numeric_vector_get_at(const NumericVector *vector, size_t position);
 double numeric_vector_get_last(const NumericVector *vector);
 void numeric_vector_print(const NumericVector *vector);
+bool numeric_vector_write(const NumericVector *vector, int fd, const VectorWriteOptions *options);
+bool numeric_vector_save_async(VectorIO *io, const NumericVector *vector, int fd, uint64_t offset, uint64_t *size,
+        VectorIOCallback callback, void *context);
+bool numeric_vector_load_async(VectorIO *io, NumericVector *vector, int fd, uint64_t offset, uint64_t *size,
+        VectorIOCallback callback, void *context);
+bool numeric_vector_open_journal(NumericVector *vector, const char *path, size_t sync_bytes);
+bool numeric_vector_sync_journal(NumericVector *vector);
+bool numeric_vector_compact_journal(NumericVector *vector);
+bool numeric_vector_close_journal(NumericVector *vector);
+bool numeric_vector_parallel_map(NumericVector *vector, NumericVectorMapFunction function, void *context);
+bool numeric_vector_parallel_reduce(const NumericVector *vector, NumericVectorReduceFunction function,
+        double initial, void *context, double *result);
+
+bool concurrent_numeric_vector_init(ConcurrentNumericVector *vector, size_t initial_size);
+void concurrent_numeric_vector_free(ConcurrentNumericVector *vector);
+bool concurrent_numeric_vector_add(ConcurrentNumericVector *vector, double value);
+size_t concurrent_numeric_vector_get_size(const ConcurrentNumericVector *vector);
+double concurrent_numeric_vector_get_at(const ConcurrentNumericVector *vector, size_t position);
+bool concurrent_numeric_vector_snapshot(const ConcurrentNumericVector *source, NumericVector *destination);
+bool concurrent_numeric_vector_freeze(ConcurrentNumericVector *source, NumericVector *destination);
 
 bool string_vector_init(StringVector *vector, size_t initial_size);
 void string_vector_free(StringVector *vector);
 bool string_vector_add(StringVector *vector, const char *value);
+bool string_vector_add_owned(StringVector *vector, char *value, size_t length);
 bool string_vector_add_array(StringVector *vector, const char *array[], size_t n);
+bool string_vector_add_sized_array(StringVector *vector, const char *array[], const size_t lengths[], size_t n);
 bool string_vector_reserve(StringVector *vector, size_t spaces); /* With spaces I mean, e.g., 1 space = 1 byte. */
 bool string_vector_shrink_to_fit(StringVector *vector);
 bool string_vector_clear(StringVector *vector);
+bool string_vector_clear_retaining(StringVector *vector, size_t max_bytes);
 bool string_vector_copy(const StringVector *source, StringVector *destination, bool initialize);
 bool string_vector_insert(StringVector *vector, const char *value, size_t position);
 bool string_vector_replace(StringVector *vector, size_t position, const char *new_value);
+bool string_vector_replace_owned(StringVector *vector, size_t position, char *new_value, size_t length);
 bool string_vector_erase(StringVector *vector, size_t start, size_t length);
 bool string_vector_swap(StringVector *one, StringVector *another);
+bool string_vector_move(StringVector *source, StringVector *destination);
+char **string_vector_release(StringVector *vector, size_t *size);
+StringPool *string_pool_create(bool shared);
+void string_pool_release(StringPool *pool);
+bool string_vector_use_pool(StringVector *vector, StringPool *pool);
+bool string_vector_map_file(StringVector *vector, const char *path, const char *index_path);
 size_t string_vector_get_capacity(const StringVector *vector);
 char *string_vector_pop(StringVector *vector);
+char *string_vector_take_at(StringVector *vector, size_t position);
 const char *string_vector_get_first(const StringVector *vector);
 const char *string_vector_get_at(const StringVector *vector, size_t position);
 const char *string_vector_get_last(const StringVector *vector);
 size_t string_vector_strlen(const StringVector *vector, size_t position);
 void string_vector_print(const StringVector *vector);
+bool string_vector_write(const StringVector *vector, int fd, const VectorWriteOptions *options);
+bool string_vector_save_async(VectorIO *io, const StringVector *vector, int fd, uint64_t offset, uint64_t *size,
+        VectorIOCallback callback, void *context);
+bool string_vector_load_async(VectorIO *io, StringVector *vector, int fd, uint64_t offset, uint64_t *size,
+        VectorIOCallback callback, void *context);
+bool string_vector_save_compressed(const StringVector *vector, int fd, uint64_t offset, uint64_t *size);
+bool string_vector_count_compressed(int fd, uint64_t offset, size_t *count);
+bool string_vector_load_compressed(StringVector *vector, int fd, uint64_t offset, size_t start, size_t length);
+bool string_vector_open_journal(StringVector *vector, const char *path, size_t sync_bytes);
+bool string_vector_sync_journal(StringVector *vector);
+bool string_vector_compact_journal(StringVector *vector);
+bool string_vector_close_journal(StringVector *vector);
+bool string_vector_enable_index(StringVector *vector);
+void string_vector_disable_index(StringVector *vector);
+bool string_vector_find(const StringVector *vector, const char *value, size_t *position);
+bool string_vector_contains(const StringVector *vector, const char *value);
+bool string_vector_sort(StringVector *vector, bool stable);
+bool string_vector_sort_permutation(const StringVector *vector, size_t *permutation, bool stable);
+bool string_vector_parallel_copy(const StringVector *source, StringVector *destination, bool initialize);
+void string_vector_parallel_free(StringVector *vector);
+
+bool sharded_numeric_vector_init(ShardedNumericVector *vector, size_t shards, size_t initial_size);
+void sharded_numeric_vector_free(ShardedNumericVector *vector);
+NumericVector *sharded_numeric_vector_claim_shard(ShardedNumericVector *vector);
+NumericVector *sharded_numeric_vector_get_shard(ShardedNumericVector *vector, size_t shard);
+size_t sharded_numeric_vector_get_size(const ShardedNumericVector *vector);
+bool sharded_numeric_vector_clear(ShardedNumericVector *vector);
+bool sharded_numeric_vector_merge(const ShardedNumericVector *source, NumericVector *destination, bool initialize);
+bool sharded_numeric_vector_merge_sorted(const ShardedNumericVector *source, NumericVector *destination, bool initialize);
+
+bool sharded_string_vector_init(ShardedStringVector *vector, size_t shards, size_t initial_size);
+void sharded_string_vector_free(ShardedStringVector *vector);
+StringVector *sharded_string_vector_claim_shard(ShardedStringVector *vector);
+StringVector *sharded_string_vector_get_shard(ShardedStringVector *vector, size_t shard);
+size_t sharded_string_vector_get_size(const ShardedStringVector *vector);
+bool sharded_string_vector_clear(ShardedStringVector *vector);
+bool sharded_string_vector_merge(const ShardedStringVector *source, StringVector *destination, bool initialize);
+bool sharded_string_vector_merge_sorted(const ShardedStringVector *source, StringVector *destination, bool initialize);
+
+bool string_gap_vector_init(StringGapVector *vector, size_t initial_size);
+void string_gap_vector_free(StringGapVector *vector);
+bool string_gap_vector_add(StringGapVector *vector, const char *value);
+bool string_gap_vector_insert(StringGapVector *vector, const char *value, size_t position);
+bool string_gap_vector_replace(StringGapVector *vector, size_t position, const char *new_value);
+bool string_gap_vector_erase(StringGapVector *vector, size_t start, size_t length);
+bool string_gap_vector_move_cursor(StringGapVector *vector, size_t position);
+bool string_gap_vector_to_string_vector(const StringGapVector *source, StringVector *destination, bool initialize);
+size_t string_gap_vector_get_capacity(const StringGapVector *vector);
+const char *string_gap_vector_get_first(const StringGapVector *vector);
+const char *string_gap_vector_get_at(const StringGapVector *vector, size_t position);
+const char *string_gap_vector_get_last(const StringGapVector *vector);
+size_t string_gap_vector_strlen(const StringGapVector *vector, size_t position);
+void string_gap_vector_print(const StringGapVector *vector);
+
+bool string_view_vector_init(StringViewVector *vector, size_t initial_size);
+void string_view_vector_free(StringViewVector *vector);
+bool string_view_vector_add(StringViewVector *vector, const char *value, size_t length);
+bool string_view_vector_reserve(StringViewVector *vector, size_t spaces);
+bool string_view_vector_split(StringViewVector *vector, const char *buffer, size_t size, char delimiter);
+bool string_view_vector_map_file(StringViewVector *vector, const char *path);
+bool string_view_vector_to_string_vector(const StringViewVector *source, StringVector *destination, bool initialize);
+size_t string_view_vector_get_capacity(const StringViewVector *vector);
+const char *string_view_vector_get_at(const StringViewVector *vector, size_t position);
+size_t string_view_vector_strlen(const StringViewVector *vector, size_t position);
+void string_view_vector_print(const StringViewVector *vector);
+
+bool versioned_numeric_vector_init(VersionedNumericVector *vector, size_t readers);
+void versioned_numeric_vector_free(VersionedNumericVector *vector);
+bool versioned_numeric_vector_add(VersionedNumericVector *vector, double value);
+bool versioned_numeric_vector_replace(VersionedNumericVector *vector, size_t position, double new_value);
+bool versioned_numeric_vector_pop(VersionedNumericVector *vector);
+bool versioned_numeric_vector_publish(VersionedNumericVector *vector);
+bool versioned_numeric_vector_register_reader(VersionedNumericVector *vector, size_t *reader);
+void versioned_numeric_vector_unregister_reader(VersionedNumericVector *vector, size_t reader);
+const VersionedSnapshot *versioned_numeric_vector_pin(VersionedNumericVector *vector, size_t reader);
+void versioned_numeric_vector_unpin(VersionedNumericVector *vector, size_t reader);
+double versioned_numeric_snapshot_get_at(const VersionedSnapshot *snapshot, size_t position);
+
+bool versioned_string_vector_init(VersionedStringVector *vector, size_t readers);
+void versioned_string_vector_free(VersionedStringVector *vector);
+bool versioned_string_vector_add(VersionedStringVector *vector, const char *value);
+bool versioned_string_vector_replace(VersionedStringVector *vector, size_t position, const char *new_value);
+bool versioned_string_vector_pop(VersionedStringVector *vector);
+bool versioned_string_vector_publish(VersionedStringVector *vector);
+bool versioned_string_vector_register_reader(VersionedStringVector *vector, size_t *reader);
+void versioned_string_vector_unregister_reader(VersionedStringVector *vector, size_t reader);
+const VersionedSnapshot *versioned_string_vector_pin(VersionedStringVector *vector, size_t reader);
+void versioned_string_vector_unpin(VersionedStringVector *vector, size_t reader);
+const char *versioned_string_snapshot_get_at(const VersionedSnapshot *snapshot, size_t position);
+size_t versioned_string_snapshot_strlen(const VersionedSnapshot *snapshot, size_t position);
+
+size_t versioned_snapshot_get_size(const VersionedSnapshot *snapshot);
 
 #endif // VECTOR_H
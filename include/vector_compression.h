@@ -0,0 +1,13 @@
+#ifndef VECTOR_COMPRESSION_H
+#define VECTOR_COMPRESSION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Most bytes vector_compress() writes for size bytes of input, e.g., when nothing repeats. */
+#define VECTOR_COMPRESSION_BOUND(size) ((size) + (size) / 255 + 16)
+
+size_t vector_compress(const char *input, size_t size, char *output);
+bool vector_decompress(const char *input, size_t size, char *output, size_t output_size);
+
+#endif // VECTOR_COMPRESSION_H
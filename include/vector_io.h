@@ -0,0 +1,22 @@
+#ifndef VECTOR_IO_H
+#define VECTOR_IO_H
+
+#include "vector.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+#define VECTOR_IO_MAX_IOVECS 2 /* Buffers a single transfer may gather from or scatter to. */
+
+bool vector_io_submit(
+        VectorIO *io,
+        bool write,
+        int fd,
+        const struct iovec *iov,
+        int iov_count,
+        uint64_t offset,
+        VectorIOCallback completion,
+        void *context);
+
+#endif // VECTOR_IO_H
@@ -0,0 +1,53 @@
+#ifndef VECTOR_JOURNAL_H
+#define VECTOR_JOURNAL_H
+
+#include "vector.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Modifications recorded in a journal. The first three carry the items they leave in the vector. */
+enum VectorJournalOperation {
+    VECTOR_JOURNAL_APPEND = 1,
+    VECTOR_JOURNAL_INSERT,
+    VECTOR_JOURNAL_REPLACE,
+    VECTOR_JOURNAL_ERASE,
+    VECTOR_JOURNAL_POP,
+    VECTOR_JOURNAL_CLEAR
+};
+
+/* Followed by size bytes of items, padded with zeroes to 8 bytes. checksum covers everything after it. */
+typedef struct {
+    uint32_t checksum;
+    uint32_t size;
+    uint32_t operation;
+    uint32_t count;
+    uint64_t position;
+} VectorJournalRecord;
+
+/* What recovery starts from: the snapshot, to be read from snapshot_fd, and the records logged since. */
+typedef struct {
+    int snapshot_fd;
+    uint64_t snapshot_offset;
+    uint64_t snapshot_size;
+    char *log;
+    size_t log_size;
+} VectorJournalContents;
+
+VectorJournal *vector_journal_open(const char *path, size_t sync_bytes, VectorJournalContents *contents);
+bool vector_journal_read(const VectorJournalContents *contents, void *buffer, size_t size, uint64_t offset);
+const VectorJournalRecord *vector_journal_next(const VectorJournalContents *contents, size_t *offset);
+void vector_journal_discard(VectorJournalContents *contents);
+bool vector_journal_start(VectorJournal *journal, VectorJournalContents *contents, size_t valid_size);
+void vector_journal_close(VectorJournal *journal);
+char *vector_journal_reserve(VectorJournal *journal, uint32_t operation, size_t position, size_t count, size_t size);
+bool vector_journal_commit(VectorJournal *journal);
+void vector_journal_invalidate(VectorJournal *journal);
+bool vector_journal_is_stale(const VectorJournal *journal);
+bool vector_journal_sync(VectorJournal *journal);
+bool vector_journal_needs_compaction(const VectorJournal *journal);
+int vector_journal_begin_snapshot(VectorJournal *journal);
+bool vector_journal_end_snapshot(VectorJournal *journal, int fd, bool written);
+
+#endif // VECTOR_JOURNAL_H
@@ -0,0 +1,425 @@
+#include "string_pool.h"
+#include "logger.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Buffers come in power of two sizes, from 16 to 4096 bytes, each one starting with a header
+ * holding its size class. Free buffers are linked through their first bytes.
+ */
+#define STRING_POOL_CLASSES 9
+#define STRING_POOL_MIN_SHIFT 4
+#define STRING_POOL_HEADER_SIZE sizeof(size_t)
+
+/* Slabs double in size up to the maximum, so even big pools have few of them to look through. */
+#define STRING_POOL_FIRST_SLAB_SIZE (64 * 1024)
+#define STRING_POOL_MAX_SLAB_SIZE (16 * 1024 * 1024)
+
+/* Buffers a thread takes from a shared pool at once, and keeps at most, per size class. */
+#define STRING_POOL_REFILL 32
+#define STRING_POOL_CACHE_LIMIT 128
+
+typedef struct {
+    char *start;
+    size_t size;
+} StringPoolSlab;
+
+/* Slabs sorted by address. The table is replaced, never modified, when a slab is added, so it can
+ * be searched without locking. Old tables are kept in retired until the pool is destroyed.
+ */
+typedef struct StringPoolSlabs {
+    struct StringPoolSlabs *retired;
+    size_t count;
+    StringPoolSlab slabs[];
+} StringPoolSlabs;
+
+struct StringPool {
+    _Atomic size_t references;
+    bool shared;
+    uint64_t id;
+    pthread_mutex_t mutex; /* Only for shared pools. */
+    _Atomic(StringPoolSlabs *) slabs;
+    char *next; /* Unused part of the last slab. */
+    char *end;
+    size_t next_slab_size;
+    char *free_lists[STRING_POOL_CLASSES];
+    StringPool *next_live;
+};
+
+/* Buffers a thread took from a shared pool, bound to the last one it allocated from. pool may be
+ * gone by the time the cache is flushed, which id and the list of live pools tell.
+ */
+typedef struct {
+    StringPool *pool;
+    uint64_t id;
+    char *lists[STRING_POOL_CLASSES];
+    size_t counts[STRING_POOL_CLASSES];
+} StringPoolCache;
+
+/* The initial-exec model saves a call to __tls_get_addr() on every access from this shared library. */
+#if defined(__GNUC__)
+static _Thread_local StringPoolCache cache __attribute__((tls_model("initial-exec")));
+#else
+static _Thread_local StringPoolCache cache;
+#endif
+
+static pthread_mutex_t live_pools_mutex = PTHREAD_MUTEX_INITIALIZER;
+static StringPool *live_pools = NULL;
+static _Atomic uint64_t next_pool_id = 1;
+static pthread_once_t cache_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t cache_key;
+
+static char *string_pool_next_free(const char *buffer)
+{
+    char *next;
+    memcpy(&next, buffer, sizeof(next));
+    return next;
+}
+
+static void string_pool_set_next_free(char *buffer, const char *next)
+{
+    memcpy(buffer, &next, sizeof(next));
+}
+
+/* Returns STRING_POOL_CLASSES when size doesn't fit in any class. */
+static size_t string_pool_class(size_t size)
+{
+    size_t total = size + STRING_POOL_HEADER_SIZE;
+    size_t class = 0;
+
+    while (class < STRING_POOL_CLASSES && ((size_t) 1 << (class + STRING_POOL_MIN_SHIFT)) < total) {
+        ++class;
+    }
+
+    return class;
+}
+
+static void string_pool_lock(StringPool *pool)
+{
+    if (pool->shared) {
+        pthread_mutex_lock(&pool->mutex);
+    }
+}
+
+static void string_pool_unlock(StringPool *pool)
+{
+    if (pool->shared) {
+        pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+static bool string_pool_add_slab(StringPool *pool, size_t size)
+{
+    char *slab = (char *) malloc(size);
+    StringPoolSlabs *old = atomic_load_explicit(&pool->slabs, memory_order_relaxed);
+    size_t count = old == NULL ? 0 : old->count;
+    StringPoolSlabs *table = (StringPoolSlabs *) malloc(sizeof(StringPoolSlabs) + (count + 1) * sizeof(StringPoolSlab));
+
+    if (slab == NULL || table == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate a slab of %li bytes. Error code: %i", size, errno);
+        free(slab);
+        free(table);
+        return false;
+    }
+
+    size_t at = 0;
+    while (at < count && (uintptr_t) old->slabs[at].start < (uintptr_t) slab) {
+        table->slabs[at] = old->slabs[at];
+        ++at;
+    }
+
+    table->slabs[at].start = slab;
+    table->slabs[at].size = size;
+
+    for (size_t i = at; i < count; ++i) {
+        table->slabs[i + 1] = old->slabs[i];
+    }
+
+    table->count = count + 1;
+    table->retired = old;
+    atomic_store_explicit(&pool->slabs, table, memory_order_release);
+
+    pool->next = slab;
+    pool->end = slab + size;
+    return true;
+}
+
+/* Takes a free buffer of class, carving a new one if there's none. pool must be locked. */
+static char *string_pool_take(StringPool *pool, size_t class)
+{
+    char *buffer = pool->free_lists[class];
+
+    if (buffer != NULL) {
+        pool->free_lists[class] = string_pool_next_free(buffer);
+        return buffer;
+    }
+
+    size_t size = (size_t) 1 << (class + STRING_POOL_MIN_SHIFT);
+
+    if ((size_t) (pool->end - pool->next) < size) {
+        if (!string_pool_add_slab(pool, pool->next_slab_size)) {
+            return NULL;
+        }
+
+        if (pool->next_slab_size < STRING_POOL_MAX_SLAB_SIZE) {
+            pool->next_slab_size *= 2;
+        }
+    }
+
+    char *header = pool->next;
+    pool->next += size;
+    memcpy(header, &class, sizeof(class));
+    return header + STRING_POOL_HEADER_SIZE;
+}
+
+/* Hands a list of buffers of class back to pool. pool must be locked. */
+static void string_pool_give_back(StringPool *pool, size_t class, char *list)
+{
+    if (list == NULL) {
+        return;
+    }
+
+    char *last = list;
+    for (char *next = string_pool_next_free(last); next != NULL; next = string_pool_next_free(last)) {
+        last = next;
+    }
+
+    string_pool_set_next_free(last, pool->free_lists[class]);
+    pool->free_lists[class] = list;
+}
+
+/* Returns the cached buffers to their pool, if it still exists, and unbinds the cache. */
+static void string_pool_flush_cache(StringPoolCache *flushed)
+{
+    if (flushed->pool == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&live_pools_mutex);
+
+    StringPool *pool = live_pools;
+    while (pool != NULL && (pool != flushed->pool || pool->id != flushed->id)) {
+        pool = pool->next_live;
+    }
+
+    if (pool != NULL) {
+        pthread_mutex_lock(&pool->mutex);
+        for (size_t class = 0; class < STRING_POOL_CLASSES; ++class) {
+            string_pool_give_back(pool, class, flushed->lists[class]);
+        }
+        pthread_mutex_unlock(&pool->mutex);
+    }
+
+    pthread_mutex_unlock(&live_pools_mutex);
+
+    memset(flushed, 0, sizeof(*flushed));
+}
+
+static void string_pool_cache_exit(void *flushed)
+{
+    string_pool_flush_cache((StringPoolCache *) flushed);
+}
+
+static void string_pool_create_cache_key(void)
+{
+    pthread_key_create(&cache_key, string_pool_cache_exit);
+}
+
+static StringPoolCache *string_pool_bind_cache(StringPool *pool)
+{
+    if (cache.pool != pool || cache.id != pool->id) {
+        string_pool_flush_cache(&cache);
+
+        /* The key is only there to flush the cache when the thread exits. */
+        pthread_once(&cache_key_once, string_pool_create_cache_key);
+        pthread_setspecific(cache_key, &cache);
+
+        cache.pool = pool;
+        cache.id = pool->id;
+    }
+
+    return &cache;
+}
+
+/* shared pools may be used by several threads at once, each one keeping a few free buffers of its
+ * own, so they rarely lock. Otherwise, only one thread at a time may use the pool.
+ */
+StringPool *string_pool_create(bool shared)
+{
+    StringPool *pool = (StringPool *) calloc(1, sizeof(StringPool));
+
+    if (pool == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for StringPool. Error code: %i", errno);
+        return NULL;
+    }
+
+    atomic_init(&pool->references, 1);
+    atomic_init(&pool->slabs, NULL);
+    pool->shared = shared;
+    pool->id = atomic_fetch_add_explicit(&next_pool_id, 1, memory_order_relaxed);
+    pool->next_slab_size = STRING_POOL_FIRST_SLAB_SIZE;
+
+    if (shared) {
+        pthread_mutex_init(&pool->mutex, NULL);
+
+        pthread_mutex_lock(&live_pools_mutex);
+        pool->next_live = live_pools;
+        live_pools = pool;
+        pthread_mutex_unlock(&live_pools_mutex);
+    }
+
+    return pool;
+}
+
+void string_pool_retain(StringPool *pool)
+{
+    atomic_fetch_add_explicit(&pool->references, 1, memory_order_relaxed);
+}
+
+/* Drops a reference to pool, freeing it along with every buffer it handed out once the last
+ * vector using it is freed.
+ */
+void string_pool_release(StringPool *pool)
+{
+    if (pool == NULL || atomic_fetch_sub_explicit(&pool->references, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    if (pool->shared) {
+        pthread_mutex_lock(&live_pools_mutex);
+
+        StringPool **link = &live_pools;
+        while (*link != pool) {
+            link = &(*link)->next_live;
+        }
+
+        *link = pool->next_live;
+        pthread_mutex_unlock(&live_pools_mutex);
+        pthread_mutex_destroy(&pool->mutex);
+    }
+
+    StringPoolSlabs *table = atomic_load_explicit(&pool->slabs, memory_order_relaxed);
+
+    for (size_t i = 0; table != NULL && i < table->count; ++i) {
+        free(table->slabs[i].start);
+    }
+
+    while (table != NULL) {
+        StringPoolSlabs *retired = table->retired;
+        free(table);
+        table = retired;
+    }
+
+    free(pool);
+}
+
+bool string_pool_is_shared(const StringPool *pool)
+{
+    return pool->shared;
+}
+
+/* Returns a buffer holding at least size bytes, or NULL when size is too big for pool. */
+char *string_pool_alloc(StringPool *pool, size_t size)
+{
+    size_t class = string_pool_class(size);
+
+    if (class == STRING_POOL_CLASSES) {
+        return NULL;
+    }
+
+    if (!pool->shared) {
+        return string_pool_take(pool, class);
+    }
+
+    StringPoolCache *local = string_pool_bind_cache(pool);
+
+    if (local->lists[class] == NULL) {
+        pthread_mutex_lock(&pool->mutex);
+        for (size_t i = 0; i < STRING_POOL_REFILL; ++i) {
+            char *buffer = string_pool_take(pool, class);
+
+            if (buffer == NULL) {
+                break;
+            }
+
+            string_pool_set_next_free(buffer, local->lists[class]);
+            local->lists[class] = buffer;
+            ++local->counts[class];
+        }
+        pthread_mutex_unlock(&pool->mutex);
+
+        if (local->lists[class] == NULL) {
+            return NULL;
+        }
+    }
+
+    char *buffer = local->lists[class];
+    local->lists[class] = string_pool_next_free(buffer);
+    --local->counts[class];
+    return buffer;
+}
+
+bool string_pool_owns(const StringPool *pool, const char *item)
+{
+    const StringPoolSlabs *table = atomic_load_explicit(&((StringPool *) pool)->slabs, memory_order_acquire);
+
+    if (table == NULL) {
+        return false;
+    }
+
+    /* Same search as for StringVector batches. */
+    size_t low = 0;
+    size_t high = table->count;
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+
+        if ((uintptr_t) table->slabs[middle].start <= (uintptr_t) item) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low > 0 && (uintptr_t) item < (uintptr_t) table->slabs[low - 1].start + table->slabs[low - 1].size;
+}
+
+/* item must have been handed out by pool. */
+void string_pool_free(StringPool *pool, char *item)
+{
+    size_t class;
+    memcpy(&class, item - STRING_POOL_HEADER_SIZE, sizeof(class));
+
+    /* Buffers freed by a thread whose cache is bound to another pool go straight back. */
+    if (!pool->shared || cache.pool != pool || cache.id != pool->id) {
+        string_pool_lock(pool);
+        string_pool_set_next_free(item, pool->free_lists[class]);
+        pool->free_lists[class] = item;
+        string_pool_unlock(pool);
+        return;
+    }
+
+    string_pool_set_next_free(item, cache.lists[class]);
+    cache.lists[class] = item;
+
+    if (++cache.counts[class] > STRING_POOL_CACHE_LIMIT) {
+        pthread_mutex_lock(&pool->mutex);
+        string_pool_give_back(pool, class, cache.lists[class]);
+        pthread_mutex_unlock(&pool->mutex);
+
+        cache.lists[class] = NULL;
+        cache.counts[class] = 0;
+    }
+}
+
+/* Bytes item's buffer takes from its slab, header included. */
+size_t string_pool_buffer_size(const char *item)
+{
+    size_t class;
+    memcpy(&class, item - STRING_POOL_HEADER_SIZE, sizeof(class));
+    return (size_t) 1 << (class + STRING_POOL_MIN_SHIFT);
+}
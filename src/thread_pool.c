@@ -0,0 +1,293 @@
+#include "thread_pool.h"
+#include "logger.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Every worker owns a range of chunks packed as (begin << 32 | end). The owner takes chunks from
+ * the beginning of its range, and workers running out of chunks steal the second half of somebody
+ * else's range. Both sides update the range with a CAS, so no lock is taken while working.
+ */
+typedef struct {
+    _Atomic uint64_t range;
+    char padding[64 - sizeof(uint64_t)]; /* Keep every range in its own cache line. */
+} ThreadPoolQueue;
+
+typedef struct {
+    pthread_t *threads;
+    ThreadPoolQueue *queues;
+    size_t size; /* Workers, counting the thread calling thread_pool_run(). */
+
+    pthread_mutex_t mutex;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    unsigned long generation;
+    bool stop;
+
+    ThreadPoolTask task;
+    void *context;
+    _Atomic size_t remaining;
+    size_t running;
+} ThreadPool;
+
+static ThreadPool *pool = NULL;
+static size_t requested_size = 0;
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local bool inside_pool = false;
+
+static uint64_t thread_pool_pack(uint64_t begin, uint64_t end)
+{
+    return begin << 32 | end;
+}
+
+static bool thread_pool_take(ThreadPoolQueue *queue, size_t *chunk)
+{
+    uint64_t range = atomic_load_explicit(&queue->range, memory_order_acquire);
+
+    for (;;) {
+        uint64_t begin = range >> 32;
+        uint64_t end = range & UINT32_MAX;
+
+        if (begin >= end) {
+            return false;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(&queue->range, &range, thread_pool_pack(begin + 1, end),
+                    memory_order_acq_rel, memory_order_acquire))
+        {
+            *chunk = begin;
+            return true;
+        }
+    }
+}
+
+/* Moves the second half of victim's range into thief's queue. */
+static bool thread_pool_steal(ThreadPoolQueue *victim, ThreadPoolQueue *thief)
+{
+    uint64_t range = atomic_load_explicit(&victim->range, memory_order_acquire);
+
+    for (;;) {
+        uint64_t begin = range >> 32;
+        uint64_t end = range & UINT32_MAX;
+
+        if (begin >= end) {
+            return false;
+        }
+
+        uint64_t middle = begin + (end - begin) / 2;
+        if (atomic_compare_exchange_weak_explicit(&victim->range, &range, thread_pool_pack(begin, middle),
+                    memory_order_acq_rel, memory_order_acquire))
+        {
+            atomic_store_explicit(&thief->range, thread_pool_pack(middle, end), memory_order_release);
+            return true;
+        }
+    }
+}
+
+static void thread_pool_work(ThreadPool *self, size_t worker)
+{
+    ThreadPoolQueue *queue = &self->queues[worker];
+    size_t chunk;
+
+    for (;;) {
+        while (thread_pool_take(queue, &chunk)) {
+            self->task(self->context, chunk);
+            atomic_fetch_sub_explicit(&self->remaining, 1, memory_order_acq_rel);
+        }
+
+        bool stolen = false;
+        for (size_t i = 1; i < self->size && !stolen; ++i) {
+            stolen = thread_pool_steal(&self->queues[(worker + i) % self->size], queue);
+        }
+
+        if (!stolen) {
+            return;
+        }
+    }
+}
+
+static void *thread_pool_worker(void *arg)
+{
+    ThreadPool *self = pool;
+    size_t worker = (size_t) (uintptr_t) arg;
+    unsigned long generation = 0;
+
+    inside_pool = true;
+
+    for (;;) {
+        pthread_mutex_lock(&self->mutex);
+        while (!self->stop && self->generation == generation) {
+            pthread_cond_wait(&self->wake, &self->mutex);
+        }
+
+        if (self->stop) {
+            pthread_mutex_unlock(&self->mutex);
+            return NULL;
+        }
+
+        generation = self->generation;
+        ++self->running;
+        pthread_mutex_unlock(&self->mutex);
+
+        thread_pool_work(self, worker);
+
+        pthread_mutex_lock(&self->mutex);
+        if (--self->running == 0) {
+            pthread_cond_signal(&self->done);
+        }
+        pthread_mutex_unlock(&self->mutex);
+    }
+}
+
+static void thread_pool_destroy(ThreadPool *self)
+{
+    pthread_mutex_lock(&self->mutex);
+    self->stop = true;
+    pthread_cond_broadcast(&self->wake);
+    pthread_mutex_unlock(&self->mutex);
+
+    for (size_t i = 1; i < self->size; ++i) {
+        pthread_join(self->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&self->mutex);
+    pthread_cond_destroy(&self->wake);
+    pthread_cond_destroy(&self->done);
+    free(self->threads);
+    free(self->queues);
+    free(self);
+}
+
+static ThreadPool *thread_pool_create(size_t size)
+{
+    ThreadPool *self = (ThreadPool *) calloc(1, sizeof(ThreadPool));
+    if (self == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate the thread pool. Error code: %i", errno);
+        return NULL;
+    }
+
+    self->size = size;
+    self->threads = (pthread_t *) calloc(size, sizeof(pthread_t));
+    self->queues = (ThreadPoolQueue *) aligned_alloc(64, size * sizeof(ThreadPoolQueue));
+
+    if (self->threads == NULL || self->queues == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate the thread pool. Error code: %i", errno);
+        free(self->threads);
+        free(self->queues);
+        free(self);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < size; ++i) {
+        atomic_init(&self->queues[i].range, 0);
+    }
+
+    pthread_mutex_init(&self->mutex, NULL);
+    pthread_cond_init(&self->wake, NULL);
+    pthread_cond_init(&self->done, NULL);
+
+    /* Workers read the pool through the global pointer. */
+    pool = self;
+
+    /* Worker 0 is whoever calls thread_pool_run(), so one thread less is needed. */
+    for (size_t i = 1; i < size; ++i) {
+        if (pthread_create(&self->threads[i], NULL, thread_pool_worker, (void *) (uintptr_t) i) != 0) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to start thread pool worker #%li. Using %li workers.", i, i);
+            self->size = i;
+            break;
+        }
+    }
+
+    return self;
+}
+
+/* Changes the number of threads used by the next job. 0 means one per online CPU. */
+bool thread_pool_set_size(size_t threads)
+{
+    pthread_mutex_lock(&pool_mutex);
+
+    if (pool != NULL) {
+        thread_pool_destroy(pool);
+        pool = NULL;
+    }
+
+    requested_size = threads;
+    pthread_mutex_unlock(&pool_mutex);
+    return true;
+}
+
+size_t thread_pool_get_size(void)
+{
+    if (requested_size > 0) {
+        return requested_size;
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (size_t) cpus : 1;
+}
+
+/* Runs task once for every chunk in [0, chunks), spreading chunks over the pool's threads, and
+ * returns when all of them are done. The pool is created on first use and reused afterwards.
+ * Jobs are run one at a time; a task calling thread_pool_run() runs its own job serially.
+ */
+bool thread_pool_run(ThreadPoolTask task, void *context, size_t chunks)
+{
+    if (chunks > UINT32_MAX) {
+        logger(ERROR, true, __func__, __LINE__, "Thread pool jobs are limited to %u chunks, but %li were given.", UINT32_MAX, chunks);
+        return false;
+    }
+
+    if (inside_pool || chunks <= 1) {
+        for (size_t i = 0; i < chunks; ++i) {
+            task(context, i);
+        }
+
+        return true;
+    }
+
+    pthread_mutex_lock(&pool_mutex);
+
+    if (pool == NULL && thread_pool_create(thread_pool_get_size()) == NULL) {
+        pthread_mutex_unlock(&pool_mutex);
+        return false;
+    }
+
+    ThreadPool *self = pool;
+
+    /* The task is published before the chunks, since a worker still awake from the previous job
+     * may take a chunk as soon as it's in a queue.
+     */
+    self->task = task;
+    self->context = context;
+    atomic_store_explicit(&self->remaining, chunks, memory_order_release);
+
+    /* Contiguous, equally sized ranges; stealing takes care of imbalances. */
+    for (size_t i = 0; i < self->size; ++i) {
+        uint64_t begin = chunks * i / self->size;
+        uint64_t end = chunks * (i + 1) / self->size;
+        atomic_store_explicit(&self->queues[i].range, thread_pool_pack(begin, end), memory_order_release);
+    }
+
+    pthread_mutex_lock(&self->mutex);
+    ++self->generation;
+    pthread_cond_broadcast(&self->wake);
+    pthread_mutex_unlock(&self->mutex);
+
+    inside_pool = true;
+    thread_pool_work(self, 0);
+    inside_pool = false;
+
+    /* Every chunk has been taken, wait for the ones still being processed. */
+    pthread_mutex_lock(&self->mutex);
+    while (self->running > 0 || atomic_load_explicit(&self->remaining, memory_order_acquire) > 0) {
+        pthread_cond_wait(&self->done, &self->mutex);
+    }
+    pthread_mutex_unlock(&self->mutex);
+
+    pthread_mutex_unlock(&pool_mutex);
+    return true;
+}
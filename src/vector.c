@@ -1,9 +1,34 @@
 #include <errno.h>
+#include <fcntl.h>
 #include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
 #include "vector.h"
+#include "double_conversion.h"
 #include "logger.h"
+#include "string_pool.h"
+#include "thread_pool.h"
+#include "vector_compression.h"
+#include "vector_io.h"
+#include "vector_journal.h"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define VECTOR_WRITE_BUFFER_SIZE (256 * 1024) /* Output buffered by *_vector_write() between writes. */
+#define VECTOR_WRITE_DIRECT_SIZE 4096 /* Bigger items are written from where they are, without copying them. */
 
 static bool debug = false;
 
@@ -17,6 +42,518 @@ const char *libvector_version(void)
     return "libvector v"LIBVECTOR_VERSION;
 }
 
+static atomic_size_t shared_copies;
+static atomic_size_t materialized_copies;
+
+/* shared: copies made by *_vector_copy() sharing their source's data. materialized: how many of
+ * those were modified later on, having to make a deep copy then. Their difference is how many
+ * deep copies were avoided.
+ */
+void libvector_get_copy_stats(size_t *shared, size_t *materialized)
+{
+    *shared = atomic_load(&shared_copies);
+    *materialized = atomic_load(&materialized_copies);
+}
+
+/* Vectors alive while tracking is on, for libvector_get_memory_usage(). An open addressing set
+ * keyed by the vectors' addresses, so functions moving a vector's contents must retrack it.
+ */
+typedef struct {
+    const void *vector;
+    bool string;
+} TrackedVector;
+
+static pthread_mutex_t tracked_mutex = PTHREAD_MUTEX_INITIALIZER;
+static TrackedVector *tracked = NULL;
+static size_t tracked_capacity = 0;
+static _Atomic size_t tracked_count;
+static atomic_bool tracking;
+
+static size_t vector_tracked_slot(const void *vector)
+{
+    return (size_t) (((uintptr_t) vector >> 4) * 0x9E3779B97F4A7C15ULL) & (tracked_capacity - 1);
+}
+
+/* Slot holding vector, or the empty one where it would go. tracked_mutex must be held. */
+static size_t vector_tracked_find(const void *vector)
+{
+    size_t slot = vector_tracked_slot(vector);
+
+    while (tracked[slot].vector != NULL && tracked[slot].vector != vector) {
+        slot = (slot + 1) & (tracked_capacity - 1);
+    }
+
+    return slot;
+}
+
+static bool vector_tracked_grow(void)
+{
+    size_t old_capacity = tracked_capacity;
+    TrackedVector *old = tracked;
+    TrackedVector *grown = (TrackedVector *) calloc(old_capacity > 0 ? old_capacity * 2 : 64, sizeof(TrackedVector));
+
+    if (grown == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to grow the set of tracked vectors. Error code: %i", errno);
+        return false;
+    }
+
+    tracked = grown;
+    tracked_capacity = old_capacity > 0 ? old_capacity * 2 : 64;
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old[i].vector != NULL) {
+            tracked[vector_tracked_find(old[i].vector)] = old[i];
+        }
+    }
+
+    free(old);
+    return true;
+}
+
+/* A vector which can't be tracked is just left out of libvector_get_memory_usage(). */
+static void vector_track(const void *vector, bool string)
+{
+    if (!atomic_load_explicit(&tracking, memory_order_relaxed)) {
+        return;
+    }
+
+    pthread_mutex_lock(&tracked_mutex);
+
+    if ((atomic_load(&tracked_count) + 1) * 2 <= tracked_capacity || vector_tracked_grow()) {
+        size_t slot = vector_tracked_find(vector);
+
+        if (tracked[slot].vector == NULL) {
+            atomic_fetch_add(&tracked_count, 1);
+        }
+
+        tracked[slot].vector = vector;
+        tracked[slot].string = string;
+    }
+
+    pthread_mutex_unlock(&tracked_mutex);
+}
+
+/* Returns whether vector was tracked. */
+static bool vector_untrack(const void *vector)
+{
+    if (atomic_load_explicit(&tracked_count, memory_order_relaxed) == 0) {
+        return false;
+    }
+
+    pthread_mutex_lock(&tracked_mutex);
+
+    size_t hole = vector_tracked_find(vector);
+    bool found = tracked[hole].vector != NULL;
+
+    /* Backward shift deletion: entries after the hole move into it unless they're already in
+     * their home slot or between it and the hole.
+     */
+    if (found) {
+        size_t mask = tracked_capacity - 1;
+
+        for (size_t slot = (hole + 1) & mask; tracked[slot].vector != NULL; slot = (slot + 1) & mask) {
+            size_t home = vector_tracked_slot(tracked[slot].vector);
+
+            if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+                tracked[hole] = tracked[slot];
+                hole = slot;
+            }
+        }
+
+        tracked[hole].vector = NULL;
+        atomic_fetch_sub(&tracked_count, 1);
+    }
+
+    pthread_mutex_unlock(&tracked_mutex);
+    return found;
+}
+
+/* For contents moved from one vector to another. */
+static void vector_retrack(const void *from, const void *to, bool string)
+{
+    if (vector_untrack(from)) {
+        vector_track(to, string);
+    }
+}
+
+/* Vectors initialized while tracking is on are added up by libvector_get_memory_usage() until
+ * they're freed. Turning it off forgets every vector tracked so far.
+ */
+void libvector_track_memory(bool value)
+{
+    pthread_mutex_lock(&tracked_mutex);
+    atomic_store(&tracking, value);
+
+    if (!value) {
+        free(tracked);
+        tracked = NULL;
+        tracked_capacity = 0;
+        atomic_store(&tracked_count, 0);
+    }
+
+    pthread_mutex_unlock(&tracked_mutex);
+}
+
+/* Estimated bytes the allocator spends on top of the requested ones for the block at pointer. */
+static size_t vector_allocation_overhead(const void *pointer, size_t requested)
+{
+    if (pointer == NULL) {
+        return 0;
+    }
+
+#if defined(__GLIBC__)
+    /* Usable size covers the rounding; the chunk header comes on top of it. */
+    return malloc_usable_size((void *) pointer) - requested + sizeof(size_t);
+#else
+    size_t block = (requested + sizeof(size_t) + 15) & ~(size_t) 15;
+    return block - requested;
+#endif
+}
+
+static void vector_memory_usage_add(VectorMemoryUsage *to, const VectorMemoryUsage *usage)
+{
+    to->payload += usage->payload;
+    to->slots += usage->slots;
+    to->metadata += usage->metadata;
+    to->slack += usage->slack;
+    to->overhead += usage->overhead;
+    to->total += usage->total;
+}
+
+/* Stores the position of every delimiter in buffer into positions, or just counts them if it's
+ * NULL. SSE2 compares 16 bytes at once, which beats a memchr() call per token when tokens are short.
+ */
+static size_t vector_find_delimiters(const char *buffer, size_t size, char delimiter, size_t *positions)
+{
+    size_t found = 0;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    __m128i wanted = _mm_set1_epi8(delimiter);
+
+    for (; i + 16 <= size; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *) (buffer + i));
+        unsigned int mask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, wanted));
+
+        if (positions == NULL) {
+            found += __builtin_popcount(mask);
+            continue;
+        }
+
+        for (; mask != 0; mask &= mask - 1) {
+            positions[found++] = i + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    for (const char *p; i < size && (p = (const char *) memchr(buffer + i, delimiter, size - i)) != NULL; ++found) {
+        i = p - buffer;
+
+        if (positions != NULL) {
+            positions[found] = i;
+        }
+
+        ++i;
+    }
+
+    return found;
+}
+
+static bool vector_is_separator(char c, char delimiter)
+{
+    return c == delimiter || c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/* Returns where the token starting at p ends: at the first whitespace or delimiter, or end. */
+static const char *vector_token_end(const char *p, const char *end, char delimiter)
+{
+#if defined(__SSE2__)
+    __m128i delimiters = _mm_set1_epi8(delimiter);
+    __m128i spaces = _mm_set1_epi8(' ');
+    __m128i tabs = _mm_set1_epi8('\t');
+    __m128i line_feeds = _mm_set1_epi8('\n');
+    __m128i carriage_returns = _mm_set1_epi8('\r');
+
+    for (; end - p >= 16; p += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *) p);
+        __m128i found = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(bytes, delimiters), _mm_cmpeq_epi8(bytes, spaces)),
+                _mm_or_si128(
+                        _mm_or_si128(_mm_cmpeq_epi8(bytes, tabs), _mm_cmpeq_epi8(bytes, line_feeds)),
+                        _mm_cmpeq_epi8(bytes, carriage_returns)
+                )
+        );
+        unsigned int mask = (unsigned int) _mm_movemask_epi8(found);
+
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    while (p < end && !vector_is_separator(*p, delimiter)) {
+        ++p;
+    }
+
+    return p;
+}
+
+/* Output of *_vector_write(), gathered in a buffer to make a system call per VECTOR_WRITE_BUFFER_SIZE
+ * bytes instead of one per item.
+ */
+typedef struct {
+    int fd;
+    char *buffer;
+    size_t size;
+    size_t capacity;
+    bool failed;
+    const char *separator;
+    size_t separator_length;
+    const char *terminator;
+    size_t terminator_length;
+} VectorWriter;
+
+/* Writes every iov, retrying partial writes and interrupted calls. */
+static bool vector_write_all(int fd, struct iovec *iov, int count)
+{
+    while (count > 0) {
+        ssize_t written = writev(fd, iov, count);
+
+        if (written < 0 && errno == EINTR) {
+            continue;
+        } else if (written < 0) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to write to file descriptor: %i. Error code: %i", fd, errno);
+            return false;
+        }
+
+        for (; count > 0 && (size_t) written >= iov->iov_len; ++iov, --count) {
+            written -= iov->iov_len;
+        }
+
+        if (count > 0) {
+            iov->iov_base = (char *) iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+
+    return true;
+}
+
+/* Sized for the bytes expected, up to VECTOR_WRITE_BUFFER_SIZE. */
+static bool vector_writer_init(VectorWriter *writer, int fd, const VectorWriteOptions *options, size_t expected)
+{
+    writer->fd = fd;
+    writer->size = 0;
+    writer->failed = false;
+    writer->separator = options == NULL || options->separator == NULL ? "\n" : options->separator;
+    writer->separator_length = strlen(writer->separator);
+    writer->terminator = options == NULL || options->terminator == NULL ? "\n" : options->terminator;
+    writer->terminator_length = strlen(writer->terminator);
+    writer->capacity = expected < VECTOR_WRITE_DIRECT_SIZE ? VECTOR_WRITE_DIRECT_SIZE
+            : (expected > VECTOR_WRITE_BUFFER_SIZE ? VECTOR_WRITE_BUFFER_SIZE : expected);
+    writer->buffer = (char *) malloc(writer->capacity);
+
+    if (writer->buffer == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate %li bytes of output buffer. Error code: %i", writer->capacity, errno);
+        return false;
+    }
+
+    return true;
+}
+
+static void vector_writer_flush(VectorWriter *writer)
+{
+    struct iovec iov = { writer->buffer, writer->size };
+
+    writer->failed = writer->failed || !vector_write_all(writer->fd, &iov, 1);
+    writer->size = 0;
+}
+
+/* Makes room for length more bytes in the buffer, which must fit in it. */
+static char *vector_writer_reserve(VectorWriter *writer, size_t length)
+{
+    if (writer->size + length > writer->capacity) {
+        vector_writer_flush(writer);
+    }
+
+    return writer->buffer + writer->size;
+}
+
+static void vector_writer_append(VectorWriter *writer, const char *data, size_t length)
+{
+    /* Big items go out along with what's buffered, in the same system call. */
+    if (length >= VECTOR_WRITE_DIRECT_SIZE || length > writer->capacity) {
+        struct iovec iov[2] = { { writer->buffer, writer->size }, { (void *) data, length } };
+
+        writer->failed = writer->failed || !vector_write_all(writer->fd, iov, 2);
+        writer->size = 0;
+        return;
+    }
+
+    memcpy(vector_writer_reserve(writer, length), data, length);
+    writer->size += length;
+}
+
+/* Writes the separator or terminator following item number i of count. */
+static void vector_writer_end_item(VectorWriter *writer, size_t i, size_t count)
+{
+    if (i + 1 < count) {
+        vector_writer_append(writer, writer->separator, writer->separator_length);
+    } else {
+        vector_writer_append(writer, writer->terminator, writer->terminator_length);
+    }
+}
+
+/* Flushes what's left, returning whether everything was written. */
+static bool vector_writer_finish(VectorWriter *writer)
+{
+    if (writer->size > 0) {
+        vector_writer_flush(writer);
+    }
+
+    free(writer->buffer);
+    return !writer->failed;
+}
+
+/* Leads what *_vector_save_async() writes, size being the bytes after it: the numbers, or the items'
+ * sizes followed by the items with their \0 characters.
+ */
+typedef struct {
+    char magic[8];
+    uint64_t count;
+    uint64_t size;
+} VectorSaveHeader;
+
+static const char numeric_vector_save_magic[8] = "LVNUMS01";
+static const char string_vector_save_magic[8] = "LVSTRS01";
+
+/* A save or load in flight. Loads read the header first, to know how much room the items need. */
+typedef struct {
+    VectorSaveHeader header;
+    NumericVector numbers; /* Shares the saved NumericVector's data. */
+    char *items; /* Saved StringVector's sizes and items, or loaded items. */
+    uint64_t *item_sizes;
+    void *vector;
+    VectorIO *io;
+    int fd;
+    uint64_t offset;
+    uint64_t *size;
+    VectorIOCallback callback;
+    void *context;
+} VectorTransfer;
+
+static VectorTransfer *vector_transfer_create(
+        VectorIO *io,
+        void *vector,
+        int fd,
+        uint64_t offset,
+        uint64_t *size,
+        VectorIOCallback callback,
+        void *context)
+{
+    if (io == NULL || callback == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Saving and loading vectors need a VectorIO and a callback.");
+        return NULL;
+    }
+
+    VectorTransfer *transfer = (VectorTransfer *) calloc(1, sizeof(VectorTransfer));
+    if (transfer == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for a vector transfer. Error code: %i", errno);
+        return NULL;
+    }
+
+    transfer->vector = vector;
+    transfer->io = io;
+    transfer->fd = fd;
+    transfer->offset = offset;
+    transfer->size = size;
+    transfer->callback = callback;
+    transfer->context = context;
+    return transfer;
+}
+
+/* Runs the caller's callback, once, and lets transfer go. */
+static void vector_transfer_finish(VectorTransfer *transfer, bool succeeded)
+{
+    if (succeeded && transfer->size != NULL) {
+        *transfer->size = sizeof(VectorSaveHeader) + transfer->header.size;
+    }
+
+    transfer->callback(transfer->context, succeeded);
+    free(transfer->items);
+    free(transfer->item_sizes);
+    free(transfer);
+}
+
+/* Checks a loaded header, items being item_size bytes each when not 0. */
+static bool vector_transfer_check_header(const VectorTransfer *transfer, const char *magic, size_t item_size)
+{
+    const VectorSaveHeader *header = &transfer->header;
+
+    if (memcmp(header->magic, magic, sizeof(header->magic)) != 0
+        || header->count > SIZE_MAX / sizeof(uint64_t) || header->size > SIZE_MAX
+        || (item_size > 0 ? header->size != header->count * item_size : header->size < header->count * sizeof(uint64_t)))
+    {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "File descriptor: %i doesn't hold a saved vector at offset: %li.", transfer->fd, (long) transfer->offset
+        );
+
+        return false;
+    }
+
+    return true;
+}
+
+/* Takes one more reference to the data of the vector owning references, creating the counter the
+ * first time it's shared. The CAS lets several threads copy the same vector at once. The counter
+ * and the pointer to it are plain in vector.h, so they're only accessed through __atomic builtins.
+ */
+static size_t *vector_share(size_t **references)
+{
+    size_t *counter = __atomic_load_n(references, __ATOMIC_SEQ_CST);
+
+    if (counter == NULL) {
+        size_t *created = (size_t *) malloc(sizeof(*created));
+        if (created == NULL) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to allocate a reference counter. Error code: %i", errno);
+            return NULL;
+        }
+
+        *created = 1;
+        if (__atomic_compare_exchange_n(references, &counter, created, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+            counter = created;
+        } else {
+            free(created);
+        }
+    }
+
+    __atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+    atomic_fetch_add_explicit(&shared_copies, 1, memory_order_relaxed);
+    return counter;
+}
+
+/* Whether other vectors hold references to the same data, which then must not be modified. */
+static bool vector_is_shared(size_t *references)
+{
+    return references != NULL && __atomic_load_n(references, __ATOMIC_ACQUIRE) > 1;
+}
+
+/* Drops a reference. Returns whether it was the last one, so data has to be freed. */
+static bool vector_release(size_t *references)
+{
+    if (references == NULL) {
+        return true;
+    }
+
+    if (__atomic_fetch_sub(references, 1, __ATOMIC_ACQ_REL) == 1) {
+        free(references);
+        return true;
+    }
+
+    return false;
+}
+
 bool numeric_vector_init(NumericVector *vector, size_t initial_size)
 {
     logger(INFO, debug, __func__, __LINE__, "Initializing vector: %p to hold %li numbers...", vector, initial_size);
@@ -36,22 +573,35 @@ bool numeric_vector_init(NumericVector *vector, size_t initial_size)
 
     vector->capacity = initial_size;
     vector->offset = 0;
+    vector->references = NULL;
+    vector->journal = NULL;
+    vector_track(vector, false);
     return true;
 }
 
 void numeric_vector_free(NumericVector *vector)
 {
+    if (vector->journal != NULL) {
+        numeric_vector_close_journal(vector);
+    }
+
     if (!vector->data && vector->capacity == 0 && vector->offset == 0) {
         logger(ERROR, true, __func__, __LINE__, "No need to free vector.");
         return;
     }
 
     logger(INFO, debug, __func__, __LINE__, "Freeing vector: %p...", vector);
+    vector_untrack(vector);
+
+    /* Shared data is freed by the last vector holding it. */
+    if (vector_release(vector->references)) {
+        free(vector->data);
+    }
 
-    free(vector->data);
     vector->data = NULL;
     vector->capacity = 0;
     vector->offset = 0;
+    vector->references = NULL;
 
     logger(INFO, debug, __func__, __LINE__, "Vector: %p freed.", vector);
 }
@@ -74,6 +624,69 @@ static bool numeric_vector_is_valid(const NumericVector *vector, const char *fun
     return true;
 }
 
+/* Gives vector a private copy of its data if it's shared with other vectors. Every function
+ * modifying data in place calls it first.
+ */
+static bool numeric_vector_unshare(NumericVector *vector)
+{
+    if (!vector_is_shared(vector->references)) {
+        return true;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "NumericVector: %p is about to be modified. Making a copy of its shared data...", vector);
+
+    double *data = (double *) malloc((vector->capacity > 0 ? vector->capacity : 1) * sizeof(double));
+    if (data == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to copy NumericVector: %p's shared data. Error code: %i", vector, errno);
+        return false;
+    }
+
+    memcpy(data, vector->data, vector->offset * sizeof(double));
+
+    /* Other vectors may have let the data go in the meantime. */
+    if (vector_release(vector->references)) {
+        free(vector->data);
+    }
+
+    vector->data = data;
+    vector->references = NULL;
+    atomic_fetch_add_explicit(&materialized_copies, 1, memory_order_relaxed);
+    return true;
+}
+
+/* Same as numeric_vector_free(), but vector keeps its journal, for functions filling it again. */
+static void numeric_vector_free_data(NumericVector *vector)
+{
+    VectorJournal *journal = vector->journal;
+
+    vector->journal = NULL;
+    numeric_vector_free(vector);
+    vector->journal = journal;
+}
+
+/* Records a modification in vector's journal, along with the count numbers from position on, as it
+ * left them, for operations carrying items. When it can't be recorded, a snapshot is written instead.
+ */
+static void numeric_vector_log(NumericVector *vector, uint32_t operation, size_t position, size_t count)
+{
+    size_t size = operation <= VECTOR_JOURNAL_REPLACE ? count * sizeof(double) : 0;
+    char *items = vector_journal_reserve(vector->journal, operation, position, count, size);
+
+    if (items == NULL) {
+        if (vector_journal_is_stale(vector->journal)) {
+            numeric_vector_compact_journal(vector);
+        }
+
+        return;
+    }
+
+    memcpy(items, vector->data + position, size);
+
+    if (vector_journal_commit(vector->journal)) {
+        numeric_vector_sync_journal(vector);
+    }
+}
+
 bool numeric_vector_add(NumericVector *vector, double value)
 {
     logger(INFO, debug, __func__, __LINE__, "Adding value: %.2f to vector: %p...", value, vector);
@@ -98,8 +711,17 @@ bool numeric_vector_add(NumericVector *vector, double value)
         }
     }
 
+    if (!numeric_vector_unshare(vector)) {
+        return false;
+    }
+
     vector->data[vector->offset] = value;
     ++vector->offset;
+
+    if (vector->journal != NULL) {
+        numeric_vector_log(vector, VECTOR_JOURNAL_APPEND, vector->offset - 1, 1);
+    }
+
     logger(INFO, debug, __func__, __LINE__, "Value: %.2f added to NumericVector: %p.", value, vector);
     return true;
 }
@@ -127,17 +749,159 @@ bool numeric_vector_add_array(NumericVector *vector, double *numbers, size_t siz
         }
     }
 
+    if (!numeric_vector_unshare(vector)) {
+        return false;
+    }
+
     size_t i;
     for (i = 0; i < size; ++i) {
         vector->data[vector->offset] = numbers[i];
         ++vector->offset;
     }
 
+    if (vector->journal != NULL) {
+        numeric_vector_log(vector, VECTOR_JOURNAL_APPEND, vector->offset - size, size);
+    }
+
     logger(INFO, debug, __func__, __LINE__, "%li new values were added to NumericVector: %p.", i, vector);
     return i == size;
 }
 
-bool numeric_vector_reserve(NumericVector *vector, size_t spaces)
+/* Appends every number in buffer, separated by delimiter, whitespace or both. Consecutive separators
+ * count as one, so empty fields are skipped. Numbers are correctly rounded, as with strtod(), but
+ * decimal points are always dots. Fails on anything which isn't a number, leaving vector as it was.
+ */
+bool numeric_vector_parse(NumericVector *vector, const char *buffer, size_t size, char delimiter)
+{
+    if (!numeric_vector_is_valid(vector, __func__, __LINE__, true) || !numeric_vector_unshare(vector)) {
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Parsing %li bytes at %p into NumericVector: %p...", size, buffer, vector);
+
+    /* There's usually a number per separator, so room is made for all of them at once. */
+    size_t estimate = vector_find_delimiters(buffer, size, delimiter, NULL) + 1;
+    if (delimiter != '\n') {
+        estimate += vector_find_delimiters(buffer, size, '\n', NULL);
+    }
+
+    /* Numbers take at least a byte and a separator. */
+    estimate = estimate < size / 2 + 1 ? estimate : size / 2 + 1;
+
+    if (vector->offset + estimate > vector->capacity
+        && !numeric_vector_reserve(vector, vector->offset + estimate - vector->capacity))
+    {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to make room for %li numbers. Not continuing.", estimate);
+        return false;
+    }
+
+    size_t offset = vector->offset;
+    const char *end = buffer + size;
+
+    for (const char *p = buffer; p < end;) {
+        if (vector_is_separator(*p, delimiter)) {
+            ++p;
+            continue;
+        }
+
+        const char *token_end = vector_token_end(p, end, delimiter);
+        double value;
+
+        if (double_conversion_parse(p, token_end, &value) != token_end) {
+            logger(
+                    ERROR, true, __func__, __LINE__,
+                    "\"%.*s\", at byte %li, isn't a number. NumericVector: %p left as it was.",
+                    (int) (token_end - p), p, p - buffer, vector
+            );
+
+            vector->offset = offset;
+            return false;
+        }
+
+        if (vector->offset == vector->capacity && !numeric_vector_reserve(vector, vector->capacity / 2 + DEFAULT_RESIZE_VALUE)) {
+            vector->offset = offset;
+            return false;
+        }
+
+        vector->data[vector->offset] = value;
+        ++vector->offset;
+        p = token_end;
+    }
+
+    if (vector->journal != NULL) {
+        numeric_vector_log(vector, VECTOR_JOURNAL_APPEND, offset, vector->offset - offset);
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "%li numbers parsed into NumericVector: %p.", vector->offset - offset, vector);
+    return true;
+}
+
+/* Same as numeric_vector_parse(), reading fd until its end. Regular files are mapped instead of read. */
+bool numeric_vector_parse_fd(NumericVector *vector, int fd, char delimiter)
+{
+    struct stat file;
+
+    if (fstat(fd, &file) != 0) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to read file descriptor: %i. Error code: %i", fd, errno);
+        return false;
+    }
+
+    if (S_ISREG(file.st_mode) && file.st_size > 0) {
+        char *mapped = (char *) mmap(NULL, file.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mapped != MAP_FAILED) {
+#if defined(MADV_SEQUENTIAL)
+            madvise(mapped, file.st_size, MADV_SEQUENTIAL);
+#endif
+            bool parsed = numeric_vector_parse(vector, mapped, file.st_size, delimiter);
+            munmap(mapped, file.st_size);
+            return parsed;
+        }
+    }
+
+    /* Pipes, sockets and the like are read whole before being parsed. */
+    size_t capacity = 64 * 1024;
+    size_t size = 0;
+    char *buffer = (char *) malloc(capacity);
+
+    for (ssize_t n = 1; buffer != NULL && n > 0;) {
+        if (size == capacity) {
+            char *grown = (char *) realloc(buffer, capacity * 2);
+
+            if (grown == NULL) {
+                free(buffer);
+                buffer = NULL;
+                break;
+            }
+
+            buffer = grown;
+            capacity *= 2;
+        }
+
+        n = read(fd, buffer + size, capacity - size);
+
+        if (n < 0 && errno == EINTR) {
+            n = 1;
+        } else if (n < 0) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to read file descriptor: %i. Error code: %i", fd, errno);
+            free(buffer);
+            return false;
+        } else {
+            size += n;
+        }
+    }
+
+    if (buffer == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for reading file descriptor: %i. Error code: %i", fd, errno);
+        return false;
+    }
+
+    bool parsed = numeric_vector_parse(vector, buffer, size, delimiter);
+    free(buffer);
+    return parsed;
+}
+
+bool numeric_vector_reserve(NumericVector *vector, size_t spaces)
 {
     if (!numeric_vector_is_valid(vector, __func__, __LINE__, true)) {
         return false;
@@ -161,15 +925,17 @@ bool numeric_vector_reserve(NumericVector *vector, size_t spaces)
         return false;
     }
 
-    for (size_t i = 0; i < vector->capacity; ++i) {
+    /* Slots past offset were never written, so only the items held are copied. */
+    for (size_t i = 0; i < vector->offset; ++i) {
         new_vector.data[i] = vector->data[i];
         ++new_vector.offset;
     }
 
-    numeric_vector_free(vector);
+    numeric_vector_free_data(vector);
     vector->data = new_vector.data;
     vector->capacity = new_vector.capacity;
     vector->offset = new_vector.offset;
+    vector_retrack(&new_vector, vector, false);
 
     logger(
             INFO, debug, __func__, __LINE__,
@@ -215,10 +981,11 @@ bool numeric_vector_shrink_to_fit(NumericVector *vector)
         ++new_vector.offset;
     }
 
-    numeric_vector_free(vector);
+    numeric_vector_free_data(vector);
     vector->data = new_vector.data;
     vector->capacity = new_vector.capacity;
     vector->offset = new_vector.offset;
+    vector_retrack(&new_vector, vector, false);
 
     logger(
             INFO, debug, __func__, __LINE__, "NumericVector: %p shrinked. New capacity is %li.",
@@ -235,7 +1002,8 @@ bool numeric_vector_clear(NumericVector *vector)
     }
 
     size_t capacity = vector->capacity;
-    numeric_vector_free(vector);
+    VectorJournal *journal = vector->journal;
+    numeric_vector_free_data(vector);
 
     if (!numeric_vector_init(vector, capacity)) {
         logger(
@@ -245,6 +1013,11 @@ bool numeric_vector_clear(NumericVector *vector)
         );
     }
 
+    vector->journal = journal;
+    if (vector->journal != NULL) {
+        numeric_vector_log(vector, VECTOR_JOURNAL_CLEAR, 0, 0);
+    }
+
     return true;
 }
 
@@ -260,8 +1033,11 @@ bool numeric_vector_copy(const NumericVector *source, NumericVector *destination
         return false;
     }
 
+    /* A new vector just shares source's data, until one of them is modified. */
     if (initialize) {
-        if (!numeric_vector_init(destination, source->capacity)) {
+        size_t *references = vector_share(&((NumericVector *) source)->references);
+
+        if (references == NULL) {
             logger(
                     ERROR, true, __func__, __LINE__,
                     "NumericVector: %p couldn't be initialized. Can't make copy from NumericVector: %p.",
@@ -270,6 +1046,16 @@ bool numeric_vector_copy(const NumericVector *source, NumericVector *destination
 
             return false;
         }
+
+        destination->data = source->data;
+        destination->capacity = source->capacity;
+        destination->offset = source->offset;
+        destination->references = references;
+        destination->journal = NULL;
+        vector_track(destination, false);
+
+        logger(INFO, debug, __func__, __LINE__, "NumericVector: %p shares NumericVector: %p's data.", destination, source);
+        return true;
     } else if (destination->data == NULL) {
         logger(
                 ERROR, true, __func__, __LINE__,
@@ -280,10 +1066,7 @@ bool numeric_vector_copy(const NumericVector *source, NumericVector *destination
         return false;
     }
 
-    /* If initialized == true, there's no need to check if source->offset >= destination->capacity
-     * because we already know destination will have space for holding source->offset elements.
-     */
-    if (initialize == false && (destination->offset + source->offset > destination->capacity)) {
+    if (destination->offset + source->offset > destination->capacity) {
         logger(
                 INFO, debug, __func__, __LINE__,
                 "Copying NumericVector: %p into: NumericVector: %p makes NumericVector: %p to be resized.",
@@ -297,19 +1080,23 @@ bool numeric_vector_copy(const NumericVector *source, NumericVector *destination
                     source->offset, source, destination
             );
 
-            if (initialize) {
-                numeric_vector_free(destination);
-            }
-
             return false;
         }
     }
 
+    if (!numeric_vector_unshare(destination)) {
+        return false;
+    }
+
     for (size_t i = 0; i < source->offset; ++i) {
         destination->data[destination->offset] = source->data[i];
         ++destination->offset;
     }
 
+    if (destination->journal != NULL) {
+        numeric_vector_log(destination, VECTOR_JOURNAL_APPEND, destination->offset - source->offset, source->offset);
+    }
+
     logger(
             INFO, debug, __func__, __LINE__,
             "NumericVector: %p copied into NumericVector: %p.",
@@ -365,6 +1152,10 @@ bool numeric_vector_insert(NumericVector *vector, double value, size_t position)
         }
     }
 
+    if (!numeric_vector_unshare(vector)) {
+        return false;
+    }
+
     size_t pos = position;
     double current = vector->data[position];
 
@@ -402,6 +1193,10 @@ bool numeric_vector_insert(NumericVector *vector, double value, size_t position)
 
     ++vector->offset;
 
+    if (vector->journal != NULL) {
+        numeric_vector_log(vector, VECTOR_JOURNAL_INSERT, position, 1);
+    }
+
     return true;
 }
 
@@ -421,6 +1216,10 @@ bool numeric_vector_replace(NumericVector *vector, size_t position, double new_v
         return false;
     }
 
+    if (!numeric_vector_unshare(vector)) {
+        return false;
+    }
+
     logger(
             INFO, debug, __func__, __LINE__,
             "Replacing NumericVector item: %.2f at position: %li with %.2f...",
@@ -430,6 +1229,10 @@ bool numeric_vector_replace(NumericVector *vector, size_t position, double new_v
     double old_value = vector->data[position];
     vector->data[position] = new_value;
 
+    if (vector->journal != NULL) {
+        numeric_vector_log(vector, VECTOR_JOURNAL_REPLACE, position, 1);
+    }
+
     logger(INFO, debug, __func__, __LINE__, "Value: %.2f replaced by: %.2f.\n", old_value, new_value);
     return true;
 }
@@ -494,10 +1297,15 @@ bool numeric_vector_erase(NumericVector *vector, size_t start, size_t length)
         }
     }
 
-    numeric_vector_free(vector);
+    numeric_vector_free_data(vector);
     vector->data = tmp.data;
     vector->capacity = tmp.capacity;
     vector->offset = tmp.offset;
+    vector_retrack(&tmp, vector, false);
+
+    if (vector->journal != NULL) {
+        numeric_vector_log(vector, VECTOR_JOURNAL_ERASE, start, length);
+    }
 
     logger(
             INFO, debug, __func__, __LINE__,
@@ -522,14 +1330,20 @@ bool numeric_vector_swap(NumericVector *one, NumericVector *another)
     tmp.data = one->data;
     tmp.capacity = one->capacity;
     tmp.offset = one->offset;
+    tmp.references = one->references;
+    tmp.journal = one->journal;
 
     one->data = another->data;
     one->capacity = another->capacity;
     one->offset = another->offset;
+    one->references = another->references;
+    one->journal = another->journal;
 
     another->data = tmp.data;
     another->capacity = tmp.capacity;
     another->offset = tmp.offset;
+    another->references = tmp.references;
+    another->journal = tmp.journal;
 
     logger(
             INFO, debug, __func__, __LINE__,
@@ -548,6 +1362,74 @@ NumericVector: %p old capacity: %li, new capacity: %li.",
     return true;
 }
 
+/* Hands source's items over to destination, without copying them. destination is overwritten, so
+ * free it first if it holds items. source is left uninitialized.
+ */
+bool numeric_vector_move(NumericVector *source, NumericVector *destination)
+{
+    if (!numeric_vector_is_valid(source, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Moving NumericVector: %p's items into NumericVector: %p...", source, destination);
+
+    NumericVector empty = {0};
+    *destination = *source;
+    *source = empty;
+    vector_retrack(source, destination, false);
+    return true;
+}
+
+/* Detaches vector's array, which holds capacity numbers, size of them being items. The caller must
+ * free() it. vector is left uninitialized. Returns NULL on failure.
+ */
+double *numeric_vector_release(NumericVector *vector, size_t *size)
+{
+    if (!numeric_vector_is_valid(vector, __func__, __LINE__, true) || !numeric_vector_unshare(vector)) {
+        return NULL;
+    }
+
+    if (vector->journal != NULL) {
+        numeric_vector_close_journal(vector);
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Releasing NumericVector: %p's items...", vector);
+
+    /* Data isn't shared anymore, so this just frees the counter. */
+    vector_release(vector->references);
+    vector_untrack(vector);
+
+    double *data = vector->data;
+    NumericVector empty = {0};
+
+    *size = vector->offset;
+    *vector = empty;
+    return data;
+}
+
+/* Shared data is accounted in full by every vector sharing it. */
+bool numeric_vector_memory_usage(const NumericVector *vector, VectorMemoryUsage *usage)
+{
+    if (!numeric_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    VectorMemoryUsage empty = {0};
+    *usage = empty;
+
+    usage->payload = vector->offset * sizeof(double);
+    usage->slack = (vector->capacity - vector->offset) * sizeof(double);
+    usage->overhead = vector_allocation_overhead(vector->data, vector->capacity * sizeof(double));
+
+    if (vector->references != NULL) {
+        usage->metadata = sizeof(size_t);
+        usage->overhead += vector_allocation_overhead((const void *) vector->references, sizeof(size_t));
+    }
+
+    usage->total = usage->payload + usage->slots + usage->metadata + usage->slack + usage->overhead;
+    return true;
+}
+
 size_t numeric_vector_get_capacity(const NumericVector *vector)
 {
     if (!numeric_vector_is_valid(vector, __func__, __LINE__, true)) {
@@ -560,7 +1442,7 @@ size_t numeric_vector_get_capacity(const NumericVector *vector)
 /* Take out and return last item on vector or -1 on failure. */
 double numeric_vector_pop(NumericVector *vector)
 {
-    if (!numeric_vector_is_valid(vector, __func__, __LINE__, true) || vector->offset == 0) {
+    if (!numeric_vector_is_valid(vector, __func__, __LINE__, true) || vector->offset == 0 || !numeric_vector_unshare(vector)) {
         return -1;
     }
 
@@ -568,6 +1450,11 @@ double numeric_vector_pop(NumericVector *vector)
     double value = vector->data[index];
     vector->data[index] = -1;
     --vector->offset;
+
+    if (vector->journal != NULL) {
+        numeric_vector_log(vector, VECTOR_JOURNAL_POP, index, 0);
+    }
+
     return value;
 }
 
@@ -614,799 +1501,5876 @@ void numeric_vector_print(const NumericVector *vector)
     printf("Vector items: %li\n", vector->offset);
 }
 
-bool string_vector_init(StringVector *vector, size_t initial_size)
+/* Writes vector's numbers to fd, laid out as options tell, or an item per line if it's NULL. Unlike
+ * numeric_vector_print(), numbers are written in full, in their shortest form reading back as the
+ * same double unless options ask for fixed decimals, and a system call is made per buffer full.
+ */
+bool numeric_vector_write(const NumericVector *vector, int fd, const VectorWriteOptions *options)
 {
-    logger(INFO, debug, __func__, __LINE__, "Initializing StringVector with capacity to hold %li strings.", initial_size);
-
-    vector->data = (char **) malloc(initial_size * sizeof(char *));
-    if (!vector->data) {
-        logger(
-                ERROR, true, __func__, __LINE__,
-                "Impossible to initialize string vector with size: %li. Error code: %i",
-                initial_size, errno
-        );
-
+    if (!numeric_vector_is_valid(vector, __func__, __LINE__, true)) {
         return false;
     }
 
-    vector->item_sizes = (size_t *) malloc(initial_size * sizeof(size_t));
-    if (vector->item_sizes == NULL) {
-        logger(
-                ERROR, true, __func__, __LINE__,
-                "Impossible to allocate memory for StringVector. Error code: %i",
-                errno
-        );
+    logger(INFO, debug, __func__, __LINE__, "Writing NumericVector: %p to file descriptor: %i...", vector, fd);
 
-        string_vector_free(vector);
+    VectorWriter writer;
+    if (!vector_writer_init(&writer, fd, options, vector->offset * 24)) {
         return false;
     }
 
-    vector->capacity = initial_size;
-    vector->offset = 0;
+    bool fixed = options != NULL && options->fixed;
 
-    for (size_t i = 0; i < vector->capacity; ++i) {
-        vector->data[i] = NULL;
+    for (size_t i = 0; i < vector->offset && !writer.failed; ++i) {
+        if (fixed) {
+            /* Numbers with too many digits to fit in the buffer's free space get an empty one. */
+            size_t room = writer.capacity - writer.size;
+            int length = snprintf(writer.buffer + writer.size, room, "%.*f", options->precision, vector->data[i]);
+
+            if (length >= 0 && (size_t) length >= room) {
+                vector_writer_flush(&writer);
+                room = writer.capacity;
+                length = snprintf(writer.buffer, room, "%.*f", options->precision, vector->data[i]);
+            }
+
+            if (length < 0 || (size_t) length >= room) {
+                logger(ERROR, true, __func__, __LINE__, "Impossible to format number #%li with %i decimals.", i, options->precision);
+                free(writer.buffer);
+                return false;
+            }
+
+            writer.size += length;
+        } else {
+            char *number = vector_writer_reserve(&writer, DOUBLE_CONVERSION_MAX_LENGTH);
+            writer.size += double_conversion_format(vector->data[i], number);
+        }
+
+        vector_writer_end_item(&writer, i, vector->offset);
     }
 
-    logger(INFO, debug, __func__, __LINE__, "Vector: %p initialized with %li spaces.", vector, initial_size);
+    return vector_writer_finish(&writer);
+}
 
-    return true;
+static void numeric_vector_saved(void *context, bool succeeded)
+{
+    VectorTransfer *transfer = (VectorTransfer *) context;
+
+    numeric_vector_free(&transfer->numbers);
+    vector_transfer_finish(transfer, succeeded);
 }
 
-static bool string_vector_is_valid(const StringVector *vector, const char *func, int line, bool show_suggestions)
+/* Queues a write of vector's numbers at offset of fd, a regular file, handed over by the next
+ * vector_io_poll(). The numbers are shared until written, so vector may be modified right away:
+ * it makes a copy of its own then. size tells how many bytes are written, to lay saves out.
+ */
+bool numeric_vector_save_async(
+        VectorIO *io,
+        const NumericVector *vector,
+        int fd,
+        uint64_t offset,
+        uint64_t *size,
+        VectorIOCallback callback,
+        void *context)
 {
-    char suggestion[] = "Please call string_vector_init() before using this function.";
+    if (!numeric_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
 
-    if (vector->data == NULL) {
-        logger(
-                ERROR, true, func, line,
-                "StringVector: %p isn't properly initialized.%s",
-                vector,
-                (show_suggestions ? suggestion : "")
-        );
+    VectorTransfer *transfer = vector_transfer_create(io, NULL, fd, offset, NULL, callback, context);
+    if (transfer == NULL) {
+        return false;
+    }
+
+    if (!numeric_vector_copy(vector, &transfer->numbers, true)) {
+        free(transfer);
+        return false;
+    }
+
+    memcpy(transfer->header.magic, numeric_vector_save_magic, sizeof(transfer->header.magic));
+    transfer->header.count = transfer->numbers.offset;
+    transfer->header.size = transfer->numbers.offset * sizeof(double);
 
+    struct iovec iov[2] = {
+        {&transfer->header, sizeof(transfer->header)},
+        {transfer->numbers.data, transfer->header.size}
+    };
+
+    if (!vector_io_submit(io, true, fd, iov, 2, offset, numeric_vector_saved, transfer)) {
+        numeric_vector_free(&transfer->numbers);
+        free(transfer);
         return false;
     }
 
+    if (size != NULL) {
+        *size = sizeof(transfer->header) + transfer->header.size;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Saving %li numbers of NumericVector: %p at offset: %li...", vector->offset, vector, (long) offset);
     return true;
 }
 
-void string_vector_free(StringVector *vector)
+static void numeric_vector_loaded(void *context, bool succeeded)
 {
-    logger(INFO, debug, __func__, __LINE__, "Freeing StringVector: %p...", vector);
+    VectorTransfer *transfer = (VectorTransfer *) context;
+    NumericVector *vector = (NumericVector *) transfer->vector;
 
-    if (vector->data != NULL) {
-        for (size_t i = 0; i < vector->capacity; ++i) {
-            if (vector->data[i] != NULL) {
-                logger(INFO, debug, __func__, __LINE__, "Freeing StringVector item #%li: %p...", i, vector->data[i]);
-                free(vector->data[i]);
-                logger(INFO, debug, __func__, __LINE__, "StringVector item #%li: %p freed.", i, vector->data[i]);
-                vector->data[i] = NULL;
-            }
-        }
+    if (succeeded) {
+        vector->offset += transfer->header.count;
 
-        logger(INFO, debug, __func__, __LINE__, "Freeing StringVector data pointer: %p...", vector->data);
-        free(vector->data);
-        logger(INFO, debug, __func__, __LINE__, "StringVector data: %p freed...", vector->data);
-        vector->data = NULL;
+        if (vector->journal != NULL) {
+            numeric_vector_log(vector, VECTOR_JOURNAL_APPEND, vector->offset - transfer->header.count, transfer->header.count);
+        }
     }
 
-    if (vector->item_sizes != NULL) {
-        free(vector->item_sizes);
-        vector->item_sizes = NULL;
-    }
+    vector_transfer_finish(transfer, succeeded);
+}
 
-    vector->capacity = 0;
-    vector->offset = 0;
+/* Makes room for the numbers the header announces, and reads them straight into it. */
+static void numeric_vector_load_header(void *context, bool succeeded)
+{
+    VectorTransfer *transfer = (VectorTransfer *) context;
+    NumericVector *vector = (NumericVector *) transfer->vector;
+    size_t count = transfer->header.count;
+
+    succeeded = succeeded && vector_transfer_check_header(transfer, numeric_vector_save_magic, sizeof(double))
+            && numeric_vector_unshare(vector)
+            && (vector->offset + count <= vector->capacity || numeric_vector_reserve(vector, vector->offset + count - vector->capacity));
+
+    if (succeeded) {
+        struct iovec iov = {vector->data + vector->offset, count * sizeof(double)};
+        succeeded = vector_io_submit(
+                transfer->io, false, transfer->fd, &iov, 1, transfer->offset + sizeof(transfer->header),
+                numeric_vector_loaded, transfer
+        );
+    }
 
-    logger(INFO, debug, __func__, __LINE__, "StringVector: %p freed.", vector);
+    if (!succeeded) {
+        vector_transfer_finish(transfer, false);
+    }
 }
 
-static size_t string_vector_item_strlen(const char *item)
+/* Queues a read of the numbers numeric_vector_save_async() wrote at offset of fd, appended to vector
+ * by the vector_io_poll() calls reading them. vector mustn't be used, nor loaded into again, until
+ * callback runs; size, if not NULL, then tells how many bytes were read.
+ */
+bool numeric_vector_load_async(
+        VectorIO *io,
+        NumericVector *vector,
+        int fd,
+        uint64_t offset,
+        uint64_t *size,
+        VectorIOCallback callback,
+        void *context)
 {
-    logger(INFO, debug, __func__, __LINE__, "Calculating string size...");
+    if (!numeric_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
 
-    size_t size = 0;
-    while (item[size] != '\0') {
-        ++size;
+    VectorTransfer *transfer = vector_transfer_create(io, vector, fd, offset, size, callback, context);
+    if (transfer == NULL) {
+        return false;
     }
 
-    logger(INFO, debug, __func__, __LINE__, "Deducted string size is %li.", size);
-    return size;
+    struct iovec iov = {&transfer->header, sizeof(transfer->header)};
+
+    if (!vector_io_submit(io, false, fd, &iov, 1, offset, numeric_vector_load_header, transfer)) {
+        free(transfer);
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Loading NumericVector: %p from offset: %li...", vector, (long) offset);
+    return true;
 }
 
-/* Blindly trust on from having at least n items, and to having at least n bytes. */
-static void string_vector_copy_item(const char *from, char *to, size_t n)
+/* Applies a record of vector's journal, through the same function which logged it. */
+static bool numeric_vector_replay(NumericVector *vector, const VectorJournalRecord *record)
 {
-    logger(INFO, debug, __func__, __LINE__, "Copying string: %s into %p...", from, to);
+    double *numbers = (double *) (record + 1);
 
-    size_t i;
-    for (i = 0; i < n; ++i) {
-        to[i] = from[i];
+    if (record->operation <= VECTOR_JOURNAL_REPLACE && record->size != record->count * sizeof(double)) {
+        return false;
     }
-    to[i] = '\0';
 
-    logger(INFO, debug, __func__, __LINE__, "%li bytes were copied to %p.", i, to);
+    switch (record->operation) {
+        case VECTOR_JOURNAL_APPEND:
+            return record->position == vector->offset && numeric_vector_add_array(vector, numbers, record->count);
+        case VECTOR_JOURNAL_INSERT:
+            return record->count == 1 && record->position < vector->offset
+                    && numeric_vector_insert(vector, numbers[0], record->position);
+        case VECTOR_JOURNAL_REPLACE:
+            return record->count == 1 && numeric_vector_replace(vector, record->position, numbers[0]);
+        case VECTOR_JOURNAL_ERASE:
+            return numeric_vector_erase(vector, record->position, record->count);
+        case VECTOR_JOURNAL_POP:
+            if (record->position + 1 != vector->offset) {
+                return false;
+            }
+
+            numeric_vector_pop(vector);
+            return true;
+        case VECTOR_JOURNAL_CLEAR:
+            return numeric_vector_clear(vector);
+        default:
+            return false;
+    }
 }
 
-bool string_vector_add(StringVector *vector, const char *value)
+/* Reads the snapshot into vector, then replays the records logged since. valid_size tells how many
+ * bytes of records were whole, the rest having been torn by a crash.
+ */
+static bool numeric_vector_recover(NumericVector *vector, const VectorJournalContents *contents, size_t *valid_size)
 {
-    logger(INFO, debug, __func__, __LINE__, "Adding value: %s to vector: %p...", value, vector);
+    VectorSaveHeader header = {{0}, 0, 0};
+    const VectorJournalRecord *record;
+    size_t added = 0;
+
+    if (contents->snapshot_fd >= 0
+        && (!vector_journal_read(contents, &header, sizeof(header), 0)
+            || memcmp(header.magic, numeric_vector_save_magic, sizeof(header.magic)) != 0
+            || header.size != header.count * sizeof(double) || header.size != contents->snapshot_size - sizeof(header)))
+    {
+        logger(ERROR, true, __func__, __LINE__, "The snapshot NumericVector: %p is recovered from is damaged.", vector);
+        return false;
+    }
 
-    if (!string_vector_is_valid(vector, __func__, __LINE__, false)) {
-        logger(WARN, debug, __func__, __LINE__, "Initializing it with the default size value: %i.",
-                DEFAULT_RESIZE_VALUE);
+    /* Room is made at once for every number the records may add. */
+    for (size_t offset = 0; (record = vector_journal_next(contents, &offset)) != NULL;) {
+        added += record->operation == VECTOR_JOURNAL_APPEND || record->operation == VECTOR_JOURNAL_INSERT ? record->count : 0;
+        *valid_size = offset;
+    }
 
-        if (!string_vector_init(vector, DEFAULT_RESIZE_VALUE)) {
-            logger(ERROR, true, __func__, __LINE__, "Impossible to initialize StringVector. Not continuing.");
-            return false;
-        }
+    if (!numeric_vector_unshare(vector)
+        || (header.count + added > vector->capacity && !numeric_vector_reserve(vector, header.count + added - vector->capacity))
+        || !vector_journal_read(contents, vector->data, header.size, sizeof(header)))
+    {
+        return false;
     }
 
-    if (vector->offset + 1 > vector->capacity) {
+    vector->offset = header.count;
+
+    for (size_t offset = 0; offset < *valid_size;) {
+        size_t at = offset;
+
+        if (!numeric_vector_replay(vector, vector_journal_next(contents, &offset))) {
+            logger(ERROR, true, __func__, __LINE__, "The record at byte %li of NumericVector: %p's journal doesn't apply to it.", at, vector);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Recovers vector, which must be empty, from the journal at path: the snapshot at path, and the
+ * modifications logged to path.log since it was written. Then every modification of vector is
+ * logged there too, being on disk once numeric_vector_sync_journal() returns, or once sync_bytes
+ * were logged since the last sync, when sync_bytes isn't 0. A missing journal is created empty.
+ * vector is left empty on failure.
+ */
+bool numeric_vector_open_journal(NumericVector *vector, const char *path, size_t sync_bytes)
+{
+    if (!numeric_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (vector->offset > 0 || vector->journal != NULL) {
+        logger(ERROR, true, __func__, __LINE__, "NumericVector: %p must be empty, without a journal, to open one.", vector);
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Recovering NumericVector: %p from journal: %s...", vector, path);
+
+    VectorJournalContents contents;
+    VectorJournal *journal = vector_journal_open(path, sync_bytes, &contents);
+    size_t valid_size = 0;
+
+    if (journal == NULL) {
+        return false;
+    }
+
+    if (!numeric_vector_recover(vector, &contents, &valid_size) || !vector_journal_start(journal, &contents, valid_size)) {
+        vector_journal_discard(&contents);
+        vector_journal_close(journal);
+        vector->offset = 0;
+        return false;
+    }
+
+    vector->journal = journal;
+    logger(INFO, debug, __func__, __LINE__, "NumericVector: %p recovered with %li numbers.", vector, vector->offset);
+    return true;
+}
+
+/* Waits for every modification logged to be on disk. Writes a new snapshot instead when the log has
+ * outgrown the last one, or when modifications couldn't be logged.
+ */
+bool numeric_vector_sync_journal(NumericVector *vector)
+{
+    if (!numeric_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (vector->journal == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "NumericVector: %p has no journal.", vector);
+        return false;
+    }
+
+    if (vector_journal_needs_compaction(vector->journal)) {
+        return numeric_vector_compact_journal(vector);
+    }
+
+    return vector_journal_sync(vector->journal);
+}
+
+/* Writes vector's numbers to a new snapshot, which replaces the old one and its log once on disk. */
+bool numeric_vector_compact_journal(NumericVector *vector)
+{
+    if (!numeric_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (vector->journal == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "NumericVector: %p has no journal.", vector);
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Writing a snapshot of NumericVector: %p's %li numbers...", vector, vector->offset);
+
+    int fd = vector_journal_begin_snapshot(vector->journal);
+    if (fd < 0) {
+        return false;
+    }
+
+    VectorSaveHeader header = {{0}, vector->offset, vector->offset * sizeof(double)};
+    memcpy(header.magic, numeric_vector_save_magic, sizeof(header.magic));
+
+    struct iovec iov[2] = {
+        {&header, sizeof(header)},
+        {vector->data, header.size}
+    };
+
+    return vector_journal_end_snapshot(vector->journal, fd, vector_write_all(fd, iov, 2));
+}
+
+/* Syncs vector's journal, and stops logging vector's modifications to it. */
+bool numeric_vector_close_journal(NumericVector *vector)
+{
+    if (vector->journal == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "NumericVector: %p has no journal.", vector);
+        return false;
+    }
+
+    bool synced = numeric_vector_sync_journal(vector);
+
+    vector_journal_close(vector->journal);
+    vector->journal = NULL;
+    return synced;
+}
+
+typedef struct {
+    NumericVector *vector;
+    NumericVectorMapFunction function;
+    void *context;
+} NumericVectorMapJob;
+
+typedef struct {
+    const NumericVector *vector;
+    NumericVectorReduceFunction function;
+    void *context;
+    double initial;
+    double *partials;
+} NumericVectorReduceJob;
+
+static size_t numeric_vector_parallel_chunks(const NumericVector *vector)
+{
+    return (vector->offset + NUMERIC_VECTOR_PARALLEL_CHUNK - 1) / NUMERIC_VECTOR_PARALLEL_CHUNK;
+}
+
+static void numeric_vector_map_chunk(void *context, size_t chunk)
+{
+    NumericVectorMapJob *job = (NumericVectorMapJob *) context;
+    size_t start = chunk * NUMERIC_VECTOR_PARALLEL_CHUNK;
+    size_t end = start + NUMERIC_VECTOR_PARALLEL_CHUNK < job->vector->offset ? start + NUMERIC_VECTOR_PARALLEL_CHUNK : job->vector->offset;
+
+    for (size_t i = start; i < end; ++i) {
+        job->vector->data[i] = job->function(job->vector->data[i], job->context);
+    }
+}
+
+static void numeric_vector_reduce_chunk(void *context, size_t chunk)
+{
+    NumericVectorReduceJob *job = (NumericVectorReduceJob *) context;
+    size_t start = chunk * NUMERIC_VECTOR_PARALLEL_CHUNK;
+    size_t end = start + NUMERIC_VECTOR_PARALLEL_CHUNK < job->vector->offset ? start + NUMERIC_VECTOR_PARALLEL_CHUNK : job->vector->offset;
+    double accumulator = job->initial;
+
+    for (size_t i = start; i < end; ++i) {
+        accumulator = job->function(accumulator, job->vector->data[i], job->context);
+    }
+
+    job->partials[chunk] = accumulator;
+}
+
+/* Sets the number of threads used by numeric_vector_parallel_*() functions. 0, the default,
+ * means one per online CPU.
+ */
+bool libvector_set_threads(size_t threads)
+{
+    return thread_pool_set_size(threads);
+}
+
+/* Replaces every item of vector with function(item, context), spreading the work over libvector's
+ * thread pool. function must be safe to call from several threads at once.
+ */
+bool numeric_vector_parallel_map(NumericVector *vector, NumericVectorMapFunction function, void *context)
+{
+    if (!numeric_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (!numeric_vector_unshare(vector)) {
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Mapping %li items of NumericVector: %p in parallel...", vector->offset, vector);
+
+    /* Every item may change, so the next snapshot records them rather than the log. */
+    if (vector->journal != NULL) {
+        vector_journal_invalidate(vector->journal);
+    }
+
+    NumericVectorMapJob job = { vector, function, context };
+    return thread_pool_run(numeric_vector_map_chunk, &job, numeric_vector_parallel_chunks(vector));
+}
+
+/* Folds vector's items with function, spreading the work over libvector's thread pool, and stores
+ * the outcome in result. function must be associative, and initial its identity element (e.g., 0
+ * for a sum). Items are split into chunks of NUMERIC_VECTOR_PARALLEL_CHUNK items no matter how
+ * many threads there are, and partial results are combined in chunk order, so floating-point
+ * results are the same from one run to another.
+ */
+bool numeric_vector_parallel_reduce(const NumericVector *vector, NumericVectorReduceFunction function,
+        double initial, void *context, double *result)
+{
+    if (!numeric_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Reducing %li items of NumericVector: %p in parallel...", vector->offset, vector);
+
+    size_t chunks = numeric_vector_parallel_chunks(vector);
+    NumericVectorReduceJob job = { vector, function, context, initial, NULL };
+
+    job.partials = (double *) malloc((chunks > 0 ? chunks : 1) * sizeof(double));
+    if (job.partials == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for %li partial results. Error code: %i", chunks, errno);
+        return false;
+    }
+
+    if (!thread_pool_run(numeric_vector_reduce_chunk, &job, chunks)) {
+        free(job.partials);
+        return false;
+    }
+
+    double accumulator = initial;
+    for (size_t i = 0; i < chunks; ++i) {
+        accumulator = function(accumulator, job.partials[i], context);
+    }
+
+    free(job.partials);
+    *result = accumulator;
+    return true;
+}
+
+/* Segment k of a ConcurrentNumericVector holds first_segment_size << k numbers, so segment k starts
+ * at position first_segment_size * (2^k - 1). Returns the segment holding position, and stores
+ * position's index inside it in index.
+ */
+static size_t concurrent_numeric_vector_segment(const ConcurrentNumericVector *vector, size_t position, size_t *index)
+{
+    size_t blocks = (position >> __builtin_ctzll(vector->first_segment_size)) + 1;
+    size_t segment = (sizeof(unsigned long long) * 8 - 1) - __builtin_clzll(blocks);
+
+    *index = position - vector->first_segment_size * (((size_t) 1 << segment) - 1);
+    return segment;
+}
+
+/* Numbers of a segment are followed by one flag each, set once the number is written. */
+static _Atomic unsigned char *concurrent_numeric_vector_flags(const ConcurrentNumericVector *vector, double *data, size_t segment)
+{
+    return (_Atomic unsigned char *) (data + (vector->first_segment_size << segment));
+}
+
+static double *concurrent_numeric_vector_alloc_segment(const ConcurrentNumericVector *vector, size_t segment)
+{
+    size_t size = vector->first_segment_size << segment;
+
+    /* calloc(), so flags start cleared. */
+    double *data = (double *) calloc(size, sizeof(double) + sizeof(unsigned char));
+    if (data == NULL) {
         logger(
-                INFO, debug, __func__, __LINE__,
-                "Adding new value causes vector to be resized. Resizing with the default size value: %i",
-                DEFAULT_RESIZE_VALUE
+                ERROR, true, __func__, __LINE__,
+                "Impossible to allocate segment #%li of ConcurrentNumericVector: %p. Error code: %i",
+                segment, vector, errno
         );
+    }
 
-        if (!string_vector_reserve(vector, DEFAULT_RESIZE_VALUE)) {
-            logger(ERROR, true, __func__, __LINE__, "StringVector couldn't be resized. Not continuing.");
+    return data;
+}
+
+bool concurrent_numeric_vector_init(ConcurrentNumericVector *vector, size_t initial_size)
+{
+    logger(INFO, debug, __func__, __LINE__, "Initializing ConcurrentNumericVector: %p to hold %li numbers...", vector, initial_size);
+
+    /* A power of two, so segment boundaries are computed with a single clz. */
+    size_t first_segment_size = 1;
+    while (first_segment_size < initial_size || first_segment_size < DEFAULT_RESIZE_VALUE) {
+        first_segment_size <<= 1;
+    }
+
+    vector->first_segment_size = first_segment_size;
+
+    double *segment = concurrent_numeric_vector_alloc_segment(vector, 0);
+    if (segment == NULL) {
+        return false;
+    }
+
+    vector->segments[0] = segment;
+    for (size_t i = 1; i < CONCURRENT_NUMERIC_VECTOR_SEGMENTS; ++i) {
+        vector->segments[i] = NULL;
+    }
+
+    vector->offset = 0;
+    vector->committed = 0;
+
+    logger(INFO, debug, __func__, __LINE__, "ConcurrentNumericVector: %p initialized with %li spaces.", vector, first_segment_size);
+    return true;
+}
+
+/* Must not run concurrently with any other operation on vector. */
+void concurrent_numeric_vector_free(ConcurrentNumericVector *vector)
+{
+    logger(INFO, debug, __func__, __LINE__, "Freeing ConcurrentNumericVector: %p...", vector);
+
+    for (size_t i = 0; i < CONCURRENT_NUMERIC_VECTOR_SEGMENTS; ++i) {
+        free(__atomic_load_n(&vector->segments[i], __ATOMIC_RELAXED));
+        __atomic_store_n(&vector->segments[i], NULL, __ATOMIC_RELAXED);
+    }
+
+    __atomic_store_n(&vector->offset, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&vector->committed, 0, __ATOMIC_RELAXED);
+    vector->first_segment_size = 0;
+
+    logger(INFO, debug, __func__, __LINE__, "ConcurrentNumericVector: %p freed.", vector);
+}
+
+/* Commits the number just written at position, whose flag is flag, and every written one after it.
+ * Every add helps, so none waits for a slower one, and a number written while another thread
+ * stopped just before it is still committed: flags and committed are sequentially consistent, so
+ * either that thread sees the flag, or this one sees committed reach its position.
+ */
+static void concurrent_numeric_vector_commit(ConcurrentNumericVector *vector, size_t position, _Atomic unsigned char *flag)
+{
+    size_t committed;
+
+    /* Usually every number before this one is committed, and no other thread can commit this one
+     * as its flag isn't set, so a store is enough.
+     */
+    if (__atomic_load_n(&vector->committed, __ATOMIC_ACQUIRE) == position) {
+        committed = position + 1;
+        __atomic_store_n(&vector->committed, committed, __ATOMIC_SEQ_CST);
+    } else {
+        atomic_store(flag, 1);
+        committed = __atomic_load_n(&vector->committed, __ATOMIC_SEQ_CST);
+    }
+
+    /* Unclaimed positions have no flag set, so they stop this as well. */
+    for (;;) {
+        size_t index;
+        size_t segment = concurrent_numeric_vector_segment(vector, committed, &index);
+        double *data = segment < CONCURRENT_NUMERIC_VECTOR_SEGMENTS
+                ? __atomic_load_n(&vector->segments[segment], __ATOMIC_ACQUIRE) : NULL;
+
+        if (data == NULL || !atomic_load(&concurrent_numeric_vector_flags(vector, data, segment)[index])) {
+            break;
+        }
+
+        /* On failure, committed is reloaded and helping goes on from there. */
+        if (__atomic_compare_exchange_n(&vector->committed, &committed, committed + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+            ++committed;
+        }
+    }
+}
+
+/* Safe to call from several threads at once. A position is only claimed once its segment exists, so
+ * a failed allocation claims nothing, and growing allocates a new segment instead of moving existing
+ * numbers, so no reader ever sees a freed buffer. Numbers are plain doubles: each one is written once,
+ * before it's committed, and readers only look below committed, so no read races with a write.
+ */
+bool concurrent_numeric_vector_add(ConcurrentNumericVector *vector, double value)
+{
+    size_t position = __atomic_load_n(&vector->offset, __ATOMIC_RELAXED);
+    size_t index;
+    size_t segment;
+    double *data;
+
+    do {
+        segment = concurrent_numeric_vector_segment(vector, position, &index);
+
+        /* That's first_segment_size * 2^48 numbers, it can't happen before running out of memory. */
+        if (segment >= CONCURRENT_NUMERIC_VECTOR_SEGMENTS) {
+            logger(ERROR, true, __func__, __LINE__, "ConcurrentNumericVector: %p is full. Impossible to add value: %.2f.", vector, value);
             return false;
         }
+
+        data = __atomic_load_n(&vector->segments[segment], __ATOMIC_ACQUIRE);
+
+        if (data == NULL) {
+            double *expected = NULL;
+
+            data = concurrent_numeric_vector_alloc_segment(vector, segment);
+            if (data == NULL) {
+                return false;
+            }
+
+            /* Several threads may race to allocate the same segment, only one of them wins. */
+            if (!__atomic_compare_exchange_n(&vector->segments[segment], &expected, data, false,
+                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            {
+                free(data);
+                data = expected;
+            }
+        }
+    } while (!__atomic_compare_exchange_n(&vector->offset, &position, position + 1, true,
+                __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    data[index] = value;
+    concurrent_numeric_vector_commit(vector, position, &concurrent_numeric_vector_flags(vector, data, segment)[index]);
+    return true;
+}
+
+/* Number of numbers added so far. Adds still running, and the ones claimed after them, aren't
+ * counted until they're written.
+ */
+size_t concurrent_numeric_vector_get_size(const ConcurrentNumericVector *vector)
+{
+    return __atomic_load_n(&vector->committed, __ATOMIC_ACQUIRE);
+}
+
+/* Returns -1 on failure, e.g., position >= vector bounds. */
+double concurrent_numeric_vector_get_at(const ConcurrentNumericVector *vector, size_t position)
+{
+    if (position >= concurrent_numeric_vector_get_size(vector)) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "ConcurrentNumericVector: %p doesn't have any value on position: %li.",
+                vector, position
+        );
+
+        return -1;
     }
 
-    size_t size = string_vector_item_strlen(value);
-    vector->data[vector->offset] = (char *) malloc((size + 1) * sizeof(char));
+    size_t index;
+    size_t segment = concurrent_numeric_vector_segment(vector, position, &index);
+    return __atomic_load_n(&vector->segments[segment], __ATOMIC_ACQUIRE)[index];
+}
 
-    if (vector->data[vector->offset] == NULL) {
+/* Copies every number of source, in order, into a contiguous NumericVector initialized by this function.
+ * It may run alongside concurrent_numeric_vector_add(), numbers added meanwhile being left out.
+ */
+bool concurrent_numeric_vector_snapshot(const ConcurrentNumericVector *source, NumericVector *destination)
+{
+    size_t size = concurrent_numeric_vector_get_size(source);
+
+    if (!numeric_vector_init(destination, size)) {
         logger(
                 ERROR, true, __func__, __LINE__,
-                "Impossible to allocate memory for string value: %s. Error code: %i",
-                value, errno
+                "NumericVector: %p couldn't be initialized. Can't make snapshot of ConcurrentNumericVector: %p.",
+                destination, source
         );
 
         return false;
     }
 
-    string_vector_copy_item(value, vector->data[vector->offset], size);
-    vector->item_sizes[vector->offset] = size + 1;
-    ++vector->offset;
+    /* Whole segments at a time. */
+    for (size_t segment = 0; destination->offset < size; ++segment) {
+        size_t segment_size = source->first_segment_size << segment;
+        size_t n = size - destination->offset < segment_size ? size - destination->offset : segment_size;
+        const double *data = __atomic_load_n(&source->segments[segment], __ATOMIC_ACQUIRE);
 
-    logger(INFO, debug, __func__, __LINE__, "Value: %s added to vector: %p.", vector->data[vector->offset - 1], vector);
+        memcpy(&destination->data[destination->offset], data, n * sizeof(double));
+        destination->offset += n;
+    }
+
+    logger(
+            INFO, debug, __func__, __LINE__,
+            "Snapshot of ConcurrentNumericVector: %p made into NumericVector: %p.",
+            source, destination
+    );
 
     return true;
 }
 
-bool string_vector_add_array(StringVector *vector, const char *values[], size_t n)
+/* Same as concurrent_numeric_vector_snapshot(), but frees source afterwards. */
+bool concurrent_numeric_vector_freeze(ConcurrentNumericVector *source, NumericVector *destination)
 {
-    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+    if (!concurrent_numeric_vector_snapshot(source, destination)) {
         return false;
     }
 
-    if (vector->offset + n > vector->capacity) {
-        logger(INFO, debug, __func__, __LINE__, "Adding array causes vector to be resized. Resizing with %li more spaces...", n);
+    concurrent_numeric_vector_free(source);
+    return true;
+}
 
-        if (!string_vector_reserve(vector, n)) {
-            logger(ERROR, true, __func__, __LINE__, "Impossible to resize vector. Not continuing.");
-            return false;
-        }
+bool string_vector_init(StringVector *vector, size_t initial_size)
+{
+    logger(INFO, debug, __func__, __LINE__, "Initializing StringVector with capacity to hold %li strings.", initial_size);
+
+    vector->batches = NULL;
+    vector->batch_sizes = NULL;
+    vector->batch_items = NULL;
+    vector->batch_count = 0;
+    vector->hashes = NULL;
+    vector->hash_index = NULL;
+    vector->hash_counts = NULL;
+    vector->hash_index_capacity = 0;
+    vector->spares = 0;
+    vector->buffer_sizes = NULL;
+    vector->pool = NULL;
+    vector->mapped = NULL;
+    vector->mapped_size = 0;
+    vector->references = NULL;
+    vector->journal = NULL;
+
+    vector->data = (char **) malloc(initial_size * sizeof(char *));
+    if (!vector->data) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "Impossible to initialize string vector with size: %li. Error code: %i",
+                initial_size, errno
+        );
+
+        return false;
+    }
+
+    vector->item_sizes = (size_t *) malloc(initial_size * sizeof(size_t));
+    if (vector->item_sizes == NULL) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "Impossible to allocate memory for StringVector. Error code: %i",
+                errno
+        );
+
+        string_vector_free(vector);
+        return false;
+    }
+
+    vector->capacity = initial_size;
+    vector->offset = 0;
+
+    for (size_t i = 0; i < vector->capacity; ++i) {
+        vector->data[i] = NULL;
+    }
+
+    vector_track(vector, true);
+    logger(INFO, debug, __func__, __LINE__, "Vector: %p initialized with %li spaces.", vector, initial_size);
+
+    return true;
+}
+
+static bool string_vector_is_valid(const StringVector *vector, const char *func, int line, bool show_suggestions)
+{
+    char suggestion[] = "Please call string_vector_init() before using this function.";
+
+    if (vector->data == NULL) {
+        logger(
+                ERROR, true, func, line,
+                "StringVector: %p isn't properly initialized.%s",
+                vector,
+                (show_suggestions ? suggestion : "")
+        );
+
+        return false;
+    }
+
+    return true;
+}
+
+/* Returns the index of the batch item lives in, plus one, or 0 if it isn't in any. */
+static size_t string_vector_find_batch(const StringVector *vector, const char *item)
+{
+    /* Batches are sorted by address, so look for the last one starting at or before item. */
+    size_t low = 0;
+    size_t high = vector->batch_count;
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+
+        if ((uintptr_t) vector->batches[middle] <= (uintptr_t) item) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low > 0 && (uintptr_t) item < (uintptr_t) vector->batches[low - 1] + vector->batch_sizes[low - 1] ? low : 0;
+}
+
+static bool string_vector_item_in_file(const StringVector *vector, const char *item)
+{
+    return vector->mapped != NULL && (uintptr_t) item - (uintptr_t) vector->mapped < vector->mapped_size;
+}
+
+/* Tells whether item lives inside one of vector's batches, or the file it was mapped from, instead
+ * of having its own allocation.
+ */
+static bool string_vector_item_in_batch(const StringVector *vector, const char *item)
+{
+    return string_vector_item_in_file(vector, item) || string_vector_find_batch(vector, item) > 0;
+}
+
+/* Items not fitting in any of the pool's size classes, or handed over by the caller, are still
+ * allocated with malloc().
+ */
+static char *string_vector_alloc_item(const StringVector *vector, size_t size)
+{
+    char *item = vector->pool == NULL ? NULL : string_pool_alloc(vector->pool, size);
+    return item != NULL ? item : (char *) malloc(size * sizeof(char));
+}
+
+static bool string_vector_item_in_pool(const StringVector *vector, const char *item)
+{
+    return vector->pool != NULL && string_pool_owns(vector->pool, item);
+}
+
+/* Frees item. A batch is only freed along with the last of its items, and a mapped file is unmapped
+ * by string_vector_free().
+ */
+static void string_vector_free_item(StringVector *vector, char *item)
+{
+    if (item == NULL || string_vector_item_in_file(vector, item)) {
+        return;
+    }
+
+    if (string_vector_item_in_pool(vector, item)) {
+        string_pool_free(vector->pool, item);
+        return;
+    }
+
+    size_t batch = string_vector_find_batch(vector, item);
+
+    if (batch == 0) {
+        free(item);
+    } else if (--vector->batch_items[batch - 1] == 0) {
+        logger(INFO, debug, __func__, __LINE__, "Freeing StringVector batch: %p, as its last item is gone...", vector->batches[batch - 1]);
+        free(vector->batches[batch - 1]);
+
+        size_t following = vector->batch_count - batch;
+        memmove(&vector->batches[batch - 1], &vector->batches[batch], following * sizeof(char *));
+        memmove(&vector->batch_sizes[batch - 1], &vector->batch_sizes[batch], following * sizeof(size_t));
+        memmove(&vector->batch_items[batch - 1], &vector->batch_items[batch], following * sizeof(size_t));
+        --vector->batch_count;
+    }
+}
+
+/* Frees the buffers kept by string_vector_clear_retaining(), for functions which need the slots
+ * after offset to be empty.
+ */
+static void string_vector_drop_spares(StringVector *vector)
+{
+    for (size_t i = vector->offset; i < vector->offset + vector->spares; ++i) {
+        string_vector_free_item(vector, vector->data[i]);
+        vector->data[i] = NULL;
+    }
+
+    vector->spares = 0;
+}
+
+/* Bytes of the buffer at position, which may be more than its item's once it's been reused. */
+static size_t string_vector_buffer_size(const StringVector *vector, size_t position)
+{
+    return vector->buffer_sizes != NULL ? vector->buffer_sizes[position] : vector->item_sizes[position];
+}
+
+/* Records that the item just stored at position has a buffer of its own size. */
+static void string_vector_fit_buffer(StringVector *vector, size_t position)
+{
+    if (vector->buffer_sizes != NULL) {
+        vector->buffer_sizes[position] = vector->item_sizes[position];
+    }
+}
+
+/* Spares must follow offset without gaps. When an item is taken out and the slot at offset is left
+ * empty, the last spare fills it.
+ */
+static void string_vector_fill_spare_gap(StringVector *vector)
+{
+    if (vector->spares > 0) {
+        size_t last = vector->offset + vector->spares;
+
+        vector->data[vector->offset] = vector->data[last];
+        vector->item_sizes[vector->offset] = vector->item_sizes[last];
+        vector->data[last] = NULL;
+
+        if (vector->buffer_sizes != NULL) {
+            vector->buffer_sizes[vector->offset] = vector->buffer_sizes[last];
+        }
+    }
+}
+
+void string_vector_free(StringVector *vector)
+{
+    logger(INFO, debug, __func__, __LINE__, "Freeing StringVector: %p...", vector);
+
+    if (vector->journal != NULL) {
+        string_vector_close_journal(vector);
+    }
+
+    vector_untrack(vector);
+
+    /* Shared items are freed by the last vector holding them, this one just lets them go. */
+    if (!vector_release(vector->references)) {
+        vector->data = NULL;
+        vector->item_sizes = NULL;
+        vector->batches = NULL;
+        vector->batch_sizes = NULL;
+        vector->batch_items = NULL;
+        vector->batch_count = 0;
+        vector->hashes = NULL;
+        vector->hash_index = NULL;
+        vector->hash_counts = NULL;
+        vector->buffer_sizes = NULL;
+        vector->mapped = NULL;
+    }
+
+    vector->references = NULL;
+
+    if (vector->data != NULL) {
+        for (size_t i = 0; i < vector->capacity; ++i) {
+            if (vector->data[i] != NULL) {
+                logger(INFO, debug, __func__, __LINE__, "Freeing StringVector item #%li: %p...", i, vector->data[i]);
+                string_vector_free_item(vector, vector->data[i]);
+                logger(INFO, debug, __func__, __LINE__, "StringVector item #%li: %p freed.", i, vector->data[i]);
+                vector->data[i] = NULL;
+            }
+        }
+
+        logger(INFO, debug, __func__, __LINE__, "Freeing StringVector data pointer: %p...", vector->data);
+        free(vector->data);
+        logger(INFO, debug, __func__, __LINE__, "StringVector data: %p freed...", vector->data);
+        vector->data = NULL;
+    }
+
+    if (vector->item_sizes != NULL) {
+        free(vector->item_sizes);
+        vector->item_sizes = NULL;
+    }
+
+    free(vector->buffer_sizes);
+    vector->buffer_sizes = NULL;
+
+    for (size_t i = 0; i < vector->batch_count; ++i) {
+        logger(INFO, debug, __func__, __LINE__, "Freeing StringVector batch #%li: %p...", i, vector->batches[i]);
+        free(vector->batches[i]);
+    }
+
+    free(vector->batches);
+    free(vector->batch_sizes);
+    free(vector->batch_items);
+    vector->batches = NULL;
+    vector->batch_sizes = NULL;
+    vector->batch_items = NULL;
+    vector->batch_count = 0;
+
+    free(vector->hashes);
+    free(vector->hash_index);
+    free(vector->hash_counts);
+    vector->hashes = NULL;
+    vector->hash_index = NULL;
+    vector->hash_counts = NULL;
+    vector->hash_index_capacity = 0;
+
+    vector->capacity = 0;
+    vector->offset = 0;
+    vector->spares = 0;
+
+    if (vector->mapped != NULL) {
+        munmap(vector->mapped, vector->mapped_size);
+        vector->mapped = NULL;
+        vector->mapped_size = 0;
+    }
+
+    string_pool_release(vector->pool);
+    vector->pool = NULL;
+
+    logger(INFO, debug, __func__, __LINE__, "StringVector: %p freed.", vector);
+}
+
+/* libc's strlen() and memcpy() are vectorized for the running CPU, unlike a byte by byte loop. */
+static size_t string_vector_item_strlen(const char *item)
+{
+    return strlen(item);
+}
+
+/* Blindly trust on from having at least n items, and to having at least n + 1 bytes. */
+static void string_vector_copy_item(const char *from, char *to, size_t n)
+{
+    memcpy(to, from, n);
+    to[n] = '\0';
+}
+
+static uint64_t string_vector_hash(const char *item, size_t length)
+{
+    const uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+    uint64_t hash = length * multiplier;
+    uint64_t chunk;
+    size_t i = 0;
+
+    /* Eight bytes at a time, so long strings don't cost a multiplication per byte. */
+    for (; i + sizeof(chunk) <= length; i += sizeof(chunk)) {
+        memcpy(&chunk, item + i, sizeof(chunk));
+        hash = (hash ^ (chunk * multiplier)) * multiplier;
+        hash ^= hash >> 32;
+    }
+
+    chunk = 0;
+    memcpy(&chunk, item + i, length - i);
+    hash = (hash ^ (chunk * multiplier)) * multiplier;
+
+    /* MurmurHash3's finalizer, so every bit of hash depends on every input bit. */
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static bool string_vector_has_index(const StringVector *vector)
+{
+    return vector->hash_index != NULL;
+}
+
+/* Whether the items at positions a and b are the same, their hashes being checked first. */
+static bool string_vector_index_same(const StringVector *vector, size_t a, size_t b)
+{
+    return vector->hashes[a] == vector->hashes[b] && vector->item_sizes[a] == vector->item_sizes[b]
+        && memcmp(vector->data[a], vector->data[b], vector->item_sizes[a] - 1) == 0;
+}
+
+/* Index slots hold the first position + 1 of each distinct item, so 0 means the slot is empty, and
+ * duplicates only bump the slot's count instead of lengthening its probe sequence. Returns the slot
+ * of the item at position, or the empty one where it would go.
+ */
+static size_t string_vector_index_slot(const StringVector *vector, size_t position)
+{
+    size_t mask = vector->hash_index_capacity - 1;
+    size_t slot = vector->hashes[position] & mask;
+
+    while (vector->hash_index[slot] != 0 && vector->hash_index[slot] != position + 1
+           && !string_vector_index_same(vector, vector->hash_index[slot] - 1, position))
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+static void string_vector_index_put(StringVector *vector, size_t position)
+{
+    size_t slot = string_vector_index_slot(vector, position);
+
+    if (vector->hash_index[slot] == 0) {
+        vector->hash_index[slot] = position + 1;
+        vector->hash_counts[slot] = 1;
+        return;
+    }
+
+    if (position + 1 < vector->hash_index[slot]) {
+        vector->hash_index[slot] = position + 1;
+    }
+
+    ++vector->hash_counts[slot];
+}
+
+/* Empties slot, shifting back the entries after it so no tombstones are needed. */
+static void string_vector_index_clear_slot(StringVector *vector, size_t hole)
+{
+    size_t mask = vector->hash_index_capacity - 1;
+
+    for (size_t next = (hole + 1) & mask; vector->hash_index[next] != 0; next = (next + 1) & mask) {
+        size_t home = vector->hashes[vector->hash_index[next] - 1] & mask;
+
+        /* Entries whose home slot lies cyclically in (hole, next] must stay where they are. */
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            vector->hash_index[hole] = vector->hash_index[next];
+            vector->hash_counts[hole] = vector->hash_counts[next];
+            hole = next;
+        }
+    }
+
+    vector->hash_index[hole] = 0;
+}
+
+/* Removes position from the index. When it was the first of several identical items and rescan is
+ * set, the entry moves on to the next of them, looked for after position. Otherwise it's left
+ * pointing at position, and true is returned so the caller can settle it once it knows where to.
+ */
+static bool string_vector_index_remove(StringVector *vector, size_t position, bool rescan)
+{
+    size_t slot = string_vector_index_slot(vector, position);
+
+    if (--vector->hash_counts[slot] == 0) {
+        string_vector_index_clear_slot(vector, slot);
+        return false;
+    }
+
+    if (vector->hash_index[slot] != position + 1) {
+        return false;
+    } else if (!rescan) {
+        return true;
+    }
+
+    /* Cached hashes are compared first, so items of other values are skipped cheaply. */
+    for (size_t i = position + 1; i < vector->offset; ++i) {
+        if (string_vector_index_same(vector, i, position)) {
+            vector->hash_index[slot] = i + 1;
+            break;
+        }
+    }
+
+    return false;
+}
+
+/* Rebuilds the index of vector with room for index_capacity entries, reusing the cached hashes. */
+static bool string_vector_index_rebuild(StringVector *vector, size_t index_capacity)
+{
+    size_t *hash_index = (size_t *) calloc(index_capacity, sizeof(size_t));
+    size_t *hash_counts = (size_t *) malloc(index_capacity * sizeof(size_t));
+    if (hash_index == NULL || hash_counts == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate StringVector: %p's index. Error code: %i", vector, errno);
+        free(hash_index);
+        free(hash_counts);
+        return false;
+    }
+
+    free(vector->hash_index);
+    free(vector->hash_counts);
+    vector->hash_index = hash_index;
+    vector->hash_counts = hash_counts;
+    vector->hash_index_capacity = index_capacity;
+
+    for (size_t i = 0; i < vector->offset; ++i) {
+        string_vector_index_put(vector, i);
+    }
+
+    return true;
+}
+
+/* The index is just an accelerator: when it can't be kept up to date it's dropped, and lookups
+ * fall back to scanning the vector.
+ */
+static void string_vector_index_drop(StringVector *vector)
+{
+    logger(WARN, true, __func__, __LINE__, "Dropping StringVector: %p's index. Lookups will scan the vector.", vector);
+
+    free(vector->hashes);
+    free(vector->hash_index);
+    free(vector->hash_counts);
+    vector->hashes = NULL;
+    vector->hash_index = NULL;
+    vector->hash_counts = NULL;
+    vector->hash_index_capacity = 0;
+}
+
+/* Hashes and indexes the item already stored at position, which must be the last one. */
+static void string_vector_index_added(StringVector *vector, size_t position)
+{
+    if (!string_vector_has_index(vector)) {
+        return;
+    }
+
+    vector->hashes[position] = string_vector_hash(vector->data[position], vector->item_sizes[position] - 1);
+
+    /* Keep the load factor at or below 1/2. */
+    if ((position + 1) * 2 > vector->hash_index_capacity) {
+        if (!string_vector_index_rebuild(vector, vector->hash_index_capacity * 2)) {
+            string_vector_index_drop(vector);
+        }
+
+        return;
+    }
+
+    string_vector_index_put(vector, position);
+}
+
+/* Renumbers the entries of the items in [from, to), before they're moved by delta, which is 1 or
+ * "negative" through wrap-around. Only the first position of each item is indexed, so each one is
+ * looked up by its cached hash, and entries are visited in the direction the items move, so no two
+ * ever hold the same position.
+ */
+static void string_vector_index_shift(StringVector *vector, size_t from, size_t to, size_t delta)
+{
+    size_t mask = vector->hash_index_capacity - 1;
+
+    for (size_t k = 0; k < to - from; ++k) {
+        size_t position = delta == 1 ? to - 1 - k : from + k;
+
+        for (size_t slot = vector->hashes[position] & mask; vector->hash_index[slot] != 0; slot = (slot + 1) & mask) {
+            if (vector->hash_index[slot] == position + 1) {
+                vector->hash_index[slot] += delta;
+                break;
+            }
+        }
+    }
+}
+
+/* Takes the items in [start, end) out of the index, before they're erased and the ones after them
+ * moved back. Going backwards, an item still counted once its first position is gone only has
+ * copies after end, and a single pass over those settles all such entries at once.
+ */
+static void string_vector_index_erase(StringVector *vector, size_t start, size_t end)
+{
+    size_t unsettled = 0;
+
+    for (size_t i = end; i > start; --i) {
+        unsettled += string_vector_index_remove(vector, i - 1, false);
+    }
+
+    for (size_t i = end; i < vector->offset && unsettled > 0; ++i) {
+        size_t slot = string_vector_index_slot(vector, i);
+
+        if (vector->hash_index[slot] > start && vector->hash_index[slot] <= end) {
+            vector->hash_index[slot] = i + 1;
+            --unsettled;
+        }
+    }
+
+    string_vector_index_shift(vector, end, vector->offset, start - end);
+}
+
+/* Resizes the slot arrays of vector to hold new_capacity items. Items themselves aren't touched,
+ * so they keep their addresses. Slots beyond the current capacity are set to NULL.
+ */
+static bool string_vector_resize_slots(StringVector *vector, size_t new_capacity)
+{
+    /* realloc(ptr, 0) may free ptr, which would leave vector uninitialized. */
+    size_t slots = new_capacity > 0 ? new_capacity : 1;
+
+    char **data = (char **) realloc(vector->data, slots * sizeof(char *));
+    if (data == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to resize StringVector: %p's slots. Error code: %i", vector, errno);
+        return false;
+    }
+    vector->data = data;
+
+    size_t *item_sizes = (size_t *) realloc(vector->item_sizes, slots * sizeof(size_t));
+    if (item_sizes == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to resize StringVector: %p's slots. Error code: %i", vector, errno);
+        return false;
+    }
+    vector->item_sizes = item_sizes;
+
+    if (vector->buffer_sizes != NULL) {
+        size_t *buffer_sizes = (size_t *) realloc(vector->buffer_sizes, slots * sizeof(size_t));
+        if (buffer_sizes == NULL) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to resize StringVector: %p's slots. Error code: %i", vector, errno);
+            return false;
+        }
+        vector->buffer_sizes = buffer_sizes;
+    }
+
+    if (string_vector_has_index(vector)) {
+        uint64_t *hashes = (uint64_t *) realloc(vector->hashes, slots * sizeof(uint64_t));
+        if (hashes == NULL) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to resize StringVector: %p's slots. Error code: %i", vector, errno);
+            return false;
+        }
+        vector->hashes = hashes;
+    }
+
+    for (size_t i = vector->capacity; i < new_capacity; ++i) {
+        vector->data[i] = NULL;
+    }
+
+    vector->capacity = new_capacity;
+    return true;
+}
+
+/* Makes room for count more batches in vector. */
+static bool string_vector_grow_batches(StringVector *vector, size_t count)
+{
+    char **batches = (char **) realloc(vector->batches, (vector->batch_count + count) * sizeof(char *));
+    if (batches == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to register new batches for StringVector: %p. Error code: %i", vector, errno);
+        return false;
+    }
+    vector->batches = batches;
+
+    size_t *batch_sizes = (size_t *) realloc(vector->batch_sizes, (vector->batch_count + count) * sizeof(size_t));
+    if (batch_sizes == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to register new batches for StringVector: %p. Error code: %i", vector, errno);
+        return false;
+    }
+    vector->batch_sizes = batch_sizes;
+
+    size_t *batch_items = (size_t *) realloc(vector->batch_items, (vector->batch_count + count) * sizeof(size_t));
+    if (batch_items == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to register new batches for StringVector: %p. Error code: %i", vector, errno);
+        return false;
+    }
+    vector->batch_items = batch_items;
+
+    return true;
+}
+
+/* Registers batch, holding as many items as given, keeping batches sorted by address. Room must have
+ * been made with string_vector_grow_batches().
+ */
+static void string_vector_register_batch(StringVector *vector, char *batch, size_t size, size_t items)
+{
+    size_t i = vector->batch_count;
+
+    for (; i > 0 && (uintptr_t) vector->batches[i - 1] > (uintptr_t) batch; --i) {
+        vector->batches[i] = vector->batches[i - 1];
+        vector->batch_sizes[i] = vector->batch_sizes[i - 1];
+        vector->batch_items[i] = vector->batch_items[i - 1];
+    }
+
+    vector->batches[i] = batch;
+    vector->batch_sizes[i] = size;
+    vector->batch_items[i] = items;
+    ++vector->batch_count;
+}
+
+/* Same as numeric_vector_log(). Items are recorded as their sizes, \0 included, as uint32_t, then
+ * their characters.
+ */
+static void string_vector_log(StringVector *vector, uint32_t operation, size_t position, size_t count)
+{
+    size_t size = 0;
+
+    if (operation <= VECTOR_JOURNAL_REPLACE) {
+        for (size_t i = position; i < position + count; ++i) {
+            size += sizeof(uint32_t) + vector->item_sizes[i];
+        }
+    }
+
+    char *items = vector_journal_reserve(vector->journal, operation, position, count, size);
+
+    if (items == NULL) {
+        if (vector_journal_is_stale(vector->journal)) {
+            string_vector_compact_journal(vector);
+        }
+
+        return;
+    }
+
+    if (size > 0) {
+        uint32_t *sizes = (uint32_t *) items;
+        char *characters = items + count * sizeof(uint32_t);
+
+        for (size_t i = 0; i < count; ++i) {
+            sizes[i] = (uint32_t) vector->item_sizes[position + i];
+            memcpy(characters, vector->data[position + i], sizes[i]);
+            characters += sizes[i];
+        }
+    }
+
+    if (vector_journal_commit(vector->journal)) {
+        string_vector_sync_journal(vector);
+    }
+}
+
+/* Appends n items whose lengths (without the \0 character) are already stored in
+ * vector->item_sizes[vector->offset...]. All of them are copied into a single buffer,
+ * which is registered as a batch of vector.
+ */
+static bool string_vector_add_batch(StringVector *vector, const char *values[], size_t n, size_t total)
+{
+    string_vector_drop_spares(vector);
+
+    if (!string_vector_grow_batches(vector, 1)) {
+        return false;
+    }
+
+    char *batch = (char *) malloc(total * sizeof(char));
+    if (batch == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate %li bytes for %li StringVector items. Error code: %i", total, n, errno);
+        return false;
+    }
+
+    string_vector_register_batch(vector, batch, total, n);
+
+    for (size_t i = 0; i < n; ++i) {
+        size_t length = vector->item_sizes[vector->offset];
+
+        memcpy(batch, values[i], length);
+        batch[length] = '\0';
+        vector->data[vector->offset] = batch;
+        vector->item_sizes[vector->offset] = length + 1;
+        string_vector_fit_buffer(vector, vector->offset);
+        ++vector->offset;
+        batch += length + 1;
+        string_vector_index_added(vector, vector->offset - 1);
+    }
+
+    if (vector->journal != NULL) {
+        string_vector_log(vector, VECTOR_JOURNAL_APPEND, vector->offset - n, n);
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "%li new values added to vector: %p using %li bytes.", n, vector, total);
+    return true;
+}
+
+/* Gives vector private copies of its items if they're shared with other vectors. Every function
+ * modifying vector calls it first. Items are copied into a single batch.
+ */
+static bool string_vector_unshare(StringVector *vector)
+{
+    if (!vector_is_shared(vector->references)) {
+        return true;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "StringVector: %p is about to be modified. Making a copy of its shared items...", vector);
+
+    StringVector shared = *vector;
+    StringVector copy;
+
+    if (!string_vector_init(&copy, shared.capacity)) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to copy StringVector: %p's shared items.", vector);
+        return false;
+    }
+
+    size_t total = 0;
+    for (size_t i = 0; i < shared.offset; ++i) {
+        copy.item_sizes[i] = shared.item_sizes[i] - 1;
+        total += shared.item_sizes[i];
+    }
+
+    if ((shared.offset > 0 && !string_vector_add_batch(&copy, (const char **) shared.data, shared.offset, total))
+        || (string_vector_has_index(&shared) && !string_vector_enable_index(&copy)))
+    {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to copy StringVector: %p's shared items.", vector);
+        string_vector_free(&copy);
+        return false;
+    }
+
+    /* Only vectors using shared pools, or none, share their items, so the pool goes on with the copy. */
+    if (shared.pool != NULL) {
+        string_pool_retain(shared.pool);
+        copy.pool = shared.pool;
+    }
+
+    /* The journal goes on logging vector's modifications. */
+    copy.journal = shared.journal;
+    shared.journal = NULL;
+
+    *vector = copy;
+    vector_retrack(&copy, vector, true);
+    string_vector_free(&shared);
+    atomic_fetch_add_explicit(&materialized_copies, 1, memory_order_relaxed);
+    return true;
+}
+
+/* Makes room for one more item at the end of vector, initializing it if needed. */
+static bool string_vector_make_room(StringVector *vector, const char *func, int line)
+{
+    if (!string_vector_is_valid(vector, func, line, false)) {
+        logger(WARN, debug, __func__, __LINE__, "Initializing it with the default size value: %i.",
+                DEFAULT_RESIZE_VALUE);
+
+        if (!string_vector_init(vector, DEFAULT_RESIZE_VALUE)) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to initialize StringVector. Not continuing.");
+            return false;
+        }
+    }
+
+    if (!string_vector_unshare(vector)) {
+        return false;
+    }
+
+    if (vector->offset + 1 > vector->capacity) {
+        logger(
+                INFO, debug, __func__, __LINE__,
+                "Adding new value causes vector to be resized. Resizing with the default size value: %i",
+                DEFAULT_RESIZE_VALUE
+        );
+
+        if (!string_vector_reserve(vector, DEFAULT_RESIZE_VALUE)) {
+            logger(ERROR, true, __func__, __LINE__, "StringVector couldn't be resized. Not continuing.");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool string_vector_add(StringVector *vector, const char *value)
+{
+    logger(INFO, debug, __func__, __LINE__, "Adding value: %s to vector: %p...", value, vector);
+
+    if (!string_vector_make_room(vector, __func__, __LINE__)) {
+        return false;
+    }
+
+    size_t size = string_vector_item_strlen(value);
+
+    /* A spare buffer is reused if the value fits in it. */
+    if (vector->spares > 0) {
+        --vector->spares;
+
+        if (string_vector_buffer_size(vector, vector->offset) < size + 1) {
+            string_vector_free_item(vector, vector->data[vector->offset]);
+            vector->data[vector->offset] = NULL;
+        }
+    }
+
+    bool reused = vector->data[vector->offset] != NULL;
+
+    if (!reused) {
+        vector->data[vector->offset] = string_vector_alloc_item(vector, size + 1);
+    }
+
+    if (vector->data[vector->offset] == NULL) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "Impossible to allocate memory for string value: %s. Error code: %i",
+                value, errno
+        );
+
+        string_vector_fill_spare_gap(vector);
+        return false;
+    }
+
+    string_vector_copy_item(value, vector->data[vector->offset], size);
+    vector->item_sizes[vector->offset] = size + 1;
+
+    if (!reused) {
+        string_vector_fit_buffer(vector, vector->offset);
+    }
+
+    ++vector->offset;
+    string_vector_index_added(vector, vector->offset - 1);
+
+    if (vector->journal != NULL) {
+        string_vector_log(vector, VECTOR_JOURNAL_APPEND, vector->offset - 1, 1);
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Value: %s added to vector: %p.", vector->data[vector->offset - 1], vector);
+
+    return true;
+}
+
+/* Adds value without copying it. value must have been allocated with malloc(), and hold length
+ * characters plus the \0 one. It belongs to vector from now on, unless adding it fails.
+ */
+bool string_vector_add_owned(StringVector *vector, char *value, size_t length)
+{
+    logger(INFO, debug, __func__, __LINE__, "Adopting value: %s into vector: %p...", value, vector);
+
+    if (!string_vector_make_room(vector, __func__, __LINE__)) {
+        return false;
+    }
+
+    if (vector->spares > 0) {
+        string_vector_free_item(vector, vector->data[vector->offset]);
+        --vector->spares;
+    }
+
+    vector->data[vector->offset] = value;
+    vector->item_sizes[vector->offset] = length + 1;
+    string_vector_fit_buffer(vector, vector->offset);
+    ++vector->offset;
+    string_vector_index_added(vector, vector->offset - 1);
+
+    if (vector->journal != NULL) {
+        string_vector_log(vector, VECTOR_JOURNAL_APPEND, vector->offset - 1, 1);
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Value: %s adopted by vector: %p.", value, vector);
+    return true;
+}
+
+bool string_vector_add_array(StringVector *vector, const char *values[], size_t n)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (!string_vector_unshare(vector)) {
+        return false;
+    }
+
+    if (vector->offset + n > vector->capacity) {
+        logger(INFO, debug, __func__, __LINE__, "Adding array causes vector to be resized. Resizing with %li more spaces...", n);
+
+        if (!string_vector_reserve(vector, n)) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to resize vector. Not continuing.");
+            return false;
+        }
+    }
+
+    if (n == 0) {
+        return true;
+    }
+
+    /* Measure everything first, so only one buffer has to be allocated. */
+    size_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        size_t length = strlen(values[i]);
+        vector->item_sizes[vector->offset + i] = length;
+        total += length + 1;
+    }
+
+    return string_vector_add_batch(vector, values, n, total);
+}
+
+/* Same as string_vector_add_array(), but lengths[i] tells how many bytes of array[i] are copied.
+ * array[i] doesn't need to be \0-terminated.
+ */
+bool string_vector_add_sized_array(StringVector *vector, const char *values[], const size_t lengths[], size_t n)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (!string_vector_unshare(vector)) {
+        return false;
+    }
+
+    if (vector->offset + n > vector->capacity) {
+        logger(INFO, debug, __func__, __LINE__, "Adding array causes vector to be resized. Resizing with %li more spaces...", n);
+
+        if (!string_vector_reserve(vector, n)) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to resize vector. Not continuing.");
+            return false;
+        }
+    }
+
+    if (n == 0) {
+        return true;
+    }
+
+    size_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        vector->item_sizes[vector->offset + i] = lengths[i];
+        total += lengths[i] + 1;
+    }
+
+    return string_vector_add_batch(vector, values, n, total);
+}
+
+bool string_vector_reserve(StringVector *vector, size_t spaces)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (!string_vector_unshare(vector)) {
+        return false;
+    }
+
+    size_t old_capacity = vector->capacity;
+    size_t new_capacity = old_capacity + spaces;
+
+    logger(
+            INFO, debug, __func__, __LINE__,
+            "Reserving %li more spaces for vector: %p... Old capacity: %li, new capacity: %li",
+            spaces, vector, old_capacity, new_capacity
+    );
+
+    if (!string_vector_resize_slots(vector, new_capacity)) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to reserve %li more spaces for vector: %p.", spaces, vector);
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "%li more spaces reserved to StringVector: %p.", spaces, vector);
+    return true;
+}
+
+bool string_vector_shrink_to_fit(StringVector *vector)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (vector->capacity == vector->offset) {
+        logger(WARN, debug, __func__, __LINE__, "No need to shrink vector: %p.", vector);
+        return true;
+    }
+
+    if (!string_vector_unshare(vector)) {
+        return false;
+    }
+
+    string_vector_drop_spares(vector);
+
+    logger(
+            INFO, debug, __func__, __LINE__,
+            "Shrinking StringVector: %p... Current capacity: %li, New capacity: %li",
+            vector, vector->capacity, vector->offset
+    );
+
+    /* Slots after offset are always NULL, so there's nothing to free. */
+    if (!string_vector_resize_slots(vector, vector->offset)) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "Impossible to shrink vector: %p. Leaving original vector as it was received.",
+                vector
+        );
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "StringVector: %p shrinked. New capacity is: %li.", vector, vector->capacity);
+    return true;
+}
+
+bool string_vector_clear(StringVector *vector)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    size_t capacity = vector->capacity;
+    bool indexed = string_vector_has_index(vector);
+    StringPool *pool = vector->pool;
+    VectorJournal *journal = vector->journal;
+
+    if (pool != NULL) {
+        string_pool_retain(pool);
+    }
+
+    vector->journal = NULL;
+    string_vector_free(vector);
+
+    if (!string_vector_init(vector, capacity)) {
+        logger(
+                WARN, true, __func__, __LINE__,
+                "StringVector: %p was cleared, but it wasn't possible to re-initialize. It shouldn't be used until properly initialized.",
+                vector
+        );
+
+        string_pool_release(pool);
+    } else {
+        vector->pool = pool;
+
+        if (indexed) {
+            string_vector_enable_index(vector);
+        }
+    }
+
+    vector->journal = journal;
+    if (vector->journal != NULL) {
+        string_vector_log(vector, VECTOR_JOURNAL_CLEAR, 0, 0);
+    }
+
+    return true;
+}
+
+/* Same as string_vector_clear(), but items' buffers are kept, up to max_bytes of them, and reused by
+ * string_vector_add() and string_vector_replace() when new values fit in them. Buffers living in a
+ * batch are only freed along with it, so they're always kept. Buffers are counted by their whole
+ * size, as the values reusing them may be shorter.
+ */
+bool string_vector_clear_retaining(StringVector *vector, size_t max_bytes)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    /* Shared items belong to other vectors too. */
+    if (vector_is_shared(vector->references)) {
+        return string_vector_clear(vector);
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Clearing StringVector: %p, keeping up to %li bytes...", vector, max_bytes);
+
+    size_t items = vector->offset + vector->spares;
+    size_t retained = 0;
+    size_t kept = 0;
+
+    /* Sizes of buffers are kept apart from their items' from now on. */
+    if (vector->buffer_sizes == NULL) {
+        vector->buffer_sizes = (size_t *) malloc((vector->capacity > 0 ? vector->capacity : 1) * sizeof(size_t));
+
+        if (vector->buffer_sizes == NULL) {
+            logger(WARN, true, __func__, __LINE__, "Impossible to allocate StringVector: %p's buffer sizes. Clearing it instead.", vector);
+            return string_vector_clear(vector);
+        }
+
+        memcpy(vector->buffer_sizes, vector->item_sizes, items * sizeof(size_t));
+    }
+
+    for (size_t i = 0; i < items; ++i) {
+        char *item = vector->data[i];
+        size_t buffer_size = vector->buffer_sizes[i];
+        vector->data[i] = NULL;
+
+        if (string_vector_item_in_batch(vector, item) || retained + buffer_size <= max_bytes) {
+            retained += buffer_size;
+            vector->item_sizes[kept] = buffer_size;
+            vector->buffer_sizes[kept] = buffer_size;
+            vector->data[kept++] = item;
+        } else {
+            string_vector_free_item(vector, item);
+        }
+    }
+
+    vector->offset = 0;
+    vector->spares = kept;
+
+    if (string_vector_has_index(vector) && !string_vector_index_rebuild(vector, vector->hash_index_capacity)) {
+        string_vector_index_drop(vector);
+    }
+
+    if (vector->journal != NULL) {
+        string_vector_log(vector, VECTOR_JOURNAL_CLEAR, 0, 0);
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "StringVector: %p cleared. %li buffers, %li bytes kept.", vector, kept, retained);
+    return true;
+}
+
+bool string_vector_copy(const StringVector *source, StringVector *destination, bool initialize)
+{
+    if (!string_vector_is_valid(source, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    /* Pools which aren't shared may only be used by a single thread, so items allocated from one aren't
+     * shared, but copied, the copy allocating them with malloc().
+     */
+    if (initialize && source->pool != NULL && !string_pool_is_shared(source->pool)) {
+        return string_vector_init(destination, source->capacity) && string_vector_copy(source, destination, false);
+    }
+
+    /* A new vector just shares source's items, until one of them is modified. */
+    if (initialize) {
+        size_t *references = vector_share(&((StringVector *) source)->references);
+
+        if (references == NULL) {
+            logger(
+                    ERROR, true, __func__, __LINE__,
+                    "Impossible to initialize StringVector: %p. Not continuing.",
+                    destination
+            );
+
+            return false;
+        }
+
+        destination->data = source->data;
+        destination->capacity = source->capacity;
+        destination->offset = source->offset;
+        destination->item_sizes = source->item_sizes;
+        destination->batches = source->batches;
+        destination->batch_sizes = source->batch_sizes;
+        destination->batch_items = source->batch_items;
+        destination->batch_count = source->batch_count;
+        destination->hashes = source->hashes;
+        destination->hash_index = source->hash_index;
+        destination->hash_counts = source->hash_counts;
+        destination->hash_index_capacity = source->hash_index_capacity;
+        destination->spares = source->spares;
+        destination->buffer_sizes = source->buffer_sizes;
+        destination->pool = source->pool;
+        destination->mapped = source->mapped;
+        destination->mapped_size = source->mapped_size;
+        destination->references = references;
+        destination->journal = NULL;
+
+        if (destination->pool != NULL) {
+            string_pool_retain(destination->pool);
+        }
+
+        vector_track(destination, true);
+        logger(INFO, debug, __func__, __LINE__, "StringVector: %p shares StringVector: %p's items.", destination, source);
+        return true;
+    } else if (!string_vector_is_valid(destination, __func__, __LINE__, false)) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "You told me not to initialize it. Not continuing."
+        );
+
+        return false;
+    }
+
+    if (!string_vector_unshare(destination)) {
+        return false;
+    }
+
+    if (source->offset + destination->offset > destination->capacity) {
+        logger(
+                INFO, debug, __func__, __LINE__,
+                "Copying StringVector: %p values into initialized StringVector: %p makes this last one to be resized.",
+                source, destination
+        );
+
+        if (!string_vector_reserve(destination, source->offset)) {
+            logger(
+                    ERROR, true, __func__, __LINE__,
+                    "Impossible to reserve memory to make copy of StringVector: %p into StringVector: %p.",
+                    source, destination
+            );
+
+            return false;
+        }
+    }
+
+    logger(
+            INFO, debug, __func__, __LINE__,
+            "Copying StringVector: %p's values into StringVector: %p...",
+            source, destination
+    );
+
+    if (source->offset == 0) {
+        return true;
+    }
+
+    /* Source's lengths are already known, so all of its items are copied into a single batch. */
+    size_t total = 0;
+    for (size_t i = 0; i < source->offset; ++i) {
+        destination->item_sizes[destination->offset + i] = source->item_sizes[i] - 1;
+        total += source->item_sizes[i];
+    }
+
+    if (!string_vector_add_batch(destination, (const char **) source->data, source->offset, total)) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "Impossible to copy StringVector: %p into StringVector: %p.",
+                source, destination
+        );
+
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "StringVector: %p's values copied into StringVector: %p.", source, destination);
+    return true;
+}
+
+bool string_vector_insert(StringVector *vector, const char *value, size_t position)
+{
+    logger(
+            INFO, debug, __func__, __LINE__,
+            "Inserting new value: %s into StringVector: %p at position: %li...",
+            value, vector, position
+    );
+
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (!string_vector_unshare(vector)) {
+        return false;
+    }
+
+    if (position >= vector->offset) {
+        logger(
+                WARN, debug, __func__, __LINE__,
+                "StringVector: %p doesn't have at least %li elements. Just adding at position: %li...",
+                vector, position, vector->offset
+        );
+
+        return string_vector_add(vector, value);
+    }
+
+    string_vector_drop_spares(vector);
+
+    size_t length = string_vector_item_strlen(value) + 1;
+    char *item = string_vector_alloc_item(vector, length);
+
+    if (item == NULL) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "Couldn't reserve memory for StringVector item: %s. Leaving original StringVector as it was received. Error code: %i",
+                value, errno
+        );
+
+        return false;
+    }
+
+    string_vector_copy_item(value, item, length - 1);
+
+    if (vector->offset + 1 > vector->capacity) {
+        logger(
+                INFO, debug, __func__, __LINE__,
+                "Inserting new value makes StringVector to be resized. Reserving %i more spaces...",
+                DEFAULT_RESIZE_VALUE
+        );
+
+        if (!string_vector_reserve(vector, DEFAULT_RESIZE_VALUE)) {
+            logger(
+                    ERROR, true, __func__, __LINE__,
+                    "Impossible to reserve %i more spaces. Leaving original StringVector as it was received.",
+                    DEFAULT_RESIZE_VALUE
+            );
+
+            string_vector_free_item(vector, item);
+            return false;
+        }
+    }
+
+    /* Only the pointers after position are shifted, the strings stay where they are. */
+    size_t to_move = vector->offset - position;
+
+    if (string_vector_has_index(vector)) {
+        string_vector_index_shift(vector, position, vector->offset, 1);
+    }
+
+    memmove(&vector->data[position + 1], &vector->data[position], to_move * sizeof(char *));
+    memmove(&vector->item_sizes[position + 1], &vector->item_sizes[position], to_move * sizeof(size_t));
+
+    if (vector->buffer_sizes != NULL) {
+        memmove(&vector->buffer_sizes[position + 1], &vector->buffer_sizes[position], to_move * sizeof(size_t));
+    }
+
+    vector->data[position] = item;
+    vector->item_sizes[position] = length;
+    string_vector_fit_buffer(vector, position);
+    ++vector->offset;
+
+    if (string_vector_has_index(vector)) {
+        memmove(&vector->hashes[position + 1], &vector->hashes[position], to_move * sizeof(uint64_t));
+        vector->hashes[position] = string_vector_hash(item, length - 1);
+
+        if (vector->offset * 2 > vector->hash_index_capacity) {
+            if (!string_vector_index_rebuild(vector, vector->hash_index_capacity * 2)) {
+                string_vector_index_drop(vector);
+            }
+        } else {
+            string_vector_index_put(vector, position);
+        }
+    }
+
+    if (vector->journal != NULL) {
+        string_vector_log(vector, VECTOR_JOURNAL_INSERT, position, 1);
+    }
+
+    logger(
+            INFO, debug, __func__, __LINE__,
+            "Value: %s inserted into StringVector: %p at position: %li.",
+            value, vector, position
+    );
+
+    return true;
+}
+
+/* Takes the item at position out of the index, if any, before it's replaced. It must still hold
+ * its old value, which is how its index entry is found.
+ */
+static void string_vector_unindex_item(StringVector *vector, size_t position)
+{
+    if (string_vector_has_index(vector)) {
+        string_vector_index_remove(vector, position, true);
+    }
+}
+
+/* Puts value, size bytes long counting the \0 character, at position, freeing the item there,
+ * which string_vector_unindex_item() must have been called on.
+ */
+static void string_vector_set_item(StringVector *vector, size_t position, char *value, size_t size)
+{
+    char *old_value = vector->data[position];
+
+    vector->data[position] = value; /* Just make that pointer point to the new memory address. */
+    vector->item_sizes[position] = size;
+
+    /* A buffer reused in place keeps its size. */
+    if (value != old_value) {
+        string_vector_fit_buffer(vector, position);
+    }
+
+    if (string_vector_has_index(vector)) {
+        vector->hashes[position] = string_vector_hash(value, size - 1);
+        string_vector_index_put(vector, position);
+    }
+
+    if (vector->journal != NULL) {
+        string_vector_log(vector, VECTOR_JOURNAL_REPLACE, position, 1);
+    }
+
+    logger(
+            INFO, debug, __func__, __LINE__,
+            "StringVector item: %s replaced by %s. Freeing replaced StringVector item allocated memory...",
+            old_value, value
+    );
+
+    if (old_value != value) {
+        string_vector_free_item(vector, old_value);
+    }
+}
+
+bool string_vector_replace(StringVector *vector, size_t position, const char *new_value)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (!string_vector_unshare(vector)) {
+        return false;
+    }
+
+    if (position >= vector->offset) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "There's no such StringVector item at position: %li.",
+                position
+        );
+
+        return false;
+    }
+
+    size_t size = string_vector_item_strlen(new_value) + 1;
+
+    /* The current buffer is reused if new_value fits in it. new_value may live inside it, hence memmove(). */
+    if (size <= string_vector_buffer_size(vector, position)) {
+        string_vector_unindex_item(vector, position);
+        memmove(vector->data[position], new_value, size - 1);
+        vector->data[position][size - 1] = '\0';
+        string_vector_set_item(vector, position, vector->data[position], size);
+        return true;
+    }
+
+    logger(
+            INFO, debug, __func__, __LINE__,
+            "Reserving %li bytes of memory to copy: %s into StringVector position: %li, replacing: %s.",
+            size, new_value, position, vector->data[position]
+    );
+
+    char *value = string_vector_alloc_item(vector, size);
+
+    if (value == NULL) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "Couldn't reserve memory to hold new StringVector item: %s. Can't continue.",
+                new_value
+        );
+
+        return false;
+    }
+
+    string_vector_copy_item(new_value, value, size - 1);
+    string_vector_unindex_item(vector, position);
+    string_vector_set_item(vector, position, value, size);
+    return true;
+}
+
+/* Same as string_vector_replace(), but new_value is adopted like string_vector_add_owned() does. */
+bool string_vector_replace_owned(StringVector *vector, size_t position, char *new_value, size_t length)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (!string_vector_unshare(vector)) {
+        return false;
+    }
+
+    if (position >= vector->offset) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "There's no such StringVector item at position: %li.",
+                position
+        );
+
+        return false;
+    }
+
+    string_vector_unindex_item(vector, position);
+    string_vector_set_item(vector, position, new_value, length + 1);
+    return true;
+}
+
+/* Erase StringVector's items from start to length or vector's last item.
+ * Reducing StringVector's capacity by the amount of erased items.
+ */
+bool string_vector_erase(StringVector *vector, size_t start, size_t length)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (!string_vector_unshare(vector)) {
+        return false;
+    }
+
+    if (start >= vector->offset) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "StringVector: %p doesn't have %li items. There's nothing to erase.",
+                vector, start
+        );
+
+        return false;
+    }
+
+    if (length >= vector->offset) {
+        length = 1;
+    }
+
+    const char *item_text = length == 1 ? "item" : "items";
+
+    logger(
+            INFO, debug, __func__, __LINE__,
+            "Erasing %li StringVector %s, starting from %li...",
+            length, item_text, start
+    );
+
+    string_vector_drop_spares(vector);
+
+    size_t end = start + length > vector->offset ? vector->offset : start + length;
+    size_t old_offset = vector->offset;
+
+    /* Only the items up to the last one are erased. */
+    length = end - start;
+
+    if (string_vector_has_index(vector)) {
+        string_vector_index_erase(vector, start, end);
+        memmove(&vector->hashes[start], &vector->hashes[end], (old_offset - end) * sizeof(uint64_t));
+    }
+
+    for (size_t i = start; i < end; ++i) {
+        string_vector_free_item(vector, vector->data[i]);
+    }
+
+    /* Just shift the pointers of the items that won't be erased. */
+    memmove(&vector->data[start], &vector->data[end], (old_offset - end) * sizeof(char *));
+    memmove(&vector->item_sizes[start], &vector->item_sizes[end], (old_offset - end) * sizeof(size_t));
+
+    if (vector->buffer_sizes != NULL) {
+        memmove(&vector->buffer_sizes[start], &vector->buffer_sizes[end], (old_offset - end) * sizeof(size_t));
+    }
+
+    vector->offset -= length;
+
+    for (size_t i = vector->offset; i < old_offset; ++i) {
+        vector->data[i] = NULL;
+    }
+
+    if (vector->journal != NULL) {
+        string_vector_log(vector, VECTOR_JOURNAL_ERASE, start, end - start);
+    }
+
+    /* Spares were dropped, so slots go down by as many items as were erased, leaving the same room
+     * after offset as before.
+     */
+    if (!string_vector_resize_slots(vector, vector->offset + vector->spares + (vector->capacity - old_offset))) {
+        logger(
+                WARN, true, __func__, __LINE__,
+                "Items were erased, but StringVector: %p's capacity couldn't be reduced.",
+                vector
+        );
+    }
+
+    logger(
+            INFO, debug, __func__, __LINE__,
+            "%li %s %s erased from StringVector: %p.",
+            length, item_text, (length == 1 ? "was" : "were"), vector
+    );
+
+    return true;
+}
+
+bool string_vector_swap(StringVector *one, StringVector *another)
+{
+    if (!string_vector_is_valid(one, __func__, __LINE__, true)
+        || !string_vector_is_valid(another, __func__, __LINE__, true))
+    {
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Swapping StringVectors: %p and %p...", one, another);
+
+    StringVector tmp = {0};
+    tmp.data = one->data;
+    tmp.capacity = one->capacity;
+    tmp.item_sizes = one->item_sizes;
+    tmp.offset = one->offset;
+    tmp.batches = one->batches;
+    tmp.batch_sizes = one->batch_sizes;
+    tmp.batch_items = one->batch_items;
+    tmp.batch_count = one->batch_count;
+    tmp.hashes = one->hashes;
+    tmp.hash_index = one->hash_index;
+    tmp.hash_counts = one->hash_counts;
+    tmp.hash_index_capacity = one->hash_index_capacity;
+    tmp.references = one->references;
+    tmp.spares = one->spares;
+    tmp.buffer_sizes = one->buffer_sizes;
+    tmp.pool = one->pool;
+    tmp.mapped = one->mapped;
+    tmp.mapped_size = one->mapped_size;
+    tmp.journal = one->journal;
+
+    one->data = another->data;
+    one->capacity = another->capacity;
+    one->item_sizes = another->item_sizes;
+    one->offset = another->offset;
+    one->batches = another->batches;
+    one->batch_sizes = another->batch_sizes;
+    one->batch_items = another->batch_items;
+    one->batch_count = another->batch_count;
+    one->hashes = another->hashes;
+    one->hash_index = another->hash_index;
+    one->hash_counts = another->hash_counts;
+    one->hash_index_capacity = another->hash_index_capacity;
+    one->references = another->references;
+    one->spares = another->spares;
+    one->buffer_sizes = another->buffer_sizes;
+    one->pool = another->pool;
+    one->mapped = another->mapped;
+    one->mapped_size = another->mapped_size;
+    one->journal = another->journal;
+
+    another->data = tmp.data;
+    another->capacity = tmp.capacity;
+    another->item_sizes = tmp.item_sizes;
+    another->offset = tmp.offset;
+    another->batches = tmp.batches;
+    another->batch_sizes = tmp.batch_sizes;
+    another->batch_items = tmp.batch_items;
+    another->batch_count = tmp.batch_count;
+    another->hashes = tmp.hashes;
+    another->hash_index = tmp.hash_index;
+    another->hash_counts = tmp.hash_counts;
+    another->hash_index_capacity = tmp.hash_index_capacity;
+    another->references = tmp.references;
+    another->spares = tmp.spares;
+    another->buffer_sizes = tmp.buffer_sizes;
+    another->pool = tmp.pool;
+    another->mapped = tmp.mapped;
+    another->mapped_size = tmp.mapped_size;
+    another->journal = tmp.journal;
+
+    logger(
+            INFO, debug, __func__, __LINE__,
+            "StringVectors: %p and %p were swapped.",
+            one, another
+    );
+
+    logger(
+            INFO, debug, __func__, __LINE__,
+            "StringVector: %p old capacity: %li, new capacity: %li, \
+StringVector: %p old capacity: %li, new capacity: %li.",
+            one, another->capacity, one->capacity,
+            another, one->capacity, another->capacity
+    );
+
+    return true;
+}
+
+/* Same as numeric_vector_move(). */
+bool string_vector_move(StringVector *source, StringVector *destination)
+{
+    if (!string_vector_is_valid(source, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Moving StringVector: %p's items into StringVector: %p...", source, destination);
+
+    StringVector empty = {0};
+    *destination = *source;
+    *source = empty;
+    vector_retrack(source, destination, true);
+    return true;
+}
+
+/* Detaches vector's array of items, which holds capacity pointers, size of them being items. Every
+ * item is an allocation of its own, so the caller must free() them and the array. vector is left
+ * uninitialized. Returns NULL on failure.
+ */
+char **string_vector_release(StringVector *vector, size_t *size)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true) || !string_vector_unshare(vector)) {
+        return NULL;
+    }
+
+    if (vector->journal != NULL) {
+        string_vector_close_journal(vector);
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Releasing StringVector: %p's items...", vector);
+    string_vector_drop_spares(vector);
+
+    /* Batches can't be freed item by item, nor pooled items with free(), so they're copied out.
+     * vector stays valid if this fails halfway, as copies are freed on their own.
+     */
+    for (size_t i = 0; i < vector->offset; ++i) {
+        if (string_vector_item_in_batch(vector, vector->data[i]) || string_vector_item_in_pool(vector, vector->data[i])) {
+            char *item = (char *) malloc(vector->item_sizes[i]);
+
+            if (item == NULL) {
+                logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for item #%li. Error code: %i", i, errno);
+                return NULL;
+            }
+
+            memcpy(item, vector->data[i], vector->item_sizes[i]);
+            string_vector_free_item(vector, vector->data[i]);
+            vector->data[i] = item;
+        }
+    }
+
+    for (size_t i = 0; i < vector->batch_count; ++i) {
+        free(vector->batches[i]);
+    }
+
+    vector_release(vector->references);
+    vector_untrack(vector);
+    string_pool_release(vector->pool);
+    free(vector->batches);
+
+    if (vector->mapped != NULL) {
+        munmap(vector->mapped, vector->mapped_size);
+    }
+    free(vector->batch_sizes);
+    free(vector->batch_items);
+    free(vector->item_sizes);
+    free(vector->buffer_sizes);
+    free(vector->hashes);
+    free(vector->hash_index);
+    free(vector->hash_counts);
+
+    char **data = vector->data;
+    StringVector empty = {0};
+
+    *size = vector->offset;
+    *vector = empty;
+    return data;
+}
+
+/* Same as numeric_vector_memory_usage(). Items in batches or a mapped file are payload, the bytes
+ * these keep for items no longer held, or line ends, are slack. StringPool buffers count their size
+ * class, not the pool's slabs.
+ */
+bool string_vector_memory_usage(const StringVector *vector, VectorMemoryUsage *usage)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    VectorMemoryUsage empty = {0};
+    *usage = empty;
+
+    size_t batched = vector->mapped_size;
+    for (size_t i = 0; i < vector->batch_count; ++i) {
+        batched += vector->batch_sizes[i];
+        usage->overhead += vector_allocation_overhead(vector->batches[i], vector->batch_sizes[i]);
+    }
+
+    for (size_t i = 0; i < vector->offset + vector->spares; ++i) {
+        const char *item = vector->data[i];
+        size_t buffer_size = string_vector_buffer_size(vector, i);
+
+        /* What a reused buffer has beyond its item is slack too. */
+        if (i < vector->offset) {
+            usage->payload += vector->item_sizes[i];
+            usage->slack += buffer_size - vector->item_sizes[i];
+        } else {
+            usage->slack += buffer_size;
+        }
+
+        if (string_vector_item_in_batch(vector, item)) {
+            batched -= buffer_size;
+        } else if (string_vector_item_in_pool(vector, item)) {
+            usage->overhead += string_pool_buffer_size(item) - buffer_size;
+        } else {
+            usage->overhead += vector_allocation_overhead(item, buffer_size);
+        }
+    }
+
+    usage->slots = vector->offset * sizeof(char *);
+    usage->slack += (vector->capacity - vector->offset) * sizeof(char *) + batched;
+    usage->metadata = vector->capacity * sizeof(size_t) + vector->batch_count * (sizeof(char *) + 2 * sizeof(size_t));
+    usage->overhead += vector_allocation_overhead(vector->data, vector->capacity * sizeof(char *))
+            + vector_allocation_overhead(vector->item_sizes, vector->capacity * sizeof(size_t))
+            + vector_allocation_overhead(vector->batches, vector->batch_count * sizeof(char *))
+            + vector_allocation_overhead(vector->batch_sizes, vector->batch_count * sizeof(size_t))
+            + vector_allocation_overhead(vector->batch_items, vector->batch_count * sizeof(size_t));
+
+    if (vector->buffer_sizes != NULL) {
+        usage->metadata += vector->capacity * sizeof(size_t);
+        usage->overhead += vector_allocation_overhead(vector->buffer_sizes, vector->capacity * sizeof(size_t));
+    }
+
+    if (string_vector_has_index(vector)) {
+        usage->metadata += vector->capacity * sizeof(uint64_t) + vector->hash_index_capacity * 2 * sizeof(size_t);
+        usage->overhead += vector_allocation_overhead(vector->hashes, vector->capacity * sizeof(uint64_t))
+                + vector_allocation_overhead(vector->hash_index, vector->hash_index_capacity * sizeof(size_t))
+                + vector_allocation_overhead(vector->hash_counts, vector->hash_index_capacity * sizeof(size_t));
+    }
+
+    if (vector->references != NULL) {
+        usage->metadata += sizeof(size_t);
+        usage->overhead += vector_allocation_overhead((const void *) vector->references, sizeof(size_t));
+    }
+
+    usage->total = usage->payload + usage->slots + usage->metadata + usage->slack + usage->overhead;
+    return true;
+}
+
+static int vector_tracked_compare(const void *a, const void *b)
+{
+    /* data is the first member of both vector types. */
+    uintptr_t one = (uintptr_t) *(void *const *) ((const TrackedVector *) a)->vector;
+    uintptr_t another = (uintptr_t) *(void *const *) ((const TrackedVector *) b)->vector;
+
+    return (one > another) - (one < another);
+}
+
+/* Adds up the memory of every vector tracked since libvector_track_memory(true), counting data
+ * shared by copies once. vectors, if not NULL, gets how many were added up. Tracked vectors must
+ * not be modified meanwhile.
+ */
+bool libvector_get_memory_usage(VectorMemoryUsage *usage, size_t *vectors)
+{
+    VectorMemoryUsage empty = {0};
+    *usage = empty;
+
+    pthread_mutex_lock(&tracked_mutex);
+
+    size_t count = atomic_load(&tracked_count);
+    TrackedVector *sorted = (TrackedVector *) malloc((count > 0 ? count : 1) * sizeof(TrackedVector));
+
+    if (sorted == NULL) {
+        pthread_mutex_unlock(&tracked_mutex);
+        logger(ERROR, true, __func__, __LINE__, "Impossible to add up the memory of %li vectors. Error code: %i", count, errno);
+        return false;
+    }
+
+    for (size_t i = 0, j = 0; i < tracked_capacity; ++i) {
+        if (tracked[i].vector != NULL) {
+            sorted[j++] = tracked[i];
+        }
+    }
+
+    qsort(sorted, count, sizeof(TrackedVector), vector_tracked_compare);
+
+    for (size_t i = 0; i < count; ++i) {
+        const void *data = *(void *const *) sorted[i].vector;
+        VectorMemoryUsage vector_usage;
+
+        if (i > 0 && data != NULL && data == *(void *const *) sorted[i - 1].vector) {
+            continue;
+        }
+
+        bool measured = sorted[i].string
+                ? string_vector_memory_usage((const StringVector *) sorted[i].vector, &vector_usage)
+                : numeric_vector_memory_usage((const NumericVector *) sorted[i].vector, &vector_usage);
+
+        if (measured) {
+            vector_memory_usage_add(usage, &vector_usage);
+        }
+    }
+
+    pthread_mutex_unlock(&tracked_mutex);
+    free(sorted);
+
+    if (vectors != NULL) {
+        *vectors = count;
+    }
+
+    return true;
+}
+
+/* Makes vector allocate its items from pool, which it keeps a reference to, so the caller may
+ * string_pool_release() it right away. A NULL pool goes back to malloc(). Items already allocated
+ * by another pool must be gone first, e.g., with string_vector_clear().
+ */
+bool string_vector_use_pool(StringVector *vector, StringPool *pool)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true) || !string_vector_unshare(vector)) {
+        return false;
+    }
+
+    if (vector->pool == pool) {
+        return true;
+    }
+
+    string_vector_drop_spares(vector);
+
+    for (size_t i = 0; i < vector->offset; ++i) {
+        if (string_vector_item_in_pool(vector, vector->data[i])) {
+            logger(
+                    ERROR, true, __func__, __LINE__,
+                    "StringVector: %p still holds items allocated by StringPool: %p. Please clear it first.",
+                    vector, vector->pool
+            );
+
+            return false;
+        }
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "StringVector: %p allocates its items from StringPool: %p.", vector, pool);
+
+    if (pool != NULL) {
+        string_pool_retain(pool);
+    }
+
+    string_pool_release(vector->pool);
+    vector->pool = pool;
+    return true;
+}
+
+/* Header of the files written by string_vector_map_file(), followed by the offset of every line. The
+ * mapped file's size and modification time tell whether the index is stale.
+ */
+typedef struct {
+    char magic[8];
+    uint64_t file_size;
+    int64_t file_seconds;
+    int64_t file_nanoseconds;
+    uint64_t lines;
+} StringVectorFileIndex;
+
+static const char string_vector_index_magic[8] = "LVINDEX1";
+
+/* Reads index_path's line offsets into vector->item_sizes, returning how many there are, or -1 if
+ * the index is missing, stale or broken. Offsets are checked, so a bad index can't point anywhere
+ * outside the file.
+ */
+static ssize_t string_vector_read_file_index(StringVector *vector, const char *index_path, const struct stat *file)
+{
+    int fd = open(index_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    StringVectorFileIndex header;
+    struct stat index;
+    ssize_t lines = -1;
+
+    if (fstat(fd, &index) == 0 && read(fd, &header, sizeof(header)) == (ssize_t) sizeof(header)
+        && memcmp(header.magic, string_vector_index_magic, sizeof(header.magic)) == 0
+        && header.file_size == (uint64_t) file->st_size
+        && header.file_seconds == (int64_t) file->st_mtim.tv_sec
+        && header.file_nanoseconds == (int64_t) file->st_mtim.tv_nsec
+        && (uint64_t) index.st_size == sizeof(header) + header.lines * sizeof(uint64_t)
+        && (header.lines <= vector->capacity || string_vector_resize_slots(vector, header.lines)))
+    {
+        size_t bytes = header.lines * sizeof(uint64_t);
+        char *into = (char *) vector->item_sizes;
+        lines = (ssize_t) header.lines;
+
+        for (size_t done = 0; done < bytes;) {
+            ssize_t n = read(fd, into + done, bytes - done);
+
+            if (n <= 0) {
+                lines = -1;
+                break;
+            }
+
+            done += n;
+        }
+
+        for (ssize_t i = 0; i < lines; ++i) {
+            if (vector->item_sizes[i] >= header.file_size || (i > 0 && vector->item_sizes[i] <= vector->item_sizes[i - 1])) {
+                lines = -1;
+            }
+        }
+    }
+
+    close(fd);
+
+    if (lines < 0) {
+        logger(WARN, true, __func__, __LINE__, "Index: %s doesn't match the file it's for. Rebuilding it...", index_path);
+    }
+
+    return lines;
+}
+
+/* The index is only an accelerator, so failing to write it is just reported. */
+static void string_vector_write_file_index(const StringVector *vector, const char *index_path, const struct stat *file)
+{
+    int fd = open(index_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        logger(WARN, true, __func__, __LINE__, "Impossible to write index: %s. Error code: %i", index_path, errno);
+        return;
+    }
+
+    StringVectorFileIndex header = {0};
+    memcpy(header.magic, string_vector_index_magic, sizeof(header.magic));
+    header.file_size = file->st_size;
+    header.file_seconds = file->st_mtim.tv_sec;
+    header.file_nanoseconds = file->st_mtim.tv_nsec;
+    header.lines = vector->offset;
+
+    bool written = write(fd, &header, sizeof(header)) == (ssize_t) sizeof(header);
+    uint64_t offsets[4096];
+
+    for (size_t i = 0; written && i < vector->offset; i += 4096) {
+        size_t n = vector->offset - i < 4096 ? vector->offset - i : 4096;
+
+        for (size_t j = 0; j < n; ++j) {
+            offsets[j] = vector->data[i + j] - vector->mapped;
+        }
+
+        written = write(fd, offsets, n * sizeof(uint64_t)) == (ssize_t) (n * sizeof(uint64_t));
+    }
+
+    /* A truncated index doesn't match its size, so it's rebuilt next time. */
+    if (close(fd) != 0 || !written) {
+        logger(WARN, true, __func__, __LINE__, "Impossible to write index: %s. Error code: %i", index_path, errno);
+    }
+}
+
+/* Initializes vector with a line of path per item: path is mapped privately, and line ends are turned
+ * into \0 characters in place, so the file itself is never modified. Writing them makes the kernel
+ * copy every page, so the vector costs as much memory as the file; string_view_vector_map_file()
+ * shares the page cache instead. Lines are split the same way as string_view_vector_split() does.
+ * When index_path is given, line offsets are read from it instead of scanning the file, or written
+ * to it for the next time if it's missing or stale. Items can be modified like any others, and the
+ * mapping goes away with vector.
+ */
+bool string_vector_map_file(StringVector *vector, const char *path, const char *index_path)
+{
+    logger(INFO, debug, __func__, __LINE__, "Mapping file: %s into StringVector: %p...", path, vector);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat file;
+
+    if (fd < 0 || fstat(fd, &file) != 0) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to open file: %s. Error code: %i", path, errno);
+
+        if (fd >= 0) {
+            close(fd);
+        }
+
+        return false;
+    }
+
+    /* One more byte than the file, so the last line can be terminated even if there's no line end
+     * after it. Anonymous memory is reserved first, so that byte is zero even if the file fills its
+     * last page.
+     */
+    size_t size = file.st_size;
+    char *mapped = (char *) mmap(NULL, size + 1, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    int flags = MAP_PRIVATE | MAP_FIXED;
+
+#if defined(MAP_POPULATE)
+    /* Every page is written to anyway, so they're all faulted in at once. */
+    flags |= MAP_POPULATE;
+#endif
+
+    if (mapped != MAP_FAILED && size > 0 && mmap(mapped, size, PROT_READ | PROT_WRITE, flags, fd, 0) == MAP_FAILED) {
+        munmap(mapped, size + 1);
+        mapped = (char *) MAP_FAILED;
+    }
+
+    close(fd);
+
+    if (mapped == MAP_FAILED) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to map file: %s. Error code: %i", path, errno);
+        return false;
+    }
+
+    if (!string_vector_init(vector, DEFAULT_RESIZE_VALUE)) {
+        munmap(mapped, size + 1);
+        return false;
+    }
+
+    vector->mapped = mapped;
+    vector->mapped_size = size + 1;
+
+    ssize_t indexed = index_path == NULL ? -1 : string_vector_read_file_index(vector, index_path, &file);
+    size_t lines = indexed;
+
+    /* Line ends are scanned for twice, to make room for all of them at once. They're stored where
+     * their items' sizes will go, then turned into line offsets, as an index holds.
+     */
+    if (indexed < 0) {
+        lines = vector_find_delimiters(mapped, size, '\n', NULL);
+        lines += size > 0 && mapped[size - 1] != '\n';
+
+        if (lines > vector->capacity && !string_vector_resize_slots(vector, lines)) {
+            string_vector_free(vector);
+            return false;
+        }
+
+        size_t ends = vector_find_delimiters(mapped, size, '\n', vector->item_sizes);
+
+        for (size_t i = ends; i > 0; --i) {
+            if (i < lines) {
+                vector->item_sizes[i] = vector->item_sizes[i - 1] + 1;
+            }
+        }
+
+        if (lines > 0) {
+            vector->item_sizes[0] = 0;
+        }
+    }
+
+    size_t last_end = size > 0 && mapped[size - 1] == '\n' ? size - 1 : size;
+
+    for (size_t i = 0; i < lines; ++i) {
+        size_t start = vector->item_sizes[i];
+        size_t end = i + 1 < lines ? vector->item_sizes[i + 1] - 1 : last_end;
+
+        mapped[end] = '\0';
+        vector->data[i] = mapped + start;
+        vector->item_sizes[i] = end - start + 1;
+    }
+
+    vector->offset = lines;
+
+    if (index_path != NULL && indexed < 0) {
+        string_vector_write_file_index(vector, index_path, &file);
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "%li lines of file: %s mapped into StringVector: %p.", lines, path, vector);
+    return true;
+}
+
+size_t string_vector_get_capacity(const StringVector *vector)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return 0;
+    }
+
+    return vector->capacity;
+}
+
+/* Removes the item at index from the hash index, and returns it as an allocation of its own. Items
+ * living in a batch or a pool can't be handed to free(), so a copy of them is handed out.
+ */
+static char *string_vector_detach_item(StringVector *vector, size_t index)
+{
+    char *item = vector->data[index];
+
+    if (string_vector_has_index(vector)) {
+        string_vector_index_remove(vector, index, true);
+    }
+
+    if (string_vector_item_in_batch(vector, item) || string_vector_item_in_pool(vector, item)) {
+        item = (char *) malloc(vector->item_sizes[index]);
+
+        if (item == NULL) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for item #%li. Error code: %i", index, errno);
+            return NULL;
+        }
+
+        memcpy(item, vector->data[index], vector->item_sizes[index]);
+        string_vector_free_item(vector, vector->data[index]);
+    }
+
+    return item;
+}
+
+/* Returns the last heap-allocated string. Remember to free() it! */
+char *string_vector_pop(StringVector *vector)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true) || vector->offset == 0 || !string_vector_unshare(vector)) {
+        return NULL;
+    }
+
+    size_t index = vector->offset - 1;
+    char *last = string_vector_detach_item(vector, index);
+
+    if (last == NULL) {
+        return NULL;
+    }
+
+    vector->data[index] = NULL;
+    --vector->offset;
+    string_vector_fill_spare_gap(vector);
+
+    if (vector->journal != NULL) {
+        string_vector_log(vector, VECTOR_JOURNAL_POP, index, 0);
+    }
+
+    return last;
+}
+
+/* Takes the item at position out of vector, shifting the following ones left, and hands it to the
+ * caller, who must free() it. Returns NULL on failure.
+ */
+char *string_vector_take_at(StringVector *vector, size_t position)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true) || !string_vector_unshare(vector)) {
+        return NULL;
+    }
+
+    if (position >= vector->offset) {
+        logger(ERROR, true, __func__, __LINE__, "There's no such StringVector item at position: %li.", position);
+        return NULL;
+    }
+
+    char *item = string_vector_detach_item(vector, position);
+    if (item == NULL) {
+        return NULL;
+    }
+
+    size_t following = vector->offset - position - 1;
+
+    if (string_vector_has_index(vector)) {
+        string_vector_index_shift(vector, position + 1, vector->offset, (size_t) -1);
+        memmove(&vector->hashes[position], &vector->hashes[position + 1], following * sizeof(uint64_t));
+    }
+
+    memmove(&vector->data[position], &vector->data[position + 1], following * sizeof(char *));
+    memmove(&vector->item_sizes[position], &vector->item_sizes[position + 1], following * sizeof(size_t));
+
+    if (vector->buffer_sizes != NULL) {
+        memmove(&vector->buffer_sizes[position], &vector->buffer_sizes[position + 1], following * sizeof(size_t));
+    }
+    --vector->offset;
+    vector->data[vector->offset] = NULL;
+    string_vector_fill_spare_gap(vector);
+
+    if (vector->journal != NULL) {
+        string_vector_log(vector, VECTOR_JOURNAL_ERASE, position, 1);
+    }
+
+    return item;
+}
+
+/* string_vector_get_* set of functions return NULL on failure, e.g., position >= vector bounds. */
+const char *string_vector_get_first(const StringVector *vector)
+{
+    return string_vector_get_at(vector, 0);
+}
+
+const char *string_vector_get_at(const StringVector *vector, size_t position)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return NULL;
+    }
+
+    if (position >= vector->offset) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "StringVector: %p doesn't have any value on position: %li.",
+                vector, position
+        );
+
+        return NULL;
+    }
+
+    return vector->data[position];
+}
+
+const char *string_vector_get_last(const StringVector *vector)
+{
+    return string_vector_get_at(vector, vector->offset - 1);
+}
+
+size_t string_vector_strlen(const StringVector *vector, size_t position)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return 0;
+    }
+
+    if (vector->offset == 0) {
+        logger(
+                WARN, debug, __func__, __LINE__,
+                "StringVector has no string. Consider using string_vector_add{,_array}() before using this function."
+        );
+
+        return 0;
+    }
+
+    size_t length = vector->item_sizes[position];
+    return length == 0 ? length : length - 1;
+}
+
+void string_vector_print(const StringVector *vector)
+{
+    if (!vector->data) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "StringVector isn't properly initialized."
+        );
+
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "Please call string_vector_init() and string_vector_add() before using this function."
+        );
+
+        return;
+    }
+
+    for (size_t i = 0; i < vector->offset; ++i) {
+        printf("%s%s",
+                vector->data[i],
+                (i < vector->offset - 1 ? ", " : "\n"));
+    }
+
+    printf("StringVector capacity: %li\n", vector->capacity);
+    printf("StringVector items: %li\n", vector->offset);
+}
+
+/* Same as numeric_vector_write(). Items are written as they are, with no quoting nor escaping. */
+bool string_vector_write(const StringVector *vector, int fd, const VectorWriteOptions *options)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Writing StringVector: %p to file descriptor: %i...", vector, fd);
+
+    VectorWriter writer;
+    if (!vector_writer_init(&writer, fd, options, vector->offset * 32)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < vector->offset && !writer.failed; ++i) {
+        vector_writer_append(&writer, vector->data[i], vector->item_sizes[i] - 1);
+        vector_writer_end_item(&writer, i, vector->offset);
+    }
+
+    return vector_writer_finish(&writer);
+}
+
+static void string_vector_saved(void *context, bool succeeded)
+{
+    vector_transfer_finish((VectorTransfer *) context, succeeded);
+}
+
+/* Same as numeric_vector_save_async(), but the items are copied into a single buffer right away,
+ * along with their sizes, which is what's written.
+ */
+bool string_vector_save_async(
+        VectorIO *io,
+        const StringVector *vector,
+        int fd,
+        uint64_t offset,
+        uint64_t *size,
+        VectorIOCallback callback,
+        void *context)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    VectorTransfer *transfer = vector_transfer_create(io, NULL, fd, offset, NULL, callback, context);
+    if (transfer == NULL) {
+        return false;
+    }
+
+    size_t count = vector->offset;
+    size_t bytes = count * sizeof(uint64_t);
+
+    for (size_t i = 0; i < count; ++i) {
+        bytes += vector->item_sizes[i];
+    }
+
+    transfer->items = (char *) malloc(bytes > 0 ? bytes : 1);
+    if (transfer->items == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate %li bytes to save StringVector: %p. Error code: %i", bytes, vector, errno);
+        free(transfer);
+        return false;
+    }
+
+    char *into = transfer->items + count * sizeof(uint64_t);
+
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t item_size = vector->item_sizes[i];
+
+        memcpy(transfer->items + i * sizeof(uint64_t), &item_size, sizeof(item_size));
+        memcpy(into, vector->data[i], item_size);
+        into += item_size;
+    }
+
+    memcpy(transfer->header.magic, string_vector_save_magic, sizeof(transfer->header.magic));
+    transfer->header.count = count;
+    transfer->header.size = bytes;
+
+    struct iovec iov[2] = {
+        {&transfer->header, sizeof(transfer->header)},
+        {transfer->items, bytes}
+    };
+
+    if (!vector_io_submit(io, true, fd, iov, 2, offset, string_vector_saved, transfer)) {
+        free(transfer->items);
+        free(transfer);
+        return false;
+    }
+
+    if (size != NULL) {
+        *size = sizeof(transfer->header) + bytes;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Saving %li items of StringVector: %p at offset: %li...", count, vector, (long) offset);
+    return true;
+}
+
+/* Whether items, bytes long, holds count items one after the other, item_sizes[i] bytes each with
+ * their \0 character.
+ */
+static bool string_vector_check_items(const char *items, size_t bytes, const uint64_t *item_sizes, size_t count)
+{
+    size_t total = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (item_sizes[i] == 0 || item_sizes[i] > bytes - total || items[total + item_sizes[i] - 1] != '\0') {
+            return false;
+        }
+
+        total += item_sizes[i];
+    }
+
+    return total == bytes;
+}
+
+/* Appends the count items checked by string_vector_check_items(), adopting batch, which holds them. */
+static bool string_vector_adopt_batch(StringVector *vector, char *batch, size_t bytes, const uint64_t *item_sizes, size_t count)
+{
+    if (!string_vector_unshare(vector)
+        || (vector->offset + count > vector->capacity && !string_vector_reserve(vector, vector->offset + count - vector->capacity)))
+    {
+        return false;
+    }
+
+    string_vector_drop_spares(vector);
+
+    if (!string_vector_grow_batches(vector, 1)) {
+        return false;
+    }
+
+    string_vector_register_batch(vector, batch, bytes, count);
+
+    for (size_t i = 0; i < count; ++i) {
+        vector->data[vector->offset] = batch;
+        vector->item_sizes[vector->offset] = item_sizes[i];
+        string_vector_fit_buffer(vector, vector->offset);
+        ++vector->offset;
+        batch += item_sizes[i];
+        string_vector_index_added(vector, vector->offset - 1);
+    }
+
+    return true;
+}
+
+/* Checks the items read, and appends them to the vector, their buffer becoming one of its batches. */
+static void string_vector_loaded(void *context, bool succeeded)
+{
+    VectorTransfer *transfer = (VectorTransfer *) context;
+    StringVector *vector = (StringVector *) transfer->vector;
+    size_t count = transfer->header.count;
+    size_t bytes = transfer->header.size - count * sizeof(uint64_t);
+
+    if (succeeded && !string_vector_check_items(transfer->items, bytes, transfer->item_sizes, count)) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "File descriptor: %i holds a broken StringVector at offset: %li.", transfer->fd, (long) transfer->offset
+        );
+
+        succeeded = false;
+    }
+
+    if (succeeded && count > 0) {
+        succeeded = string_vector_adopt_batch(vector, transfer->items, bytes, transfer->item_sizes, count);
+    }
+
+    if (succeeded && count > 0) {
+        transfer->items = NULL;
+
+        if (vector->journal != NULL) {
+            string_vector_log(vector, VECTOR_JOURNAL_APPEND, vector->offset - count, count);
+        }
+    }
+
+    vector_transfer_finish(transfer, succeeded);
+}
+
+/* Reads the items' sizes and the items at once, into buffers as big as the header says. */
+static void string_vector_load_header(void *context, bool succeeded)
+{
+    VectorTransfer *transfer = (VectorTransfer *) context;
+    size_t count = transfer->header.count;
+    size_t bytes = 0;
+
+    if (succeeded && vector_transfer_check_header(transfer, string_vector_save_magic, 0)) {
+        bytes = transfer->header.size - count * sizeof(uint64_t);
+        transfer->item_sizes = (uint64_t *) malloc(count > 0 ? count * sizeof(uint64_t) : 1);
+        transfer->items = (char *) malloc(bytes > 0 ? bytes : 1);
+
+        if (transfer->item_sizes == NULL || transfer->items == NULL) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to allocate %li bytes to load a StringVector. Error code: %i", bytes, errno);
+            succeeded = false;
+        }
+    } else {
+        succeeded = false;
+    }
+
+    if (succeeded) {
+        struct iovec iov[2] = {
+            {transfer->item_sizes, count * sizeof(uint64_t)},
+            {transfer->items, bytes}
+        };
+
+        succeeded = vector_io_submit(
+                transfer->io, false, transfer->fd, iov, 2, transfer->offset + sizeof(transfer->header),
+                string_vector_loaded, transfer
+        );
+    }
+
+    if (!succeeded) {
+        vector_transfer_finish(transfer, false);
+    }
+}
+
+/* Same as numeric_vector_load_async(), for items saved by string_vector_save_async(). They're read
+ * into a single buffer, kept by vector as a batch.
+ */
+bool string_vector_load_async(
+        VectorIO *io,
+        StringVector *vector,
+        int fd,
+        uint64_t offset,
+        uint64_t *size,
+        VectorIOCallback callback,
+        void *context)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    VectorTransfer *transfer = vector_transfer_create(io, vector, fd, offset, size, callback, context);
+    if (transfer == NULL) {
+        return false;
+    }
+
+    struct iovec iov = {&transfer->header, sizeof(transfer->header)};
+
+    if (!vector_io_submit(io, false, fd, &iov, 1, offset, string_vector_load_header, transfer)) {
+        free(transfer);
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Loading StringVector: %p from offset: %li...", vector, (long) offset);
+    return true;
+}
+
+/* Leads what string_vector_save_compressed() writes: the blocks, then their index, index_offset bytes
+ * after the header, which the blocks' offsets are relative to as well.
+ */
+typedef struct {
+    char magic[8];
+    uint64_t count;
+    uint64_t block_count;
+    uint64_t index_offset;
+} StringVectorCompressedHeader;
+
+/* A block holds the items from first_item up to the next block's, each one's length, without the \0
+ * character, as a varint, followed by its characters, raw_size bytes in all. size is smaller than
+ * raw_size when they were compressed.
+ */
+typedef struct {
+    uint64_t first_item;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t raw_size;
+} StringVectorCompressedBlock;
+
+/* Blocks being written by string_vector_save_compressed(), the next one gathered in raw. */
+typedef struct {
+    int fd;
+    uint64_t offset;
+    uint64_t written; /* Bytes of blocks after the header. */
+    char *raw;
+    size_t raw_size;
+    size_t raw_capacity;
+    char *compressed;
+    size_t compressed_capacity;
+    StringVectorCompressedBlock *blocks;
+    size_t block_count;
+    size_t block_capacity;
+} StringVectorCompressor;
+
+static const char string_vector_compressed_magic[8] = "LVSTRZ01";
+
+static bool vector_pwrite_all(int fd, const void *buffer, size_t size, uint64_t offset)
+{
+    for (size_t done = 0; done < size;) {
+        ssize_t written = pwrite(fd, (const char *) buffer + done, size - done, (off_t) (offset + done));
+
+        if (written < 0 && errno == EINTR) {
+            continue;
+        } else if (written < 0) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to write to file descriptor: %i. Error code: %i", fd, errno);
+            return false;
+        }
+
+        done += written;
+    }
+
+    return true;
+}
+
+static bool vector_pread_all(int fd, void *buffer, size_t size, uint64_t offset)
+{
+    for (size_t done = 0; done < size;) {
+        ssize_t read = pread(fd, (char *) buffer + done, size - done, (off_t) (offset + done));
+
+        if (read < 0 && errno == EINTR) {
+            continue;
+        } else if (read <= 0) {
+            logger(
+                    ERROR, true, __func__, __LINE__,
+                    "Impossible to read %li bytes from file descriptor: %i at offset: %li. Error code: %i",
+                    size, fd, (long) offset, read < 0 ? errno : 0
+            );
+
+            return false;
+        }
+
+        done += read;
+    }
+
+    return true;
+}
+
+static size_t vector_write_varint(char *output, uint64_t value)
+{
+    size_t length = 0;
+
+    for (; value >= 0x80; value >>= 7) {
+        output[length++] = (char) (value | 0x80);
+    }
+
+    output[length++] = (char) value;
+    return length;
+}
+
+/* Returns where the varint at input ends, or NULL when it doesn't before end. */
+static const char *vector_read_varint(const char *input, const char *end, uint64_t *value)
+{
+    *value = 0;
+
+    for (unsigned shift = 0; input < end && shift < 64; shift += 7) {
+        unsigned char byte = (unsigned char) *input++;
+
+        *value |= (uint64_t) (byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0) {
+            return input;
+        }
+    }
+
+    return NULL;
+}
+
+/* Compresses the items gathered, and writes them as the block starting at first_item. Blocks which
+ * don't get smaller, or are too big for vector_compress(), are written as they are.
+ */
+static bool string_vector_flush_block(StringVectorCompressor *compressor, size_t first_item)
+{
+    if (compressor->raw_size == 0) {
+        return true;
+    }
+
+    if (compressor->block_count == compressor->block_capacity) {
+        size_t capacity = compressor->block_capacity == 0 ? DEFAULT_RESIZE_VALUE : compressor->block_capacity * 2;
+        StringVectorCompressedBlock *blocks = (StringVectorCompressedBlock *) realloc(
+                compressor->blocks, capacity * sizeof(StringVectorCompressedBlock)
+        );
+
+        if (blocks == NULL) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to allocate the index of %li blocks. Error code: %i", capacity, errno);
+            return false;
+        }
+
+        compressor->blocks = blocks;
+        compressor->block_capacity = capacity;
+    }
+
+    const char *data = compressor->raw;
+    size_t size = compressor->raw_size;
+
+    if (size <= UINT32_MAX) {
+        if (VECTOR_COMPRESSION_BOUND(size) > compressor->compressed_capacity) {
+            char *compressed = (char *) realloc(compressor->compressed, VECTOR_COMPRESSION_BOUND(size));
+
+            if (compressed == NULL) {
+                logger(ERROR, true, __func__, __LINE__, "Impossible to allocate %li bytes to compress items. Error code: %i", VECTOR_COMPRESSION_BOUND(size), errno);
+                return false;
+            }
+
+            compressor->compressed = compressed;
+            compressor->compressed_capacity = VECTOR_COMPRESSION_BOUND(size);
+        }
+
+        size_t compressed_size = vector_compress(compressor->raw, size, compressor->compressed);
+
+        if (compressed_size < size) {
+            data = compressor->compressed;
+            size = compressed_size;
+        }
+    }
+
+    if (!vector_pwrite_all(compressor->fd, data, size, compressor->offset + sizeof(StringVectorCompressedHeader) + compressor->written)) {
+        return false;
+    }
+
+    StringVectorCompressedBlock block = {first_item, compressor->written, size, compressor->raw_size};
+
+    compressor->blocks[compressor->block_count++] = block;
+    compressor->written += size;
+    compressor->raw_size = 0;
+    return true;
+}
+
+/* Writes vector's items at offset of fd, STRING_VECTOR_COMPRESSED_BLOCK_SIZE bytes of them compressed at
+ * a time, followed by an index of the blocks so string_vector_load_compressed() reads only those holding
+ * the items asked for. The header goes last, so a save cut short isn't taken for a good one. size, when
+ * not NULL, gets the bytes written.
+ */
+bool string_vector_save_compressed(const StringVector *vector, int fd, uint64_t offset, uint64_t *size)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    StringVectorCompressor compressor = {fd, offset, 0, NULL, 0, 0, NULL, 0, NULL, 0, 0};
+    size_t first_item = 0;
+    bool saved = true;
+
+    for (size_t i = 0; saved && i < vector->offset; ++i) {
+        size_t length = vector->item_sizes[i] - 1;
+        size_t needed = 10 + length; /* Longest varint, and the characters. */
+
+        if (compressor.raw_size > 0 && compressor.raw_size + needed > STRING_VECTOR_COMPRESSED_BLOCK_SIZE) {
+            saved = string_vector_flush_block(&compressor, first_item);
+            first_item = i;
+        }
+
+        if (saved && compressor.raw_size + needed > compressor.raw_capacity) {
+            size_t capacity = needed > STRING_VECTOR_COMPRESSED_BLOCK_SIZE ? needed : STRING_VECTOR_COMPRESSED_BLOCK_SIZE;
+            char *raw = (char *) realloc(compressor.raw, capacity);
+
+            if (raw == NULL) {
+                logger(ERROR, true, __func__, __LINE__, "Impossible to allocate %li bytes to gather items. Error code: %i", capacity, errno);
+                saved = false;
+                break;
+            }
+
+            compressor.raw = raw;
+            compressor.raw_capacity = capacity;
+        }
+
+        if (saved) {
+            compressor.raw_size += vector_write_varint(compressor.raw + compressor.raw_size, length);
+            memcpy(compressor.raw + compressor.raw_size, vector->data[i], length);
+            compressor.raw_size += length;
+        }
+    }
+
+    saved = saved && string_vector_flush_block(&compressor, first_item);
+
+    StringVectorCompressedHeader header = {{0}, vector->offset, compressor.block_count, compressor.written};
+    uint64_t index_size = compressor.block_count * sizeof(StringVectorCompressedBlock);
+
+    memcpy(header.magic, string_vector_compressed_magic, sizeof(header.magic));
+
+    saved = saved
+            && vector_pwrite_all(fd, compressor.blocks, index_size, offset + sizeof(header) + compressor.written)
+            && vector_pwrite_all(fd, &header, sizeof(header), offset);
+
+    free(compressor.raw);
+    free(compressor.compressed);
+    free(compressor.blocks);
+
+    if (saved && size != NULL) {
+        *size = sizeof(header) + compressor.written + index_size;
+    }
+
+    if (saved) {
+        logger(
+                INFO, debug, __func__, __LINE__, "Saved %li items of StringVector: %p in %li compressed blocks at offset: %li.",
+                vector->offset, vector, compressor.block_count, (long) offset
+        );
+    }
+
+    return saved;
+}
+
+static bool string_vector_read_compressed_header(int fd, uint64_t offset, StringVectorCompressedHeader *header)
+{
+    if (!vector_pread_all(fd, header, sizeof(*header), offset)) {
+        return false;
+    }
+
+    /* Blocks and index must fit in the file, which also bounds what loading them allocates. */
+    struct stat file;
+    uint64_t available = fstat(fd, &file) == 0 && S_ISREG(file.st_mode) && (uint64_t) file.st_size > offset + sizeof(*header)
+            ? (uint64_t) file.st_size - offset - sizeof(*header) : 0;
+
+    if (memcmp(header->magic, string_vector_compressed_magic, sizeof(header->magic)) != 0
+        || header->count > SIZE_MAX / sizeof(uint64_t) || header->block_count > header->count
+        || (header->count > 0 && header->block_count == 0) || header->index_offset > available
+        || header->block_count > (available - header->index_offset) / sizeof(StringVectorCompressedBlock))
+    {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "File descriptor: %i doesn't hold a compressed StringVector at offset: %li.", fd, (long) offset
+        );
+
+        return false;
+    }
+
+    return true;
+}
+
+/* Reads the index of the blocks of the StringVector saved at offset of fd, and checks that they hold
+ * its items one after the other.
+ */
+static StringVectorCompressedBlock *string_vector_read_compressed_index(int fd, uint64_t offset, const StringVectorCompressedHeader *header)
+{
+    size_t count = header->block_count > 0 ? header->block_count : 1;
+    StringVectorCompressedBlock *blocks = (StringVectorCompressedBlock *) malloc(count * sizeof(StringVectorCompressedBlock));
+
+    if (blocks == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate the index of %li blocks. Error code: %i", count, errno);
+        return NULL;
+    }
+
+    if (!vector_pread_all(fd, blocks, header->block_count * sizeof(StringVectorCompressedBlock),
+            offset + sizeof(StringVectorCompressedHeader) + header->index_offset))
+    {
+        free(blocks);
+        return NULL;
+    }
+
+    uint64_t end = 0;
+
+    for (size_t i = 0; i < header->block_count; ++i) {
+        const StringVectorCompressedBlock *block = &blocks[i];
+        uint64_t next = i + 1 < header->block_count ? blocks[i + 1].first_item : header->count;
+
+        /* Blocks of several items never outgrow STRING_VECTOR_COMPRESSED_BLOCK_SIZE, and only those up to
+         * UINT32_MAX bytes are compressed, which can't make them over 255 times smaller.
+         */
+        if ((i == 0 ? block->first_item != 0 : block->first_item <= blocks[i - 1].first_item)
+            || block->first_item >= header->count || block->offset != end
+            || block->size > header->index_offset - end || block->raw_size < next - block->first_item
+            || (next - block->first_item > 1 && block->raw_size > STRING_VECTOR_COMPRESSED_BLOCK_SIZE)
+            || (block->size != block->raw_size
+                && (block->size > block->raw_size || block->raw_size > UINT32_MAX || block->raw_size > 255 * block->size + 16)))
+        {
+            logger(
+                    ERROR, true, __func__, __LINE__,
+                    "File descriptor: %i holds a broken index of a compressed StringVector at offset: %li.", fd, (long) offset
+            );
+
+            free(blocks);
+            return NULL;
+        }
+
+        end += block->size;
+    }
+
+    return blocks;
+}
+
+/* Stores in count how many items the StringVector saved at offset of fd holds. */
+bool string_vector_count_compressed(int fd, uint64_t offset, size_t *count)
+{
+    StringVectorCompressedHeader header;
+
+    if (!string_vector_read_compressed_header(fd, offset, &header)) {
+        return false;
+    }
+
+    *count = header.count;
+    return true;
+}
+
+/* Copies the items of block, count of them, in [start, end) into batch from bytes on, and their
+ * sizes into item_sizes from start on. The whole block is checked, the items before and after too.
+ */
+static bool string_vector_unpack_block(const char *data, size_t raw_size, size_t first_item, size_t count,
+        size_t start, size_t end, char *batch, size_t *bytes, uint64_t *item_sizes)
+{
+    const char *limit = data + raw_size;
+
+    for (size_t i = first_item; i < first_item + count; ++i) {
+        uint64_t length;
+
+        if ((data = vector_read_varint(data, limit, &length)) == NULL || length > (uint64_t) (limit - data)) {
+            return false;
+        }
+
+        if (i >= start && i < end) {
+            memcpy(batch + *bytes, data, length);
+            batch[*bytes + length] = '\0';
+            *bytes += length + 1;
+            item_sizes[i - start] = length + 1;
+        }
+
+        data += length;
+    }
+
+    return data == limit;
+}
+
+/* Appends the length items from start on of the StringVector saved at offset of fd by
+ * string_vector_save_compressed(). Only the blocks holding them are read, at once, and decompressed,
+ * into a single batch.
+ */
+bool string_vector_load_compressed(StringVector *vector, int fd, uint64_t offset, size_t start, size_t length)
+{
+    StringVectorCompressedHeader header;
+
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true) || !string_vector_read_compressed_header(fd, offset, &header)) {
+        return false;
+    }
+
+    if (start > header.count || length > header.count - start) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "The compressed StringVector at offset: %li of file descriptor: %i doesn't have items from: %li to: %li.",
+                (long) offset, fd, start, start + length
+        );
+
+        return false;
+    } else if (length == 0) {
+        return true;
+    }
+
+    StringVectorCompressedBlock *blocks = string_vector_read_compressed_index(fd, offset, &header);
+    if (blocks == NULL) {
+        return false;
+    }
+
+    /* The first block is the last one starting at start or before it, and the last block is the last
+     * one starting before the end.
+     */
+    size_t first = 0;
+    size_t last = 0;
+
+    for (size_t low = 0, high = header.block_count; low < high;) {
+        size_t middle = low + (high - low) / 2;
+
+        if (blocks[middle].first_item <= start) {
+            first = middle;
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    for (last = first; last + 1 < header.block_count && blocks[last + 1].first_item < start + length; ++last) {
+    }
+
+    uint64_t compressed_size = blocks[last].offset + blocks[last].size - blocks[first].offset;
+    size_t capacity = 0;
+    size_t scratch_size = 0;
+
+    for (size_t i = first; i <= last; ++i) {
+        capacity = blocks[i].raw_size > SIZE_MAX - capacity ? SIZE_MAX : capacity + blocks[i].raw_size;
+        scratch_size = blocks[i].size < blocks[i].raw_size && blocks[i].raw_size > scratch_size ? blocks[i].raw_size : scratch_size;
+    }
+
+    /* A broken index may ask for more than there is; those allocations just fail. */
+    char *compressed = (char *) malloc(compressed_size > 0 ? compressed_size : 1);
+    char *scratch = (char *) malloc(scratch_size > 0 ? scratch_size : 1);
+    char *batch = capacity < SIZE_MAX ? (char *) malloc(capacity) : NULL;
+    uint64_t *item_sizes = (uint64_t *) malloc(length * sizeof(uint64_t));
+    size_t bytes = 0;
+    bool loaded = compressed != NULL && scratch != NULL && batch != NULL && item_sizes != NULL;
+
+    if (!loaded) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory to load %li compressed items. Error code: %i", length, errno);
+    }
+
+    loaded = loaded && vector_pread_all(fd, compressed, compressed_size,
+            offset + sizeof(header) + blocks[first].offset);
+
+    for (size_t i = first; loaded && i <= last; ++i) {
+        const StringVectorCompressedBlock *block = &blocks[i];
+        const char *data = compressed + (block->offset - blocks[first].offset);
+        size_t count = (i + 1 < header.block_count ? blocks[i + 1].first_item : header.count) - block->first_item;
+
+        if (block->size < block->raw_size) {
+            loaded = vector_decompress(data, block->size, scratch, block->raw_size);
+            data = scratch;
+        }
+
+        loaded = loaded && string_vector_unpack_block(data, block->raw_size, block->first_item, count,
+                start, start + length, batch, &bytes, item_sizes);
+
+        if (!loaded) {
+            logger(
+                    ERROR, true, __func__, __LINE__,
+                    "Block: %li of the compressed StringVector at offset: %li of file descriptor: %i is broken.",
+                    i, (long) offset, fd
+            );
+        }
+    }
+
+    free(blocks);
+    free(compressed);
+    free(scratch);
+
+    /* Items are smaller than the blocks, by their varints at least. */
+    char *shrunk = loaded && bytes < capacity ? (char *) realloc(batch, bytes) : NULL;
+    batch = shrunk != NULL ? shrunk : batch;
+
+    loaded = loaded && string_vector_adopt_batch(vector, batch, bytes, item_sizes, length);
+    free(item_sizes);
+
+    if (!loaded) {
+        free(batch);
+        return false;
+    }
+
+    if (vector->journal != NULL) {
+        string_vector_log(vector, VECTOR_JOURNAL_APPEND, vector->offset - length, length);
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Loaded %li compressed items into StringVector: %p.", length, vector);
+    return true;
+}
+
+/* Same as numeric_vector_replay(). Appended items are gathered in values and lengths instead, pending
+ * of them, for string_vector_add_sized_array() to copy runs of appends into a single batch.
+ */
+static bool string_vector_replay(StringVector *vector, const VectorJournalRecord *record,
+        const char **values, size_t *lengths, size_t *pending)
+{
+    const uint32_t *sizes = (const uint32_t *) (record + 1);
+    const char *characters = (const char *) (sizes + record->count);
+
+    if (record->operation <= VECTOR_JOURNAL_REPLACE) {
+        size_t bytes = record->size - (size_t) record->count * sizeof(uint32_t);
+        size_t total = 0;
+
+        if ((size_t) record->count * sizeof(uint32_t) > record->size) {
+            return false;
+        }
+
+        for (size_t i = 0; i < record->count; ++i) {
+            if (sizes[i] == 0 || sizes[i] > bytes - total || characters[total + sizes[i] - 1] != '\0') {
+                return false;
+            }
+
+            total += sizes[i];
+        }
+    }
+
+    if (record->operation == VECTOR_JOURNAL_APPEND) {
+        if (record->position != vector->offset + *pending) {
+            return false;
+        }
+
+        for (size_t i = 0; i < record->count; ++i) {
+            values[*pending] = characters;
+            lengths[*pending] = sizes[i] - 1;
+            characters += sizes[i];
+            ++*pending;
+        }
+
+        return true;
+    }
+
+    if (*pending > 0 && !string_vector_add_sized_array(vector, values, lengths, *pending)) {
+        return false;
+    }
+
+    *pending = 0;
+
+    switch (record->operation) {
+        case VECTOR_JOURNAL_INSERT:
+            return record->count == 1 && record->position < vector->offset
+                    && string_vector_insert(vector, characters, record->position);
+        case VECTOR_JOURNAL_REPLACE: {
+            char *value = record->count == 1 ? (char *) malloc(sizes[0]) : NULL;
+
+            if (value != NULL) {
+                memcpy(value, characters, sizes[0]);
+            }
+
+            if (value == NULL || !string_vector_replace_owned(vector, record->position, value, sizes[0] - 1)) {
+                free(value);
+                return false;
+            }
+
+            return true;
+        }
+        case VECTOR_JOURNAL_ERASE:
+            return record->count > 0 && record->position + record->count <= vector->offset
+                    && string_vector_erase(vector, record->position, record->count);
+        case VECTOR_JOURNAL_POP: {
+            char *last = record->position + 1 == vector->offset ? string_vector_pop(vector) : NULL;
+
+            free(last);
+            return last != NULL;
+        }
+        case VECTOR_JOURNAL_CLEAR:
+            return string_vector_clear(vector);
+        default:
+            return false;
+    }
+}
+
+/* Same as numeric_vector_recover(). The snapshot's items are read into a single batch. */
+static bool string_vector_recover(StringVector *vector, const VectorJournalContents *contents, size_t *valid_size)
+{
+    VectorSaveHeader header = {{0}, 0, 0};
+    const VectorJournalRecord *record;
+    size_t added = 0;
+
+    if (contents->snapshot_fd >= 0
+        && (!vector_journal_read(contents, &header, sizeof(header), 0)
+            || memcmp(header.magic, string_vector_save_magic, sizeof(header.magic)) != 0
+            || header.size != contents->snapshot_size - sizeof(header) || header.count > header.size / sizeof(uint64_t)))
+    {
+        logger(ERROR, true, __func__, __LINE__, "The snapshot StringVector: %p is recovered from is damaged.", vector);
+        return false;
+    }
+
+    for (size_t offset = 0; (record = vector_journal_next(contents, &offset)) != NULL;) {
+        added += record->operation == VECTOR_JOURNAL_APPEND || record->operation == VECTOR_JOURNAL_INSERT ? record->count : 0;
+        *valid_size = offset;
+    }
+
+    if (!string_vector_unshare(vector)
+        || (header.count + added > vector->capacity && !string_vector_reserve(vector, header.count + added - vector->capacity)))
+    {
+        return false;
+    }
+
+    if (header.count > 0) {
+        size_t bytes = header.size - header.count * sizeof(uint64_t);
+        uint64_t *item_sizes = (uint64_t *) malloc(header.count * sizeof(uint64_t));
+        char *items = (char *) malloc(bytes > 0 ? bytes : 1);
+
+        bool loaded = item_sizes != NULL && items != NULL
+                && vector_journal_read(contents, item_sizes, header.count * sizeof(uint64_t), sizeof(header))
+                && vector_journal_read(contents, items, bytes, sizeof(header) + header.count * sizeof(uint64_t))
+                && string_vector_check_items(items, bytes, item_sizes, header.count)
+                && string_vector_adopt_batch(vector, items, bytes, item_sizes, header.count);
+
+        free(item_sizes);
+
+        if (!loaded) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to read the snapshot StringVector: %p is recovered from.", vector);
+            free(items);
+            return false;
+        }
+    }
+
+    const char **values = (const char **) malloc((added > 0 ? added : 1) * sizeof(char *));
+    size_t *lengths = (size_t *) malloc((added > 0 ? added : 1) * sizeof(size_t));
+    size_t pending = 0;
+    bool replayed = values != NULL && lengths != NULL;
+
+    for (size_t offset = 0; replayed && offset < *valid_size;) {
+        size_t at = offset;
+
+        replayed = string_vector_replay(vector, vector_journal_next(contents, &offset), values, lengths, &pending);
+        if (!replayed) {
+            logger(ERROR, true, __func__, __LINE__, "The record at byte %li of StringVector: %p's journal doesn't apply to it.", at, vector);
+        }
+    }
+
+    replayed = replayed && (pending == 0 || string_vector_add_sized_array(vector, values, lengths, pending));
+
+    free(values);
+    free(lengths);
+    return replayed;
+}
+
+/* Same as numeric_vector_open_journal(). */
+bool string_vector_open_journal(StringVector *vector, const char *path, size_t sync_bytes)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (vector->offset > 0 || vector->journal != NULL) {
+        logger(ERROR, true, __func__, __LINE__, "StringVector: %p must be empty, without a journal, to open one.", vector);
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Recovering StringVector: %p from journal: %s...", vector, path);
+
+    VectorJournalContents contents;
+    VectorJournal *journal = vector_journal_open(path, sync_bytes, &contents);
+    size_t valid_size = 0;
+
+    if (journal == NULL) {
+        return false;
+    }
+
+    if (!string_vector_recover(vector, &contents, &valid_size) || !vector_journal_start(journal, &contents, valid_size)) {
+        vector_journal_discard(&contents);
+        vector_journal_close(journal);
+        string_vector_clear(vector);
+        return false;
+    }
+
+    vector->journal = journal;
+    logger(INFO, debug, __func__, __LINE__, "StringVector: %p recovered with %li items.", vector, vector->offset);
+    return true;
+}
+
+/* Same as numeric_vector_sync_journal(). */
+bool string_vector_sync_journal(StringVector *vector)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (vector->journal == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "StringVector: %p has no journal.", vector);
+        return false;
+    }
+
+    if (vector_journal_needs_compaction(vector->journal)) {
+        return string_vector_compact_journal(vector);
+    }
+
+    return vector_journal_sync(vector->journal);
+}
+
+/* Same as numeric_vector_compact_journal(). The snapshot is laid out as string_vector_save_async() does. */
+bool string_vector_compact_journal(StringVector *vector)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (vector->journal == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "StringVector: %p has no journal.", vector);
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Writing a snapshot of StringVector: %p's %li items...", vector, vector->offset);
+
+    int fd = vector_journal_begin_snapshot(vector->journal);
+    if (fd < 0) {
+        return false;
+    }
+
+    VectorSaveHeader header = {{0}, vector->offset, vector->offset * sizeof(uint64_t)};
+    VectorWriteOptions raw = {"", "", false, 0};
+    VectorWriter writer;
+
+    memcpy(header.magic, string_vector_save_magic, sizeof(header.magic));
+    for (size_t i = 0; i < vector->offset; ++i) {
+        header.size += vector->item_sizes[i];
+    }
+
+    if (!vector_writer_init(&writer, fd, &raw, sizeof(header) + header.size)) {
+        return vector_journal_end_snapshot(vector->journal, fd, false);
+    }
+
+    vector_writer_append(&writer, (const char *) &header, sizeof(header));
+
+    for (size_t i = 0; i < vector->offset; ++i) {
+        uint64_t size = vector->item_sizes[i];
+        vector_writer_append(&writer, (const char *) &size, sizeof(size));
+    }
+
+    for (size_t i = 0; i < vector->offset; ++i) {
+        vector_writer_append(&writer, vector->data[i], vector->item_sizes[i]);
+    }
+
+    return vector_journal_end_snapshot(vector->journal, fd, vector_writer_finish(&writer));
+}
+
+/* Same as numeric_vector_close_journal(). */
+bool string_vector_close_journal(StringVector *vector)
+{
+    if (vector->journal == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "StringVector: %p has no journal.", vector);
+        return false;
+    }
+
+    bool synced = string_vector_sync_journal(vector);
+
+    vector_journal_close(vector->journal);
+    vector->journal = NULL;
+    return synced;
+}
+
+/* Builds a hash index over vector's items. From now on, string_vector_find() and
+ * string_vector_contains() take O(1) expected time instead of scanning the vector,
+ * and every operation modifying vector keeps the index up to date.
+ */
+bool string_vector_enable_index(StringVector *vector)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (!string_vector_unshare(vector)) {
+        return false;
+    }
+
+    if (string_vector_has_index(vector)) {
+        logger(WARN, debug, __func__, __LINE__, "StringVector: %p is already indexed.", vector);
+        return true;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Indexing %li items of StringVector: %p...", vector->offset, vector);
+
+    vector->hashes = (uint64_t *) malloc((vector->capacity > 0 ? vector->capacity : 1) * sizeof(uint64_t));
+    if (vector->hashes == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate StringVector: %p's hashes. Error code: %i", vector, errno);
+        return false;
+    }
+
+    for (size_t i = 0; i < vector->offset; ++i) {
+        vector->hashes[i] = string_vector_hash(vector->data[i], vector->item_sizes[i] - 1);
+    }
+
+    size_t index_capacity = DEFAULT_RESIZE_VALUE * 2;
+    while (index_capacity < vector->offset * 2) {
+        index_capacity *= 2;
+    }
+
+    /* Rounded up to a power of two, so slots can be computed with a mask. */
+    size_t power = 1;
+    while (power < index_capacity) {
+        power <<= 1;
+    }
+
+    if (!string_vector_index_rebuild(vector, power)) {
+        free(vector->hashes);
+        vector->hashes = NULL;
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "StringVector: %p indexed with %li slots.", vector, power);
+    return true;
+}
+
+void string_vector_disable_index(StringVector *vector)
+{
+    if (!string_vector_unshare(vector)) {
+        return;
+    }
+
+    free(vector->hashes);
+    free(vector->hash_index);
+    free(vector->hash_counts);
+    vector->hashes = NULL;
+    vector->hash_index = NULL;
+    vector->hash_counts = NULL;
+    vector->hash_index_capacity = 0;
+}
+
+/* Stores in position the first position holding value. Returns false if value isn't in vector. */
+bool string_vector_find(const StringVector *vector, const char *value, size_t *position)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    size_t length = string_vector_item_strlen(value);
+    bool found = false;
+
+    if (!string_vector_has_index(vector)) {
+        for (size_t i = 0; i < vector->offset && !found; ++i) {
+            if (vector->item_sizes[i] == length + 1 && memcmp(vector->data[i], value, length) == 0) {
+                *position = i;
+                found = true;
+            }
+        }
+
+        return found;
+    }
+
+    uint64_t hash = string_vector_hash(value, length);
+    size_t mask = vector->hash_index_capacity - 1;
+
+    /* Identical items share one slot, holding the first of them. */
+    for (size_t slot = hash & mask; vector->hash_index[slot] != 0; slot = (slot + 1) & mask) {
+        size_t i = vector->hash_index[slot] - 1;
+
+        if (vector->hashes[i] == hash
+            && vector->item_sizes[i] == length + 1
+            && memcmp(vector->data[i], value, length) == 0)
+        {
+            *position = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool string_vector_contains(const StringVector *vector, const char *value)
+{
+    size_t position;
+    return string_vector_find(vector, value, &position);
+}
+
+/* Items handled by string_vector_sort_range() are represented by these records, so comparisons
+ * mostly look at key, the next 8 bytes of the item, and don't chase the item's pointer.
+ */
+typedef struct {
+    uint64_t key;
+    size_t position;
+} StringVectorSortRecord;
+
+#define STRING_VECTOR_SORT_INSERTION_THRESHOLD 16
+
+/* Loads the 8 bytes of item starting at depth, big-endian so that comparing keys as integers
+ * is the same as comparing those bytes with strcmp(). Bytes past the end of item are 0.
+ */
+static uint64_t string_vector_sort_key(const StringVector *vector, size_t position, size_t depth)
+{
+    size_t length = vector->item_sizes[position] - 1;
+    const unsigned char *item = (const unsigned char *) vector->data[position];
+    uint64_t key = 0;
+
+    for (size_t i = 0; i < 8; ++i) {
+        key <<= 8;
+        if (depth + i < length) {
+            key |= item[depth + i];
+        }
+    }
+
+    return key;
+}
+
+/* Full comparison of two records from depth on, used when few records are left. */
+static int string_vector_sort_compare(const StringVector *vector, const StringVectorSortRecord *a,
+        const StringVectorSortRecord *b, size_t depth, bool stable)
+{
+    if (a->key != b->key) {
+        return a->key < b->key ? -1 : 1;
+    }
+
+    int result = 0;
+    if ((a->key & 0xFF) != 0) {
+        result = strcmp(vector->data[a->position] + depth + 8, vector->data[b->position] + depth + 8);
+    }
+
+    if (result == 0 && stable) {
+        result = a->position < b->position ? -1 : (a->position > b->position ? 1 : 0);
+    }
+
+    return result;
+}
+
+/* Moves the record at root down the max-heap of n records ordered by position. */
+static void string_vector_sort_sift(StringVectorSortRecord *records, size_t root, size_t n)
+{
+    StringVectorSortRecord record = records[root];
+
+    for (size_t child = 2 * root + 1; child < n; child = 2 * root + 1) {
+        if (child + 1 < n && records[child + 1].position > records[child].position) {
+            ++child;
+        }
+
+        if (records[child].position <= record.position) {
+            break;
+        }
+
+        records[root] = records[child];
+        root = child;
+    }
+
+    records[root] = record;
+}
+
+/* Sorts records by position, which is how identical items keep their original order. A heapsort,
+ * as groups of identical items can be as big as the vector and this mustn't allocate or fail.
+ */
+static void string_vector_sort_positions(StringVectorSortRecord *records, size_t n)
+{
+    for (size_t i = n / 2; i > 0; --i) {
+        string_vector_sort_sift(records, i - 1, n);
+    }
+
+    for (size_t i = n; i > 1; --i) {
+        StringVectorSortRecord tmp = records[0];
+        records[0] = records[i - 1];
+        records[i - 1] = tmp;
+        string_vector_sort_sift(records, 0, i - 1);
+    }
+}
+
+/* Multikey quicksort (Bentley & Sedgewick) over 8-byte keys: records are partitioned around a
+ * pivot key, and only the group equal to the pivot moves on to the next 8 bytes.
+ */
+static void string_vector_sort_range(const StringVector *vector, StringVectorSortRecord *records,
+        size_t n, size_t depth, bool stable)
+{
+    while (n > STRING_VECTOR_SORT_INSERTION_THRESHOLD) {
+        uint64_t a = records[0].key;
+        uint64_t b = records[n / 2].key;
+        uint64_t c = records[n - 1].key;
+        uint64_t pivot = a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b));
+
+        /* Dijkstra's 3-way partition: [0, lt) < pivot, [lt, i) == pivot, (gt, n) > pivot. */
+        size_t lt = 0;
+        size_t i = 0;
+        size_t gt = n;
+
+        while (i < gt) {
+            if (records[i].key < pivot) {
+                StringVectorSortRecord tmp = records[lt];
+                records[lt++] = records[i];
+                records[i++] = tmp;
+            } else if (records[i].key > pivot) {
+                StringVectorSortRecord tmp = records[--gt];
+                records[gt] = records[i];
+                records[i] = tmp;
+            } else {
+                ++i;
+            }
+        }
+
+        StringVectorSortRecord *equal = records + lt;
+        size_t equal_n = gt - lt;
+
+        if ((pivot & 0xFF) == 0) {
+            /* Items ended within these 8 bytes, so they're all identical. */
+            if (stable) {
+                string_vector_sort_positions(equal, equal_n);
+            }
+        } else {
+            for (size_t j = 0; j < equal_n; ++j) {
+                equal[j].key = string_vector_sort_key(vector, equal[j].position, depth + 8);
+            }
+
+            string_vector_sort_range(vector, equal, equal_n, depth + 8, stable);
+        }
+
+        /* Recurse into the smaller side, and loop over the bigger one to bound the stack depth. */
+        if (lt < n - gt) {
+            string_vector_sort_range(vector, records, lt, depth, stable);
+            records += gt;
+            n -= gt;
+        } else {
+            string_vector_sort_range(vector, records + gt, n - gt, depth, stable);
+            n = lt;
+        }
+    }
+
+    for (size_t i = 1; i < n; ++i) {
+        StringVectorSortRecord record = records[i];
+        size_t j = i;
+
+        for (; j > 0 && string_vector_sort_compare(vector, &records[j - 1], &record, depth, stable) > 0; --j) {
+            records[j] = records[j - 1];
+        }
+
+        records[j] = record;
+    }
+}
+
+static StringVectorSortRecord *string_vector_sort_records(const StringVector *vector, bool stable)
+{
+    StringVectorSortRecord *records = (StringVectorSortRecord *) malloc(
+            (vector->offset > 0 ? vector->offset : 1) * sizeof(StringVectorSortRecord));
+
+    if (records == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory to sort StringVector: %p. Error code: %i", vector, errno);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < vector->offset; ++i) {
+        records[i].key = string_vector_sort_key(vector, i, 0);
+        records[i].position = i;
+    }
+
+    string_vector_sort_range(vector, records, vector->offset, 0, stable);
+    return records;
+}
+
+/* Stores in permutation[i] the position, in vector, of the item that goes i-th once sorted.
+ * permutation must have room for vector->offset positions. vector isn't modified.
+ * With stable, identical items keep their relative order.
+ */
+bool string_vector_sort_permutation(const StringVector *vector, size_t *permutation, bool stable)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    StringVectorSortRecord *records = string_vector_sort_records(vector, stable);
+    if (records == NULL) {
+        return false;
+    }
+
+    for (size_t i = 0; i < vector->offset; ++i) {
+        permutation[i] = records[i].position;
+    }
+
+    free(records);
+    return true;
+}
+
+/* Sorts vector's items in strcmp() order. With stable, identical items keep their relative order. */
+bool string_vector_sort(StringVector *vector, bool stable)
+{
+    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (!string_vector_unshare(vector)) {
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "Sorting %li items of StringVector: %p...", vector->offset, vector);
+
+    StringVectorSortRecord *records = string_vector_sort_records(vector, stable);
+    if (records == NULL) {
+        return false;
+    }
+
+    size_t n = vector->offset > 0 ? vector->offset : 1;
+    char **data = (char **) malloc(n * sizeof(char *));
+    size_t *item_sizes = (size_t *) malloc(n * sizeof(size_t));
+    uint64_t *hashes = string_vector_has_index(vector) ? (uint64_t *) malloc(n * sizeof(uint64_t)) : NULL;
+
+    if (data == NULL || item_sizes == NULL || (string_vector_has_index(vector) && hashes == NULL)) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory to sort StringVector: %p. Error code: %i", vector, errno);
+        free(records);
+        free(data);
+        free(item_sizes);
+        free(hashes);
+        return false;
+    }
+
+    /* Pointers, sizes and hashes are permuted in lockstep. Strings aren't moved. */
+    for (size_t i = 0; i < vector->offset; ++i) {
+        data[i] = vector->data[records[i].position];
+        item_sizes[i] = vector->item_sizes[records[i].position];
+        if (hashes != NULL) {
+            hashes[i] = vector->hashes[records[i].position];
+        }
+    }
+
+    memcpy(vector->data, data, vector->offset * sizeof(char *));
+    memcpy(vector->item_sizes, item_sizes, vector->offset * sizeof(size_t));
+
+    if (vector->buffer_sizes != NULL) {
+        for (size_t i = 0; i < vector->offset; ++i) {
+            item_sizes[i] = vector->buffer_sizes[records[i].position];
+        }
+
+        memcpy(vector->buffer_sizes, item_sizes, vector->offset * sizeof(size_t));
+    }
+
+    if (hashes != NULL) {
+        memcpy(vector->hashes, hashes, vector->offset * sizeof(uint64_t));
+
+        if (!string_vector_index_rebuild(vector, vector->hash_index_capacity)) {
+            string_vector_index_drop(vector);
+        }
+    }
+
+    free(records);
+    free(data);
+    free(item_sizes);
+    free(hashes);
+
+    /* Every item may move, so the next snapshot records them rather than the log. */
+    if (vector->journal != NULL) {
+        vector_journal_invalidate(vector->journal);
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "StringVector: %p sorted.", vector);
+    return true;
+}
+
+/* firsts holds count + 1 ascending entries, the first chunk or item of every source. Returns the last
+ * source starting at or before at. Empty sources start where the next one does, so they're skipped.
+ */
+static size_t parallel_source_at(const size_t *firsts, size_t count, size_t at)
+{
+    size_t low = 0;
+    size_t high = count;
+
+    while (high - low > 1) {
+        size_t middle = low + (high - low) / 2;
+
+        if (firsts[middle] <= at) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+typedef struct {
+    const StringVector *sources;
+    size_t source_count;
+    const size_t *first_chunks; /* source_count + 1 entries: the chunk every source starts at... */
+    const size_t *first_items; /* ...and the position, relative to base, its first item is copied to. */
+    StringVector *destination;
+    size_t base; /* destination's offset before copying. */
+    char **batches; /* One per chunk. */
+    size_t *batch_sizes;
+    size_t *batch_items;
+    atomic_bool failed;
+} StringVectorCopyJob;
+
+static size_t string_vector_parallel_chunks(size_t items)
+{
+    return (items + STRING_VECTOR_PARALLEL_CHUNK - 1) / STRING_VECTOR_PARALLEL_CHUNK;
+}
+
+/* Copies a chunk of source's items into a batch of its own. Every chunk makes a single allocation,
+ * from the thread processing it, so threads don't keep fighting over malloc()'s locks.
+ */
+static void string_vector_copy_chunk(void *context, size_t chunk)
+{
+    StringVectorCopyJob *job = (StringVectorCopyJob *) context;
+    size_t index = parallel_source_at(job->first_chunks, job->source_count, chunk);
+    const StringVector *source = &job->sources[index];
+    size_t position = job->base + job->first_items[index];
+    size_t start = (chunk - job->first_chunks[index]) * STRING_VECTOR_PARALLEL_CHUNK;
+    size_t end = start + STRING_VECTOR_PARALLEL_CHUNK < source->offset ? start + STRING_VECTOR_PARALLEL_CHUNK : source->offset;
+    size_t total = 0;
+
+    for (size_t i = start; i < end; ++i) {
+        total += source->item_sizes[i];
+    }
+
+    char *batch = (char *) malloc(total * sizeof(char));
+    job->batches[chunk] = batch;
+    job->batch_sizes[chunk] = total;
+    job->batch_items[chunk] = end - start;
+
+    if (batch == NULL) {
+        atomic_store(&job->failed, true);
+        return;
+    }
+
+    for (size_t i = start; i < end; ++i) {
+        memcpy(batch, source->data[i], source->item_sizes[i]);
+        job->destination->data[position + i] = batch;
+        job->destination->item_sizes[position + i] = source->item_sizes[i];
+        string_vector_fit_buffer(job->destination, position + i);
+        batch += source->item_sizes[i];
+    }
+}
+
+/* Copies the items of every source, one after another, into destination, which must have room for
+ * all of them. Every source is split into chunks copied by libvector's thread pool.
+ */
+static bool string_vector_parallel_copy_sources(const StringVector *sources, size_t source_count, StringVector *destination)
+{
+    size_t *first_chunks = (size_t *) malloc((source_count + 1) * sizeof(size_t));
+    size_t *first_items = (size_t *) malloc((source_count + 1) * sizeof(size_t));
+
+    if (first_chunks == NULL || first_items == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for copying %li StringVectors. Error code: %i", source_count, errno);
+        free(first_chunks);
+        free(first_items);
+        return false;
+    }
+
+    first_chunks[0] = 0;
+    first_items[0] = 0;
+    for (size_t i = 0; i < source_count; ++i) {
+        first_chunks[i + 1] = first_chunks[i] + string_vector_parallel_chunks(sources[i].offset);
+        first_items[i + 1] = first_items[i] + sources[i].offset;
+    }
+
+    size_t chunks = first_chunks[source_count];
+    size_t items = first_items[source_count];
+    StringVectorCopyJob job = { sources, source_count, first_chunks, first_items, destination, destination->offset, NULL, NULL, NULL, false };
+
+    if (!string_vector_grow_batches(destination, chunks)) {
+        free(first_chunks);
+        free(first_items);
+        return false;
+    }
+
+    string_vector_drop_spares(destination);
+
+    job.batches = (char **) calloc(chunks > 0 ? chunks : 1, sizeof(char *));
+    job.batch_sizes = (size_t *) malloc((chunks > 0 ? chunks : 1) * sizeof(size_t));
+    job.batch_items = (size_t *) malloc((chunks > 0 ? chunks : 1) * sizeof(size_t));
+    bool allocated = job.batches != NULL && job.batch_sizes != NULL && job.batch_items != NULL;
+
+    if (!allocated || !thread_pool_run(string_vector_copy_chunk, &job, chunks)) {
+        atomic_store(&job.failed, true);
+        chunks = allocated ? chunks : 0;
+    }
+
+    free(first_chunks);
+    free(first_items);
+
+    if (atomic_load(&job.failed)) {
+        for (size_t i = 0; i < chunks; ++i) {
+            free(job.batches[i]);
+        }
+
+        for (size_t i = job.base; i < job.base + items; ++i) {
+            destination->data[i] = NULL;
+        }
+
+        free(job.batches);
+        free(job.batch_sizes);
+        free(job.batch_items);
+        return false;
+    }
+
+    for (size_t i = 0; i < chunks; ++i) {
+        string_vector_register_batch(destination, job.batches[i], job.batch_sizes[i], job.batch_items[i]);
+    }
+
+    for (size_t i = 0; i < items; ++i) {
+        ++destination->offset;
+        string_vector_index_added(destination, destination->offset - 1);
+    }
+
+    if (destination->journal != NULL) {
+        string_vector_log(destination, VECTOR_JOURNAL_APPEND, job.base, items);
+    }
+
+    free(job.batches);
+    free(job.batch_sizes);
+    free(job.batch_items);
+    return true;
+}
+
+/* Same as string_vector_copy(), but items are copied by libvector's thread pool. */
+bool string_vector_parallel_copy(const StringVector *source, StringVector *destination, bool initialize)
+{
+    if (!string_vector_is_valid(source, __func__, __LINE__, true)) {
+        return false;
+    }
+
+    if (initialize) {
+        if (!string_vector_init(destination, source->capacity)) {
+            logger(
+                    ERROR, true, __func__, __LINE__,
+                    "Impossible to initialize StringVector: %p. Not continuing.",
+                    destination
+            );
+
+            return false;
+        }
+    } else if (!string_vector_is_valid(destination, __func__, __LINE__, false)) {
+        logger(ERROR, true, __func__, __LINE__, "You told me not to initialize it. Not continuing.");
+        return false;
+    } else if (!string_vector_unshare(destination)) {
+        return false;
+    }
+
+    logger(
+            INFO, debug, __func__, __LINE__,
+            "Copying StringVector: %p's values into StringVector: %p in parallel...",
+            source, destination
+    );
+
+    if ((destination->offset + source->offset > destination->capacity && !string_vector_reserve(destination, source->offset))
+        || !string_vector_parallel_copy_sources(source, 1, destination))
+    {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "Impossible to copy StringVector: %p into StringVector: %p.",
+                source, destination
+        );
+
+        if (initialize) {
+            string_vector_free(destination);
+        }
+
+        return false;
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "StringVector: %p's values copied into StringVector: %p.", source, destination);
+    return true;
+}
+
+/* Frees every item in a chunk of vector. Batches are left for string_vector_parallel_free(). */
+static void string_vector_free_chunk(void *context, size_t chunk)
+{
+    StringVector *vector = (StringVector *) context;
+    size_t start = chunk * STRING_VECTOR_PARALLEL_CHUNK;
+    size_t end = start + STRING_VECTOR_PARALLEL_CHUNK < vector->capacity ? start + STRING_VECTOR_PARALLEL_CHUNK : vector->capacity;
+
+    /* Only shared pools take items back from several threads at once. Items of other pools are left
+     * to string_vector_free().
+     */
+    bool skip_pooled = vector->pool != NULL && !string_pool_is_shared(vector->pool);
+
+    for (size_t i = start; i < end; ++i) {
+        char *item = vector->data[i];
+
+        if (item == NULL || (skip_pooled && string_vector_item_in_pool(vector, item))) {
+            continue;
+        }
+
+        /* Batches are freed whole afterwards, so what they hold isn't counted down. */
+        if (!string_vector_item_in_batch(vector, item)) {
+            string_vector_free_item(vector, item);
+        }
+
+        vector->data[i] = NULL;
+    }
+}
+
+static void string_vector_free_batch(void *context, size_t batch)
+{
+    StringVector *vector = (StringVector *) context;
+    free(vector->batches[batch]);
+    vector->batches[batch] = NULL;
+}
+
+/* Same as string_vector_free(), but items are freed by libvector's thread pool. Items from a
+ * StringPool which isn't shared are still freed by the calling thread.
+ */
+void string_vector_parallel_free(StringVector *vector)
+{
+    logger(INFO, debug, __func__, __LINE__, "Freeing StringVector: %p in parallel...", vector);
+
+    if (vector->journal != NULL) {
+        string_vector_close_journal(vector);
+    }
+
+    /* Other vectors still need the items. */
+    if (vector_is_shared(vector->references)) {
+        string_vector_free(vector);
+        return;
+    }
+
+    if (vector->data != NULL) {
+        thread_pool_run(string_vector_free_chunk, vector, string_vector_parallel_chunks(vector->capacity));
+    }
+
+    /* Items are gone, so batches don't need to be looked up anymore. */
+    if (vector->batch_count > 0) {
+        thread_pool_run(string_vector_free_batch, vector, vector->batch_count);
+    }
+
+    /* What's left are empty slots and the batch list itself. */
+    string_vector_free(vector);
+}
+
+bool sharded_numeric_vector_init(ShardedNumericVector *vector, size_t shards, size_t initial_size)
+{
+    logger(INFO, debug, __func__, __LINE__, "Initializing ShardedNumericVector: %p with %li shards...", vector, shards);
+
+    vector->shards = (NumericVector *) calloc(shards > 0 ? shards : 1, sizeof(NumericVector));
+    vector->shard_count = 0;
+    vector->claimed = 0;
+
+    if (vector->shards == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for %li shards. Error code: %i", shards, errno);
+        return false;
+    }
+
+    for (; vector->shard_count < shards; ++vector->shard_count) {
+        if (!numeric_vector_init(&vector->shards[vector->shard_count], initial_size > 0 ? initial_size : DEFAULT_RESIZE_VALUE)) {
+            sharded_numeric_vector_free(vector);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void sharded_numeric_vector_free(ShardedNumericVector *vector)
+{
+    logger(INFO, debug, __func__, __LINE__, "Freeing ShardedNumericVector: %p...", vector);
+
+    for (size_t i = 0; i < vector->shard_count; ++i) {
+        numeric_vector_free(&vector->shards[i]);
+    }
+
+    free(vector->shards);
+    vector->shards = NULL;
+    vector->shard_count = 0;
+}
+
+/* Returns a shard nobody claimed yet, for the calling thread to fill, or NULL if they're all taken. */
+NumericVector *sharded_numeric_vector_claim_shard(ShardedNumericVector *vector)
+{
+    size_t shard = __atomic_fetch_add(&vector->claimed, 1, __ATOMIC_SEQ_CST);
+
+    if (shard >= vector->shard_count) {
+        logger(ERROR, true, __func__, __LINE__, "All %li shards of ShardedNumericVector: %p are claimed.", vector->shard_count, vector);
+        return NULL;
+    }
+
+    return &vector->shards[shard];
+}
+
+/* For threads which already have a number of their own, e.g., libvector's thread pool chunks. */
+NumericVector *sharded_numeric_vector_get_shard(ShardedNumericVector *vector, size_t shard)
+{
+    if (shard >= vector->shard_count) {
+        logger(ERROR, true, __func__, __LINE__, "There's no such shard: %li in ShardedNumericVector: %p.", shard, vector);
+        return NULL;
+    }
+
+    return &vector->shards[shard];
+}
+
+size_t sharded_numeric_vector_get_size(const ShardedNumericVector *vector)
+{
+    size_t size = 0;
+
+    for (size_t i = 0; i < vector->shard_count; ++i) {
+        size += vector->shards[i].offset;
+    }
+
+    return size;
+}
+
+/* Empties every shard, keeping their capacity, and lets them be claimed again. */
+bool sharded_numeric_vector_clear(ShardedNumericVector *vector)
+{
+    /* Shards keep their capacity, to be filled again, so they aren't cleared with numeric_vector_clear(). */
+    for (size_t i = 0; i < vector->shard_count; ++i) {
+        vector->shards[i].offset = 0;
+
+        if (vector->shards[i].journal != NULL) {
+            numeric_vector_log(&vector->shards[i], VECTOR_JOURNAL_CLEAR, 0, 0);
+        }
+    }
+
+    __atomic_store_n(&vector->claimed, 0, __ATOMIC_SEQ_CST);
+    return true;
+}
+
+/* Makes room in destination for items more numbers, all at once. */
+static bool sharded_numeric_vector_prepare(NumericVector *destination, size_t items, bool initialize)
+{
+    if (initialize) {
+        return numeric_vector_init(destination, items > 0 ? items : DEFAULT_RESIZE_VALUE);
+    }
+
+    if (!numeric_vector_is_valid(destination, __func__, __LINE__, true)) {
+        logger(ERROR, true, __func__, __LINE__, "You told me not to initialize it. Not continuing.");
+        return false;
+    }
+
+    return (destination->offset + items <= destination->capacity
+            || numeric_vector_reserve(destination, destination->offset + items - destination->capacity))
+        && numeric_vector_unshare(destination);
+}
+
+typedef struct {
+    const ShardedNumericVector *source;
+    double *destination;
+    const size_t *first_items; /* shard_count + 1 entries. */
+    size_t total;
+} ShardedNumericVectorMergeJob;
+
+static void sharded_numeric_vector_merge_chunk(void *context, size_t chunk)
+{
+    ShardedNumericVectorMergeJob *job = (ShardedNumericVectorMergeJob *) context;
+    size_t start = chunk * NUMERIC_VECTOR_PARALLEL_CHUNK;
+    size_t end = start + NUMERIC_VECTOR_PARALLEL_CHUNK < job->total ? start + NUMERIC_VECTOR_PARALLEL_CHUNK : job->total;
+
+    for (size_t shard = parallel_source_at(job->first_items, job->source->shard_count, start); start < end; ++shard) {
+        size_t shard_end = job->first_items[shard + 1] < end ? job->first_items[shard + 1] : end;
+
+        memcpy(
+                &job->destination[start],
+                &job->source->shards[shard].data[start - job->first_items[shard]],
+                (shard_end - start) * sizeof(double)
+        );
+
+        start = shard_end;
+    }
+}
+
+/* Appends every shard, in shard order, to destination. destination is resized only once, and
+ * shards are copied by libvector's thread pool. Shards are left untouched.
+ */
+bool sharded_numeric_vector_merge(const ShardedNumericVector *source, NumericVector *destination, bool initialize)
+{
+    size_t total = sharded_numeric_vector_get_size(source);
+
+    logger(INFO, debug, __func__, __LINE__, "Merging %li items of ShardedNumericVector: %p into NumericVector: %p...", total, source, destination);
+
+    if (!sharded_numeric_vector_prepare(destination, total, initialize)) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to make room for %li items in NumericVector: %p.", total, destination);
+        return false;
+    }
+
+    size_t *first_items = (size_t *) malloc((source->shard_count + 1) * sizeof(size_t));
+    if (first_items == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for merging shards. Error code: %i", errno);
+
+        if (initialize) {
+            numeric_vector_free(destination);
+        }
+
+        return false;
+    }
+
+    first_items[0] = 0;
+    for (size_t i = 0; i < source->shard_count; ++i) {
+        first_items[i + 1] = first_items[i] + source->shards[i].offset;
+    }
+
+    ShardedNumericVectorMergeJob job = { source, &destination->data[destination->offset], first_items, total };
+    bool merged = thread_pool_run(sharded_numeric_vector_merge_chunk, &job, (total + NUMERIC_VECTOR_PARALLEL_CHUNK - 1) / NUMERIC_VECTOR_PARALLEL_CHUNK);
+
+    free(first_items);
+
+    if (!merged) {
+        if (initialize) {
+            numeric_vector_free(destination);
+        }
+
+        return false;
+    }
+
+    destination->offset += total;
+
+    if (destination->journal != NULL) {
+        numeric_vector_log(destination, VECTOR_JOURNAL_APPEND, destination->offset - total, total);
+    }
+
+    return true;
+}
+
+/* Min-heap of shard numbers, ordered by their next item. less() breaks ties by shard number, so
+ * ordered merges are stable.
+ */
+typedef bool (*ShardedVectorLess)(const void *source, const size_t *next, size_t one, size_t another);
+
+static void sharded_vector_sift_down(size_t *heap, size_t size, size_t i, ShardedVectorLess less, const void *source, const size_t *next)
+{
+    for (;;) {
+        size_t smallest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+
+        if (left < size && less(source, next, heap[left], heap[smallest])) {
+            smallest = left;
+        }
+
+        if (right < size && less(source, next, heap[right], heap[smallest])) {
+            smallest = right;
+        }
+
+        if (smallest == i) {
+            return;
+        }
+
+        size_t tmp = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+/* Builds the heap out of every non-empty shard. heap and next must hold shard_count entries. */
+static size_t sharded_vector_heap_init(size_t *heap, size_t *next, const size_t *sizes, size_t shard_count,
+        ShardedVectorLess less, const void *source)
+{
+    size_t size = 0;
+
+    for (size_t i = 0; i < shard_count; ++i) {
+        next[i] = 0;
+
+        if (sizes[i] > 0) {
+            heap[size++] = i;
+        }
+    }
+
+    for (size_t i = size / 2; i > 0; --i) {
+        sharded_vector_sift_down(heap, size, i - 1, less, source, next);
+    }
+
+    return size;
+}
+
+/* Takes the next item out of the shard at the top of the heap, and returns that shard. */
+static size_t sharded_vector_heap_pop(size_t *heap, size_t *size, size_t *next, const size_t *sizes,
+        ShardedVectorLess less, const void *source)
+{
+    size_t shard = heap[0];
+
+    if (++next[shard] == sizes[shard]) {
+        heap[0] = heap[--*size];
+    }
+
+    sharded_vector_sift_down(heap, *size, 0, less, source, next);
+    return shard;
+}
+
+static bool sharded_numeric_vector_less(const void *source, const size_t *next, size_t one, size_t another)
+{
+    const NumericVector *shards = ((const ShardedNumericVector *) source)->shards;
+    double a = shards[one].data[next[one]];
+    double b = shards[another].data[next[another]];
+
+    return a < b || (a == b && one < another);
+}
+
+/* Same as sharded_numeric_vector_merge(), but every shard must be sorted in ascending order, and
+ * so will be the merged items. Equal items keep shard order.
+ */
+bool sharded_numeric_vector_merge_sorted(const ShardedNumericVector *source, NumericVector *destination, bool initialize)
+{
+    size_t total = sharded_numeric_vector_get_size(source);
+
+    logger(INFO, debug, __func__, __LINE__, "Merging %li sorted items of ShardedNumericVector: %p into NumericVector: %p...", total, source, destination);
+
+    if (!sharded_numeric_vector_prepare(destination, total, initialize)) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to make room for %li items in NumericVector: %p.", total, destination);
+        return false;
+    }
+
+    size_t count = source->shard_count > 0 ? source->shard_count : 1;
+    size_t *heap = (size_t *) malloc(3 * count * sizeof(size_t));
+
+    if (heap == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for merging shards. Error code: %i", errno);
+
+        if (initialize) {
+            numeric_vector_free(destination);
+        }
+
+        return false;
+    }
+
+    size_t *next = &heap[count];
+    size_t *sizes = &heap[2 * count];
+
+    for (size_t i = 0; i < source->shard_count; ++i) {
+        sizes[i] = source->shards[i].offset;
+    }
+
+    size_t size = sharded_vector_heap_init(heap, next, sizes, source->shard_count, sharded_numeric_vector_less, source);
+    while (size > 0) {
+        size_t shard = heap[0];
+        destination->data[destination->offset++] = source->shards[shard].data[next[shard]];
+        sharded_vector_heap_pop(heap, &size, next, sizes, sharded_numeric_vector_less, source);
+    }
+
+    free(heap);
+
+    if (destination->journal != NULL) {
+        numeric_vector_log(destination, VECTOR_JOURNAL_APPEND, destination->offset - total, total);
+    }
+
+    return true;
+}
+
+bool sharded_string_vector_init(ShardedStringVector *vector, size_t shards, size_t initial_size)
+{
+    logger(INFO, debug, __func__, __LINE__, "Initializing ShardedStringVector: %p with %li shards...", vector, shards);
+
+    vector->shards = (StringVector *) calloc(shards > 0 ? shards : 1, sizeof(StringVector));
+    vector->shard_count = 0;
+    vector->claimed = 0;
+
+    if (vector->shards == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for %li shards. Error code: %i", shards, errno);
+        return false;
+    }
+
+    for (; vector->shard_count < shards; ++vector->shard_count) {
+        if (!string_vector_init(&vector->shards[vector->shard_count], initial_size > 0 ? initial_size : DEFAULT_RESIZE_VALUE)) {
+            sharded_string_vector_free(vector);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void sharded_string_vector_free(ShardedStringVector *vector)
+{
+    logger(INFO, debug, __func__, __LINE__, "Freeing ShardedStringVector: %p...", vector);
+
+    for (size_t i = 0; i < vector->shard_count; ++i) {
+        string_vector_free(&vector->shards[i]);
+    }
+
+    free(vector->shards);
+    vector->shards = NULL;
+    vector->shard_count = 0;
+}
+
+StringVector *sharded_string_vector_claim_shard(ShardedStringVector *vector)
+{
+    size_t shard = __atomic_fetch_add(&vector->claimed, 1, __ATOMIC_SEQ_CST);
+
+    if (shard >= vector->shard_count) {
+        logger(ERROR, true, __func__, __LINE__, "All %li shards of ShardedStringVector: %p are claimed.", vector->shard_count, vector);
+        return NULL;
+    }
+
+    return &vector->shards[shard];
+}
+
+StringVector *sharded_string_vector_get_shard(ShardedStringVector *vector, size_t shard)
+{
+    if (shard >= vector->shard_count) {
+        logger(ERROR, true, __func__, __LINE__, "There's no such shard: %li in ShardedStringVector: %p.", shard, vector);
+        return NULL;
+    }
+
+    return &vector->shards[shard];
+}
+
+size_t sharded_string_vector_get_size(const ShardedStringVector *vector)
+{
+    size_t size = 0;
+
+    for (size_t i = 0; i < vector->shard_count; ++i) {
+        size += vector->shards[i].offset;
+    }
+
+    return size;
+}
+
+bool sharded_string_vector_clear(ShardedStringVector *vector)
+{
+    for (size_t i = 0; i < vector->shard_count; ++i) {
+        if (!string_vector_clear(&vector->shards[i])) {
+            return false;
+        }
+    }
+
+    __atomic_store_n(&vector->claimed, 0, __ATOMIC_SEQ_CST);
+    return true;
+}
+
+static bool sharded_string_vector_prepare(StringVector *destination, size_t items, bool initialize)
+{
+    if (initialize) {
+        return string_vector_init(destination, items > 0 ? items : DEFAULT_RESIZE_VALUE);
+    }
+
+    if (!string_vector_is_valid(destination, __func__, __LINE__, true)) {
+        logger(ERROR, true, __func__, __LINE__, "You told me not to initialize it. Not continuing.");
+        return false;
+    }
+
+    return string_vector_unshare(destination)
+        && (destination->offset + items <= destination->capacity
+            || string_vector_reserve(destination, destination->offset + items - destination->capacity));
+}
+
+/* Same as sharded_numeric_vector_merge(). Every chunk of items is copied with a single allocation. */
+bool sharded_string_vector_merge(const ShardedStringVector *source, StringVector *destination, bool initialize)
+{
+    size_t total = sharded_string_vector_get_size(source);
+
+    logger(INFO, debug, __func__, __LINE__, "Merging %li items of ShardedStringVector: %p into StringVector: %p...", total, source, destination);
+
+    if (!sharded_string_vector_prepare(destination, total, initialize)
+        || !string_vector_parallel_copy_sources(source->shards, source->shard_count, destination))
+    {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to merge ShardedStringVector: %p into StringVector: %p.", source, destination);
+
+        if (initialize && destination->data != NULL) {
+            string_vector_free(destination);
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool sharded_string_vector_less(const void *source, const size_t *next, size_t one, size_t another)
+{
+    const StringVector *shards = ((const ShardedStringVector *) source)->shards;
+    int comparison = strcmp(shards[one].data[next[one]], shards[another].data[next[another]]);
+
+    return comparison < 0 || (comparison == 0 && one < another);
+}
+
+/* Same as sharded_numeric_vector_merge_sorted(), for shards sorted like string_vector_sort() does.
+ * Merged items are copied into a single allocation.
+ */
+bool sharded_string_vector_merge_sorted(const ShardedStringVector *source, StringVector *destination, bool initialize)
+{
+    size_t total = sharded_string_vector_get_size(source);
+
+    logger(INFO, debug, __func__, __LINE__, "Merging %li sorted items of ShardedStringVector: %p into StringVector: %p...", total, source, destination);
+
+    if (!sharded_string_vector_prepare(destination, total, initialize)) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to make room for %li items in StringVector: %p.", total, destination);
+        return false;
+    }
+
+    if (total == 0) {
+        return true;
+    }
+
+    size_t count = source->shard_count;
+    size_t *heap = (size_t *) malloc(3 * count * sizeof(size_t));
+    const char **values = (const char **) malloc(total * sizeof(char *));
+
+    if (heap == NULL || values == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for merging shards. Error code: %i", errno);
+        free(heap);
+        free(values);
+
+        if (initialize) {
+            string_vector_free(destination);
+        }
+
+        return false;
+    }
+
+    size_t *next = &heap[count];
+    size_t *sizes = &heap[2 * count];
+    size_t bytes = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        sizes[i] = source->shards[i].offset;
+    }
+
+    /* Merged order is worked out first, so string_vector_add_batch() copies everything at once. */
+    size_t size = sharded_vector_heap_init(heap, next, sizes, count, sharded_string_vector_less, source);
+    for (size_t i = 0; size > 0; ++i) {
+        const StringVector *shard = &source->shards[heap[0]];
+
+        values[i] = shard->data[next[heap[0]]];
+        destination->item_sizes[destination->offset + i] = shard->item_sizes[next[heap[0]]] - 1;
+        bytes += shard->item_sizes[next[heap[0]]];
+        sharded_vector_heap_pop(heap, &size, next, sizes, sharded_string_vector_less, source);
+    }
+
+    bool merged = string_vector_add_batch(destination, values, total, bytes);
+
+    free(heap);
+    free(values);
+
+    if (!merged && initialize) {
+        string_vector_free(destination);
+    }
+
+    return merged;
+}
+
+static bool string_gap_vector_is_valid(const StringGapVector *vector, const char *func, int line, bool show_suggestions)
+{
+    char suggestion[] = "Please call string_gap_vector_init() before using this function.";
+
+    if (vector->data == NULL) {
+        logger(
+                ERROR, true, func, line,
+                "StringGapVector: %p isn't properly initialized.%s",
+                vector,
+                (show_suggestions ? suggestion : "")
+        );
+
+        return false;
+    }
+
+    return true;
+}
+
+/* Number of physical slots currently belonging to the gap. */
+static size_t string_gap_vector_gap_size(const StringGapVector *vector)
+{
+    return vector->gap_end - vector->gap_start;
+}
+
+/* Translates a logical position into the physical slot holding that item. */
+static size_t string_gap_vector_slot(const StringGapVector *vector, size_t position)
+{
+    return position < vector->gap_start ? position : position + string_gap_vector_gap_size(vector);
+}
+
+bool string_gap_vector_init(StringGapVector *vector, size_t initial_size)
+{
+    logger(INFO, debug, __func__, __LINE__, "Initializing StringGapVector with capacity to hold %li strings.", initial_size);
+
+    vector->data = (char **) malloc(initial_size * sizeof(char *));
+    if (vector->data == NULL) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "Impossible to initialize StringGapVector with size: %li. Error code: %i",
+                initial_size, errno
+        );
+
+        return false;
+    }
+
+    vector->item_sizes = (size_t *) malloc(initial_size * sizeof(size_t));
+    if (vector->item_sizes == NULL) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "Impossible to allocate memory for StringGapVector. Error code: %i",
+                errno
+        );
+
+        free(vector->data);
+        vector->data = NULL;
+        return false;
+    }
+
+    vector->capacity = initial_size;
+    vector->offset = 0;
+    vector->gap_start = 0;
+    vector->gap_end = initial_size;
+
+    logger(INFO, debug, __func__, __LINE__, "StringGapVector: %p initialized with %li spaces.", vector, initial_size);
+
+    return true;
+}
+
+void string_gap_vector_free(StringGapVector *vector)
+{
+    logger(INFO, debug, __func__, __LINE__, "Freeing StringGapVector: %p...", vector);
+
+    if (vector->data != NULL) {
+        for (size_t i = 0; i < vector->offset; ++i) {
+            free(vector->data[string_gap_vector_slot(vector, i)]);
+        }
+
+        free(vector->data);
+        vector->data = NULL;
+    }
+
+    if (vector->item_sizes != NULL) {
+        free(vector->item_sizes);
+        vector->item_sizes = NULL;
+    }
+
+    vector->capacity = 0;
+    vector->offset = 0;
+    vector->gap_start = 0;
+    vector->gap_end = 0;
+
+    logger(INFO, debug, __func__, __LINE__, "StringGapVector: %p freed.", vector);
+}
+
+/* Grows the gap so that it can hold at least one more item.
+ * Capacity is doubled (or increased by DEFAULT_RESIZE_VALUE for small vectors), so that
+ * successive insertions are amortized O(1). Only the slot arrays are reallocated, the strings
+ * themselves keep their addresses.
+ */
+static bool string_gap_vector_grow(StringGapVector *vector)
+{
+    size_t spaces = vector->capacity < DEFAULT_RESIZE_VALUE ? DEFAULT_RESIZE_VALUE : vector->capacity;
+    size_t new_capacity = vector->capacity + spaces;
+    size_t tail = vector->capacity - vector->gap_end;
+
+    logger(
+            INFO, debug, __func__, __LINE__,
+            "Growing StringGapVector: %p... Old capacity: %li, new capacity: %li",
+            vector, vector->capacity, new_capacity
+    );
+
+    char **data = (char **) realloc(vector->data, new_capacity * sizeof(char *));
+    if (data == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to grow StringGapVector: %p. Error code: %i", vector, errno);
+        return false;
     }
+    vector->data = data;
 
-    size_t i;
-    for (i = 0; i < n; ++i) {
-        if (!string_vector_add(vector, values[i])) {
-            logger(
-                    ERROR, true, __func__, __LINE__,
-                    "Impossible to add value: %s to vector: %p. Not continuing.",
-                    values[i], vector
-            );
-            break;
-        }
+    size_t *item_sizes = (size_t *) realloc(vector->item_sizes, new_capacity * sizeof(size_t));
+    if (item_sizes == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to grow StringGapVector: %p. Error code: %i", vector, errno);
+        return false;
     }
+    vector->item_sizes = item_sizes;
 
-    logger(INFO, debug, __func__, __LINE__, "%li new values added to vector: %p.", i, vector);
+    /* Items after the gap go to the end of the new buffer, widening the gap. */
+    memmove(&vector->data[new_capacity - tail], &vector->data[vector->gap_end], tail * sizeof(char *));
+    memmove(&vector->item_sizes[new_capacity - tail], &vector->item_sizes[vector->gap_end], tail * sizeof(size_t));
 
-    return i == n;
+    vector->gap_end = new_capacity - tail;
+    vector->capacity = new_capacity;
+    return true;
 }
 
-bool string_vector_reserve(StringVector *vector, size_t spaces)
+bool string_gap_vector_move_cursor(StringGapVector *vector, size_t position)
 {
-    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+    if (!string_gap_vector_is_valid(vector, __func__, __LINE__, true)) {
         return false;
     }
 
-    size_t old_capacity = vector->capacity;
-    size_t new_capacity = old_capacity + spaces;
-    StringVector new_vector = {0};
-
-    logger(
-            INFO, debug, __func__, __LINE__,
-            "Reserving %li more spaces for vector: %p... Old capacity: %li, new capacity: %li",
-            spaces, vector, old_capacity, new_capacity
-    );
+    if (position > vector->offset) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "StringGapVector: %p only holds %li items. Can't move cursor to position: %li.",
+                vector, vector->offset, position
+        );
 
-    if (!string_vector_init(&new_vector, new_capacity)) {
-        logger(ERROR, true, __func__, __LINE__, "Impossible to reserve %li more spaces for vector: %p.", spaces, vector);
         return false;
     }
 
-    logger(INFO, debug, __func__, __LINE__, "Saving old StringVector items into new StringVector...");
+    if (position < vector->gap_start) {
+        /* Shift the items between position and the gap to the right side of the gap. */
+        size_t n = vector->gap_start - position;
+        memmove(&vector->data[vector->gap_end - n], &vector->data[position], n * sizeof(char *));
+        memmove(&vector->item_sizes[vector->gap_end - n], &vector->item_sizes[position], n * sizeof(size_t));
+        vector->gap_start -= n;
+        vector->gap_end -= n;
+    } else if (position > vector->gap_start) {
+        /* Shift the items between the gap and position to the left side of the gap. */
+        size_t n = position - vector->gap_start;
+        memmove(&vector->data[vector->gap_start], &vector->data[vector->gap_end], n * sizeof(char *));
+        memmove(&vector->item_sizes[vector->gap_start], &vector->item_sizes[vector->gap_end], n * sizeof(size_t));
+        vector->gap_start += n;
+        vector->gap_end += n;
+    }
 
-    for (size_t i = 0; i < vector->offset; ++i) {
-        size_t size = vector->item_sizes[i];
+    logger(INFO, debug, __func__, __LINE__, "StringGapVector: %p cursor moved to position: %li.", vector, position);
+    return true;
+}
 
-        logger(INFO, debug, __func__, __LINE__, "Allocating memory for StringVector item: %s...", vector->data[i]);
-        new_vector.data[i] = (char *) malloc(size * sizeof(char));
+bool string_gap_vector_insert(StringGapVector *vector, const char *value, size_t position)
+{
+    logger(
+            INFO, debug, __func__, __LINE__,
+            "Inserting new value: %s into StringGapVector: %p at position: %li...",
+            value, vector, position
+    );
 
-        if (!new_vector.data[i]) {
-            logger(
-                    INFO, true, __func__, __LINE__,
-                    "Impossible to allocate memory for StringVector item: %s! Error code: %i. Leaving old StringVector as it was received.",
-                    vector->data[i], errno
-            );
+    if (!string_gap_vector_is_valid(vector, __func__, __LINE__, false)) {
+        logger(WARN, debug, __func__, __LINE__, "Initializing it with the default size value: %i.",
+                DEFAULT_RESIZE_VALUE);
 
-            string_vector_free(&new_vector);
+        if (!string_gap_vector_init(vector, DEFAULT_RESIZE_VALUE)) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to initialize StringGapVector. Not continuing.");
             return false;
         }
+    }
+
+    if (position > vector->offset) {
+        logger(
+                WARN, debug, __func__, __LINE__,
+                "StringGapVector: %p doesn't have at least %li elements. Just adding at position: %li...",
+                vector, position, vector->offset
+        );
 
-        logger(INFO, debug, __func__, __LINE__, "Memory allocated. Copying StringVector item: %s...", vector->data[i]);
+        position = vector->offset;
+    }
 
-        string_vector_copy_item(vector->data[i], new_vector.data[i], size - 1); // vector->item_sizes[i] has 1 more because of \0
-        new_vector.item_sizes[i] = size;
-        ++new_vector.offset;
+    size_t size = string_vector_item_strlen(value);
+    char *item = (char *) malloc((size + 1) * sizeof(char));
+
+    if (item == NULL) {
+        logger(
+                ERROR, true, __func__, __LINE__,
+                "Impossible to allocate memory for string value: %s. Error code: %i",
+                value, errno
+        );
+
+        return false;
+    }
 
-        logger(INFO, debug, __func__, __LINE__, "StringVector item: %s copied.", vector->data[i]);
+    string_vector_copy_item(value, item, size);
+
+    if (!string_gap_vector_move_cursor(vector, position)
+        || (string_gap_vector_gap_size(vector) == 0 && !string_gap_vector_grow(vector)))
+    {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to insert value: %s. Not continuing.", value);
+        free(item);
+        return false;
     }
 
+    vector->data[vector->gap_start] = item;
+    vector->item_sizes[vector->gap_start] = size + 1;
+    ++vector->gap_start;
+    ++vector->offset;
+
     logger(
             INFO, debug, __func__, __LINE__,
-            "Freeing old StringVector: %p, and pointing to new StringVector: %p",
-            vector, &new_vector
+            "Value: %s inserted into StringGapVector: %p at position: %li.",
+            value, vector, position
     );
 
-    string_vector_free(vector);
-    vector->data = new_vector.data;
-    vector->item_sizes = new_vector.item_sizes;
-    vector->capacity = new_vector.capacity;
-    vector->offset = new_vector.offset;
     return true;
 }
 
-bool string_vector_shrink_to_fit(StringVector *vector)
+bool string_gap_vector_add(StringGapVector *vector, const char *value)
 {
-    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
-        return false;
-    }
+    return string_gap_vector_insert(vector, value, vector->data == NULL ? 0 : vector->offset);
+}
 
-    if (vector->capacity == vector->offset) {
-        logger(WARN, debug, __func__, __LINE__, "No need to shrink vector: %p.", vector);
-        return true;
+bool string_gap_vector_erase(StringGapVector *vector, size_t start, size_t length)
+{
+    if (!string_gap_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
     }
 
-    logger(
-            INFO, debug, __func__, __LINE__,
-            "Shrinking StringVector: %p... Current capacity: %li, New capacity: %li",
-            vector, vector->capacity, vector->offset
-    );
-
-    size_t new_capacity = vector->offset;
-    StringVector new_vector = {0};
-    if (!string_vector_init(&new_vector, new_capacity)) {
+    if (start >= vector->offset) {
         logger(
                 ERROR, true, __func__, __LINE__,
-                "Impossible to shrink vector: %p. Leaving original vector as it was received."
+                "StringGapVector: %p doesn't have %li items. There's nothing to erase.",
+                vector, start
         );
+
         return false;
     }
 
-    for (size_t i = 0; i < new_capacity; ++i) {
-        logger(INFO, debug, __func__, __LINE__, "Backing up StringVector item: %s...", vector->data[i]);
-        size_t item_size = vector->item_sizes[i];
-        new_vector.data[i] = (char *) malloc(item_size * sizeof(char)); /* item_sizes[i] already takes in account the \0 character. See string_vector_init() */
-
-        if (new_vector.data[i] == NULL) {
-            logger(
-                    ERROR, true, __func__, __LINE__,
-                    "Impossible to backup StringVector item: %s. Error code: %i. Leaving original vector as it was received.",
-                    vector->data[i], errno
-            );
-
-            string_vector_free(&new_vector);
-            return false;
-        }
+    if (length > vector->offset - start) {
+        length = vector->offset - start;
+    }
 
-        new_vector.item_sizes[i] = item_size;
-        string_vector_copy_item(vector->data[i], new_vector.data[i], item_size - 1); /* item_sizes[i] has 1 more space for the \0 character. */
-        ++new_vector.offset;
+    if (!string_gap_vector_move_cursor(vector, start)) {
+        return false;
+    }
 
-        logger(INFO, debug, __func__, __LINE__, "StringVector item: %s backed up.", vector->data[i]);
+    /* Items right after the cursor are swallowed by the gap. */
+    for (size_t i = 0; i < length; ++i) {
+        free(vector->data[vector->gap_end]);
+        ++vector->gap_end;
     }
 
+    vector->offset -= length;
+
     logger(
             INFO, debug, __func__, __LINE__,
-            "All items in StringVector: %p were backed up. Freeing original vector and making it point to the new one.",
-            vector
+            "%li %s erased from StringGapVector: %p.",
+            length, (length == 1 ? "item was" : "items were"), vector
     );
 
-    string_vector_free(vector);
-    vector->data = new_vector.data;
-    vector->item_sizes = new_vector.item_sizes;
-    vector->capacity = new_vector.capacity;
-    vector->offset = new_vector.offset;
-
-    logger(INFO, debug, __func__, __LINE__, "StringVector: %p shrinked. New capacity is: %li.", vector, vector->capacity);
     return true;
 }
 
-bool string_vector_clear(StringVector *vector)
+bool string_gap_vector_replace(StringGapVector *vector, size_t position, const char *new_value)
 {
-    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+    if (!string_gap_vector_is_valid(vector, __func__, __LINE__, true)) {
         return false;
     }
 
-    size_t capacity = vector->capacity;
-    string_vector_free(vector);
-
-    if (!string_vector_init(vector, capacity)) {
+    if (position >= vector->offset) {
         logger(
-                WARN, true, __func__, __LINE__,
-                "StringVector: %p was cleared, but it wasn't possible to re-initialize. It shouldn't be used until properly initialized.",
-                vector
+                ERROR, true, __func__, __LINE__,
+                "There's no such StringGapVector item at position: %li.",
+                position
         );
-    }
 
-    return true;
-}
-
-bool string_vector_copy(const StringVector *source, StringVector *destination, bool initialize)
-{
-    if (!string_vector_is_valid(source, __func__, __LINE__, true)) {
         return false;
     }
 
-    StringVector copy = {0};
-
-    if (initialize) {
-        if (!string_vector_init(&copy, source->capacity)) {
-            logger(
-                    ERROR, true, __func__, __LINE__,
-                    "Impossible to initialize StringVector: %p. Not continuing.",
-                    destination
-            );
+    size_t size = string_vector_item_strlen(new_value) + 1;
+    char *value = (char *) malloc(size * sizeof(char));
 
-            return false;
-        }
-    } else if (!string_vector_is_valid(destination, __func__, __LINE__, false)) {
+    if (value == NULL) {
         logger(
                 ERROR, true, __func__, __LINE__,
-                "You told me not to initialize it. Not continuing."
+                "Couldn't reserve memory to hold new StringGapVector item: %s. Can't continue.",
+                new_value
         );
 
         return false;
     }
 
-    if (initialize == false && (source->offset + destination->offset > destination->capacity)) {
-        logger(
-                INFO, debug, __func__, __LINE__,
-                "Copying StringVector: %p values into initialized StringVector: %p makes this last one to be resized.",
-                source, destination
-        );
-
-        /* Initialize temporal StringVector to hold both destination and source's values. */
-        if (!string_vector_init(&copy, destination->capacity + source->offset)) {
-            logger(
-                    ERROR, true, __func__, __LINE__,
-                    "Impossible to reserve memory to make copy of StringVector: %p into StringVector: %p.",
-                    source, destination
-            );
-
-            return false;
-        }
-
-        logger(INFO, debug, __func__, __LINE__, "Backing up StringVector: %p's values...", destination);
-        for (size_t i = 0; i < destination->offset; ++i) {
-            const char *item = destination->data[i];
-            logger(INFO, debug, __func__, __LINE__, "Backing up StringVector item #%li: %s...", i, item);
+    size_t slot = string_gap_vector_slot(vector, position);
+    string_vector_copy_item(new_value, value, size - 1);
+    free(vector->data[slot]);
+    vector->data[slot] = value;
+    vector->item_sizes[slot] = size;
+    return true;
+}
 
-            size_t size = destination->item_sizes[i];
-            copy.item_sizes[i] = size;
-            copy.data[i] = (char *) malloc(size);
+size_t string_gap_vector_get_capacity(const StringGapVector *vector)
+{
+    if (!string_gap_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return 0;
+    }
 
-            if (copy.data[i] == NULL) {
-                logger(
-                        ERROR, true, __func__, __LINE__,
-                        "Impossible to back up StringVector #%li: %s. Leaving original StringVector as it was received.",
-                        i, item
-                );
+    return vector->capacity;
+}
 
-                string_vector_free(&copy);
-                return false;
-            }
+/* string_gap_vector_get_* set of functions return NULL on failure, e.g., position >= vector bounds. */
+const char *string_gap_vector_get_first(const StringGapVector *vector)
+{
+    return string_gap_vector_get_at(vector, 0);
+}
 
-            string_vector_copy_item(item, copy.data[i], size - 1); /* Just copy the items themselves, last byte will be for \0. */
-            ++copy.offset;
-        }
+const char *string_gap_vector_get_at(const StringGapVector *vector, size_t position)
+{
+    if (!string_gap_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return NULL;
     }
 
-    logger(
-            INFO, debug, __func__, __LINE__,
-            "Copying StringVector: %p's values into StringVector: %p...",
-            source, destination
-    );
-
-    for (size_t i = 0; i < source->offset; ++i) {
-        size_t size = source->item_sizes[i];
-        const char *item = source->data[i];
-        copy.item_sizes[i] = size;
-
+    if (position >= vector->offset) {
         logger(
-                INFO, debug, __func__, __LINE__,
-                "Reserving %li bytes to make copy of StringVector item #%li: %s...",
-                (size - 1), i, item
+                ERROR, true, __func__, __LINE__,
+                "StringGapVector: %p doesn't have any value on position: %li.",
+                vector, position
         );
 
-        copy.data[copy.offset] = (char *) malloc(size);
-        if (copy.data[copy.offset] == NULL) {
-            logger(
-                    ERROR, true, __func__, __LINE__,
-                    "Impossible to reserve memory for StringVector item #%li: %s. Leaving original StringVector as it was received.",
-                    i, item
-            );
-
-            string_vector_free(&copy);
-            return false;
-        }
-
-        string_vector_copy_item(item, copy.data[copy.offset], size - 1); /* Just copy the items themselves, last byte will be for \0. */
-        ++copy.offset;
-    }
-
-    if (initialize == false) {
-        string_vector_free(destination);
+        return NULL;
     }
 
-    destination->data = copy.data;
-    destination->capacity = copy.capacity;
-    destination->item_sizes = copy.item_sizes;
-    destination->offset = copy.offset;
-
-    logger(INFO, debug, __func__, __LINE__, "StringVector: %p's values copied into StringVector: %p.", source, destination);
-    return true;
+    return vector->data[string_gap_vector_slot(vector, position)];
 }
 
-bool string_vector_insert(StringVector *vector, const char *value, size_t position)
+const char *string_gap_vector_get_last(const StringGapVector *vector)
 {
-    logger(
-            INFO, debug, __func__, __LINE__,
-            "Inserting new value: %s into StringVector: %p at position: %li...",
-            value, vector, position
-    );
+    return string_gap_vector_get_at(vector, vector->offset - 1);
+}
 
-    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
-        return false;
+size_t string_gap_vector_strlen(const StringGapVector *vector, size_t position)
+{
+    if (!string_gap_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return 0;
     }
 
     if (position >= vector->offset) {
         logger(
                 WARN, debug, __func__, __LINE__,
-                "StringVector: %p doesn't have at least %li elements. Just adding at position: %li...",
-                vector, position, vector->offset
+                "StringGapVector: %p doesn't have any value on position: %li.",
+                vector, position
         );
 
-        return string_vector_add(vector, value);
+        return 0;
     }
 
-    StringVector tmp = {0};
+    return vector->item_sizes[string_gap_vector_slot(vector, position)] - 1;
+}
 
-    if (vector->offset + 1 > vector->capacity) {
-        logger(
-                INFO, debug, __func__, __LINE__,
-                "Inserting new value makes StringVector to be resized. Reserving %i more spaces...",
-                DEFAULT_RESIZE_VALUE
-        );
+/* Copies every item, in logical order, into destination. See string_vector_copy() for initialize's meaning. */
+bool string_gap_vector_to_string_vector(const StringGapVector *source, StringVector *destination, bool initialize)
+{
+    if (!string_gap_vector_is_valid(source, __func__, __LINE__, true)) {
+        return false;
+    }
 
-        if (!string_vector_init(&tmp, vector->capacity + DEFAULT_RESIZE_VALUE)) {
+    if (initialize) {
+        if (!string_vector_init(destination, source->offset)) {
             logger(
                     ERROR, true, __func__, __LINE__,
-                    "Impossible to reserve %i more spaces. Leaving original StringVector as it was received.",
-                    DEFAULT_RESIZE_VALUE
+                    "Impossible to initialize StringVector: %p. Not continuing.",
+                    destination
             );
 
             return false;
         }
-    } else {
-        if (!string_vector_init(&tmp, vector->capacity)) {
+    } else if (!string_vector_is_valid(destination, __func__, __LINE__, false)) {
+        logger(ERROR, true, __func__, __LINE__, "You told me not to initialize it. Not continuing.");
+        return false;
+    }
+
+    if (destination->offset + source->offset > destination->capacity
+        && !string_vector_reserve(destination, destination->offset + source->offset - destination->capacity))
+    {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to resize StringVector: %p. Not continuing.", destination);
+        return false;
+    }
+
+    for (size_t i = 0; i < source->offset; ++i) {
+        if (!string_vector_add(destination, string_gap_vector_get_at(source, i))) {
             logger(
                     ERROR, true, __func__, __LINE__,
-                    "Impossible to back up StringVector: %p. Leaving it untouched.",
-                    vector
+                    "Impossible to copy StringGapVector item #%li into StringVector: %p. Not continuing.",
+                    i, destination
             );
 
             return false;
         }
     }
 
-    size_t j = 0; // j will be used to iterate over vector. i will be used to iterate over tmp.
-    for (size_t i = 0; i <= vector->offset; ++i) {
-        const char *to_copy = NULL;
-
-        if (i == position) {
-            size_t length = string_vector_item_strlen(value) + 1;
-            tmp.item_sizes[i] = length;
-            tmp.data[i] = (char *) malloc(length * sizeof(char));
-
-            if (tmp.data[i] == NULL) {
-                logger(
-                        ERROR, true, __func__, __LINE__,
-                        "Couldn't reserve memory for StringVector item: %s. Leaving original StringVector as it was received. Error code: %i",
-                        value, errno
-                );
+    return true;
+}
 
-                string_vector_free(&tmp);
-                return false;
-            }
+void string_gap_vector_print(const StringGapVector *vector)
+{
+    if (!string_gap_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return;
+    }
 
-            to_copy = value;
-        } else {
-            size_t length = vector->item_sizes[j];
-            tmp.item_sizes[i] = length;
-            tmp.data[i] = (char *) malloc(length); // item_sizes[i] already takes in account the \0 character.
-
-            if (tmp.data[i] == NULL) {
-                logger(
-                        ERROR, true, __func__, __LINE__,
-                        "Couldn't reserve memory for StringVector item: %s. Leaving original StringVector as it was received. Error code: %i",
-                        vector->data[j], errno
-                );
-
-                string_vector_free(&tmp);
-                return false;
-            }
+    for (size_t i = 0; i < vector->offset; ++i) {
+        printf("%s%s",
+                string_gap_vector_get_at(vector, i),
+                (i < vector->offset - 1 ? ", " : "\n"));
+    }
 
-            to_copy = vector->data[j];
-            ++j;
-        }
+    printf("StringGapVector capacity: %li\n", vector->capacity);
+    printf("StringGapVector items: %li\n", vector->offset);
+    printf("StringGapVector cursor: %li\n", vector->gap_start);
+}
 
-        string_vector_copy_item(to_copy, tmp.data[i], tmp.item_sizes[i] - 1);
-        ++tmp.offset;
-    }
+static bool string_view_vector_is_valid(const StringViewVector *vector, const char *func, int line, bool show_suggestions)
+{
+    char suggestion[] = "Please call string_view_vector_init() before using this function.";
 
-    string_vector_free(vector);
-    vector->data = tmp.data;
-    vector->item_sizes = tmp.item_sizes;
-    vector->capacity = tmp.capacity;
-    vector->offset = tmp.offset;
+    if (vector->data == NULL) {
+        logger(
+                ERROR, true, func, line,
+                "StringViewVector: %p isn't properly initialized.%s",
+                vector,
+                (show_suggestions ? suggestion : "")
+        );
 
-    logger(
-            INFO, debug, __func__, __LINE__,
-            "Value: %s inserted into StringVector: %p at position: %li.",
-            value, vector, position
-    );
+        return false;
+    }
 
     return true;
 }
 
-bool string_vector_replace(StringVector *vector, size_t position, const char *new_value)
+bool string_view_vector_init(StringViewVector *vector, size_t initial_size)
 {
-    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
-        return false;
-    }
+    logger(INFO, debug, __func__, __LINE__, "Initializing StringViewVector with capacity to hold %li views.", initial_size);
 
-    if (position >= vector->offset) {
+    vector->data = (const char **) malloc(initial_size * sizeof(char *));
+    if (vector->data == NULL) {
         logger(
                 ERROR, true, __func__, __LINE__,
-                "There's no such StringVector item at position: %li.",
-                position
+                "Impossible to initialize StringViewVector with size: %li. Error code: %i",
+                initial_size, errno
         );
 
         return false;
     }
 
-    size_t size = string_vector_item_strlen(new_value) + 1;
-
-    logger(
-            INFO, debug, __func__, __LINE__,
-            "Reserving %li bytes of memory to copy: %s into StringVector position: %li, replacing: %s.",
-            size, new_value, position, vector->data[position]
-    );
-
-    char *value = (char *) malloc(size * sizeof(char));
-
-    if (value == NULL) {
+    vector->item_sizes = (size_t *) malloc(initial_size * sizeof(size_t));
+    if (vector->item_sizes == NULL) {
         logger(
                 ERROR, true, __func__, __LINE__,
-                "Couldn't reserve memory to hold new StringVector item: %s. Can't continue.",
-                new_value
+                "Impossible to allocate memory for StringViewVector. Error code: %i",
+                errno
         );
 
+        free(vector->data);
+        vector->data = NULL;
         return false;
     }
 
-    char *old_value = vector->data[position];
-    string_vector_copy_item(new_value, value, size - 1);
-    vector->data[position] = value; /* Just make that pointer point to the new memory address. */
-    vector->item_sizes[position] = size;
-
-    logger(
-            INFO, debug, __func__, __LINE__,
-            "StringVector item: %s replaced by %s. Freeing replaced StringVector item allocated memory...",
-            old_value, value
-    );
+    vector->capacity = initial_size;
+    vector->offset = 0;
+    vector->mapped = NULL;
+    vector->mapped_size = 0;
 
-    free(old_value);
+    logger(INFO, debug, __func__, __LINE__, "StringViewVector: %p initialized with %li spaces.", vector, initial_size);
     return true;
 }
 
-bool string_vector_erase(StringVector *vector, size_t start, size_t length)
+/* Only the views are freed. The buffer they point into still belongs to the caller. */
+void string_view_vector_free(StringViewVector *vector)
 {
-    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
-        return false;
+    logger(INFO, debug, __func__, __LINE__, "Freeing StringViewVector: %p...", vector);
+
+    if (vector->mapped != NULL) {
+        munmap((void *) vector->mapped, vector->mapped_size);
     }
 
-    if (start >= vector->offset) {
-        logger(
-                ERROR, true, __func__, __LINE__,
-                "StringVector: %p doesn't have %li items. There's nothing to erase.",
-                vector, start
-        );
+    free(vector->data);
+    free(vector->item_sizes);
+    vector->data = NULL;
+    vector->item_sizes = NULL;
+    vector->capacity = 0;
+    vector->offset = 0;
+    vector->mapped = NULL;
+    vector->mapped_size = 0;
 
-        return false;
-    }
+    logger(INFO, debug, __func__, __LINE__, "StringViewVector: %p freed.", vector);
+}
 
-    if (length >= vector->offset) {
-        length = 1;
+bool string_view_vector_reserve(StringViewVector *vector, size_t spaces)
+{
+    if (!string_view_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return false;
     }
 
-    const char *item_text = length == 1 ? "item" : "items";
+    size_t new_capacity = vector->capacity + spaces;
+    size_t slots = new_capacity > 0 ? new_capacity : 1;
 
     logger(
             INFO, debug, __func__, __LINE__,
-            "Erasing %li StringVector %s, starting from %li...",
-            length, item_text, start
+            "Reserving %li more spaces for StringViewVector: %p... Old capacity: %li, new capacity: %li",
+            spaces, vector, vector->capacity, new_capacity
     );
 
-    size_t new_capacity = vector->capacity - length;
-    StringVector tmp = {0};
-    if (!string_vector_init(&tmp, new_capacity)) {
-        logger(
-                ERROR, true, __func__, __LINE__,
-                "Couldn't back up StringVector: %p's items. Can't proceed.",
-                vector
-        );
-
+    const char **data = (const char **) realloc(vector->data, slots * sizeof(char *));
+    if (data == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to reserve %li more spaces for StringViewVector: %p.", spaces, vector);
         return false;
     }
+    vector->data = data;
 
-    /* Just back up items that won't be erased. */
-    for (size_t i = 0, j = 0; i < vector->offset; ++i) {
-        size_t copy_after = abs(j - (i + 1));
-
-        if (i < start || copy_after > length) {
-            const char *item = vector->data[i];
-            tmp.data[j] = (char *) malloc(vector->item_sizes[i]);
-
-            if (tmp.data[j] == NULL) {
-                logger(
-                        ERROR, true, __func__, __LINE__,
-                        "Impossible to back up StringVector item: %s. Can't proceed.",
-                        item
-                );
+    size_t *item_sizes = (size_t *) realloc(vector->item_sizes, slots * sizeof(size_t));
+    if (item_sizes == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to reserve %li more spaces for StringViewVector: %p.", spaces, vector);
+        return false;
+    }
+    vector->item_sizes = item_sizes;
 
-                string_vector_free(&tmp);
-                return false;
-            }
+    vector->capacity = new_capacity;
+    return true;
+}
 
-            string_vector_copy_item(item, tmp.data[j], vector->item_sizes[i] - 1);
-            tmp.item_sizes[j] = vector->item_sizes[i];
-            ++tmp.offset;
-            ++j;
+/* Adds a view of the first length bytes of value. value isn't copied, so it must outlive vector. */
+bool string_view_vector_add(StringViewVector *vector, const char *value, size_t length)
+{
+    if (!string_view_vector_is_valid(vector, __func__, __LINE__, false)) {
+        logger(WARN, debug, __func__, __LINE__, "Initializing it with the default size value: %i.",
+                DEFAULT_RESIZE_VALUE);
 
-            logger(
-                    INFO, debug, __func__, __LINE__,
-                    "StringVector item: %s left untouched.",
-                    item
-            );
+        if (!string_view_vector_init(vector, DEFAULT_RESIZE_VALUE)) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to initialize StringViewVector. Not continuing.");
+            return false;
         }
     }
 
-    string_vector_free(vector);
-    vector->capacity = tmp.capacity;
-    vector->data = tmp.data;
-    vector->item_sizes = tmp.item_sizes;
-    vector->offset = tmp.offset;
+    if (vector->offset + 1 > vector->capacity && !string_view_vector_reserve(vector, DEFAULT_RESIZE_VALUE)) {
+        logger(ERROR, true, __func__, __LINE__, "StringViewVector couldn't be resized. Not continuing.");
+        return false;
+    }
+
+    vector->data[vector->offset] = value;
+    vector->item_sizes[vector->offset] = length;
+    ++vector->offset;
+    return true;
+}
 
+/* Adds a view for every token of buffer separated by delimiter. Empty tokens are kept, except for
+ * the one after a trailing delimiter, so "a\nb\n" gives two views. Nothing is copied: views point
+ * into buffer, which must outlive vector.
+ */
+bool string_view_vector_split(StringViewVector *vector, const char *buffer, size_t size, char delimiter)
+{
     logger(
             INFO, debug, __func__, __LINE__,
-            "%li %s %s erased from StringVector: %p.",
-            length, item_text, (length == 1 ? "was" : "were"), vector
+            "Splitting %li bytes at %p into StringViewVector: %p...",
+            size, buffer, vector
     );
 
+    if (!string_view_vector_is_valid(vector, __func__, __LINE__, false)
+        && !string_view_vector_init(vector, DEFAULT_RESIZE_VALUE))
+    {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to initialize StringViewVector. Not continuing.");
+        return false;
+    }
+
+    const char *end = buffer + size;
+
+    /* memchr() is vectorized by libc, so counting the tokens first to reserve once is cheap. */
+    size_t tokens = 0;
+    for (const char *p = buffer; p < end; ++tokens) {
+        const char *found = (const char *) memchr(p, delimiter, end - p);
+        p = found == NULL ? end : found + 1;
+    }
+
+    if (vector->offset + tokens > vector->capacity
+        && !string_view_vector_reserve(vector, vector->offset + tokens - vector->capacity))
+    {
+        logger(ERROR, true, __func__, __LINE__, "StringViewVector couldn't be resized. Not continuing.");
+        return false;
+    }
+
+    for (const char *p = buffer; p < end;) {
+        const char *found = (const char *) memchr(p, delimiter, end - p);
+        const char *token_end = found == NULL ? end : found;
+
+        vector->data[vector->offset] = p;
+        vector->item_sizes[vector->offset] = token_end - p;
+        ++vector->offset;
+        p = token_end + (found == NULL ? 0 : 1);
+    }
+
+    logger(INFO, debug, __func__, __LINE__, "%li views added to StringViewVector: %p.", tokens, vector);
     return true;
 }
 
-bool string_vector_swap(StringVector *one, StringVector *another)
+/* Initializes vector with a view of every line of path, which is mapped read-only and shared, so lines
+ * stay in the page cache, shared with every other process reading the file, and nothing is copied.
+ * Lines are split as string_view_vector_split() does, and the mapping goes away with vector.
+ */
+bool string_view_vector_map_file(StringViewVector *vector, const char *path)
 {
-    if (!string_vector_is_valid(one, __func__, __LINE__, true)
-        || !string_vector_is_valid(another, __func__, __LINE__, true))
-    {
+    logger(INFO, debug, __func__, __LINE__, "Mapping file: %s into StringViewVector: %p...", path, vector);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat file;
+
+    if (fd < 0 || fstat(fd, &file) != 0) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to open file: %s. Error code: %i", path, errno);
+
+        if (fd >= 0) {
+            close(fd);
+        }
+
         return false;
     }
 
-    logger(INFO, debug, __func__, __LINE__, "Swapping StringVectors: %p and %p...", one, another);
+    size_t size = file.st_size;
+    int flags = MAP_SHARED;
 
-    StringVector tmp = {0};
-    tmp.data = one->data;
-    tmp.capacity = one->capacity;
-    tmp.item_sizes = one->item_sizes;
-    tmp.offset = one->offset;
+#if defined(MAP_POPULATE)
+    /* Every page is read while splitting, so they're all mapped at once. */
+    flags |= MAP_POPULATE;
+#endif
 
-    one->data = another->data;
-    one->capacity = another->capacity;
-    one->item_sizes = another->item_sizes;
-    one->offset = another->offset;
+    char *mapped = size > 0 ? (char *) mmap(NULL, size, PROT_READ, flags, fd, 0) : NULL;
+    close(fd);
 
-    another->data = tmp.data;
-    another->capacity = tmp.capacity;
-    another->item_sizes = tmp.item_sizes;
-    another->offset = tmp.offset;
+    if (mapped == MAP_FAILED) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to map file: %s. Error code: %i", path, errno);
+        return false;
+    }
 
-    logger(
-            INFO, debug, __func__, __LINE__,
-            "StringVectors: %p and %p were swapped.",
-            one, another
-    );
+    if (!string_view_vector_init(vector, DEFAULT_RESIZE_VALUE)) {
+        if (mapped != NULL) {
+            munmap(mapped, size);
+        }
 
-    logger(
-            INFO, debug, __func__, __LINE__,
-            "StringVector: %p old capacity: %li, new capacity: %li, \
-StringVector: %p old capacity: %li, new capacity: %li.",
-            one, another->capacity, one->capacity,
-            another, one->capacity, another->capacity
-    );
+        return false;
+    }
+
+    vector->mapped = mapped;
+    vector->mapped_size = size;
+
+    if (size > 0 && !string_view_vector_split(vector, mapped, size, '\n')) {
+        string_view_vector_free(vector);
+        return false;
+    }
 
+    logger(INFO, debug, __func__, __LINE__, "%li lines of file: %s mapped into StringViewVector: %p.", vector->offset, path, vector);
     return true;
 }
 
-size_t string_vector_get_capacity(const StringVector *vector)
+/* Copies every view into destination, which owns its strings afterwards. All of them are copied
+ * with a single allocation. See string_vector_copy() for initialize's meaning.
+ */
+bool string_view_vector_to_string_vector(const StringViewVector *source, StringVector *destination, bool initialize)
 {
-    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
-        return 0;
+    if (!string_view_vector_is_valid(source, __func__, __LINE__, true)) {
+        return false;
     }
 
-    return vector->capacity;
-}
+    if (initialize) {
+        if (!string_vector_init(destination, source->offset)) {
+            logger(
+                    ERROR, true, __func__, __LINE__,
+                    "Impossible to initialize StringVector: %p. Not continuing.",
+                    destination
+            );
 
-/* Returns the last heap-allocated string. Remember to free() it! */
-char *string_vector_pop(StringVector *vector)
-{
-    if (!string_vector_is_valid(vector, __func__, __LINE__, true) || vector->offset == 0) {
-        return NULL;
+            return false;
+        }
+    } else if (!string_vector_is_valid(destination, __func__, __LINE__, false)) {
+        logger(ERROR, true, __func__, __LINE__, "You told me not to initialize it. Not continuing.");
+        return false;
     }
 
-    size_t index = vector->offset - 1;
-    char *last = vector->data[index];
-    vector->data[index] = NULL;
-    --vector->offset;
-    return last;
+    if (!string_vector_add_sized_array(destination, source->data, source->item_sizes, source->offset)) {
+        if (initialize) {
+            string_vector_free(destination);
+        }
+
+        return false;
+    }
+
+    return true;
 }
 
-/* string_vector_get_* set of functions return NULL on failure, e.g., position >= vector bounds. */
-const char *string_vector_get_first(const StringVector *vector)
+size_t string_view_vector_get_capacity(const StringViewVector *vector)
 {
-    return string_vector_get_at(vector, 0);
+    if (!string_view_vector_is_valid(vector, __func__, __LINE__, true)) {
+        return 0;
+    }
+
+    return vector->capacity;
 }
 
-const char *string_vector_get_at(const StringVector *vector, size_t position)
+/* Returns the start of the view on position, or NULL on failure. It's NOT \0-terminated, use
+ * string_view_vector_strlen() to know how many bytes belong to it.
+ */
+const char *string_view_vector_get_at(const StringViewVector *vector, size_t position)
 {
-    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+    if (!string_view_vector_is_valid(vector, __func__, __LINE__, true)) {
         return NULL;
     }
 
     if (position >= vector->offset) {
         logger(
                 ERROR, true, __func__, __LINE__,
-                "StringVector: %p doesn't have any value on position: %li.",
+                "StringViewVector: %p doesn't have any value on position: %li.",
                 vector, position
         );
 
@@ -1416,52 +7380,37 @@ const char *string_vector_get_at(const StringVector *vector, size_t position)
     return vector->data[position];
 }
 
-const char *string_vector_get_last(const StringVector *vector)
-{
-    return string_vector_get_at(vector, vector->offset - 1);
-}
-
-size_t string_vector_strlen(const StringVector *vector, size_t position)
+size_t string_view_vector_strlen(const StringViewVector *vector, size_t position)
 {
-    if (!string_vector_is_valid(vector, __func__, __LINE__, true)) {
+    if (!string_view_vector_is_valid(vector, __func__, __LINE__, true)) {
         return 0;
     }
 
-    if (vector->offset == 0) {
+    if (position >= vector->offset) {
         logger(
                 WARN, debug, __func__, __LINE__,
-                "StringVector has no string. Consider using string_vector_add{,_array}() before using this function."
+                "StringViewVector: %p doesn't have any value on position: %li.",
+                vector, position
         );
 
         return 0;
     }
 
-    size_t length = vector->item_sizes[position];
-    return length == 0 ? length : length - 1;
+    return vector->item_sizes[position];
 }
 
-void string_vector_print(const StringVector *vector)
+void string_view_vector_print(const StringViewVector *vector)
 {
-    if (!vector->data) {
-        logger(
-                ERROR, true, __func__, __LINE__,
-                "StringVector isn't properly initialized."
-        );
-
-        logger(
-                ERROR, true, __func__, __LINE__,
-                "Please call string_vector_init() and string_vector_add() before using this function."
-        );
-
+    if (!string_view_vector_is_valid(vector, __func__, __LINE__, true)) {
         return;
     }
 
     for (size_t i = 0; i < vector->offset; ++i) {
-        printf("%s%s",
-                vector->data[i],
+        printf("%.*s%s",
+                (int) vector->item_sizes[i], vector->data[i],
                 (i < vector->offset - 1 ? ", " : "\n"));
     }
 
-    printf("StringVector capacity: %li\n", vector->capacity);
-    printf("StringVector items: %li\n", vector->offset);
+    printf("StringViewVector capacity: %li\n", vector->capacity);
+    printf("StringViewVector items: %li\n", vector->offset);
 }
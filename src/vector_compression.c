@@ -0,0 +1,234 @@
+#include "vector_compression.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define VECTOR_COMPRESSION_HASH_BITS 13
+#define VECTOR_COMPRESSION_MIN_MATCH 4
+#define VECTOR_COMPRESSION_MAX_OFFSET 65535 /* Offsets are written in 2 bytes. */
+#define VECTOR_COMPRESSION_SHORT_COPY 16 /* Literals and matches up to this long are copied with a single memcpy(). */
+#define VECTOR_COMPRESSION_SKIP_SHIFT 5 /* Every 32 misses in a row, the search skips one more byte. */
+
+/* The format is LZ77's, laid out as LZ4 does: a sequence of literals copied as they are, followed by a
+ * match repeating bytes already written. Every sequence starts with a token holding both lengths, 15
+ * meaning that bytes adding up the rest follow, up to one that isn't 255. Then come the literals, and
+ * the match's offset back from the end of the output, in 2 bytes, little endian. The last sequence has
+ * no match.
+ */
+
+static uint32_t vector_compression_load32(const char *bytes)
+{
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static uint64_t vector_compression_load64(const char *bytes)
+{
+    uint64_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static size_t vector_compression_hash(uint32_t value)
+{
+    return (value * 2654435761U) >> (32 - VECTOR_COMPRESSION_HASH_BITS);
+}
+
+static char *vector_compression_write_length(char *output, size_t length)
+{
+    for (; length >= 255; length -= 255) {
+        *output++ = (char) 255;
+    }
+
+    *output++ = (char) length;
+    return output;
+}
+
+/* A match_length of 0 ends the output with the literals. */
+static char *vector_compression_write_sequence(char *output, const char *literals, size_t literal_length, size_t offset, size_t match_length)
+{
+    size_t match_code = match_length > 0 ? match_length - VECTOR_COMPRESSION_MIN_MATCH : 0;
+
+    *output++ = (char) ((literal_length < 15 ? literal_length : 15) << 4 | (match_code < 15 ? match_code : 15));
+
+    if (literal_length >= 15) {
+        output = vector_compression_write_length(output, literal_length - 15);
+    }
+
+    memcpy(output, literals, literal_length);
+    output += literal_length;
+
+    if (match_length == 0) {
+        return output;
+    }
+
+    *output++ = (char) (offset & 0xFF);
+    *output++ = (char) (offset >> 8);
+    return match_code >= 15 ? vector_compression_write_length(output, match_code - 15) : output;
+}
+
+/* Length of the match at position of input, size bytes long, with the bytes at match, before it. */
+static size_t vector_compression_match_length(const char *input, size_t size, size_t position, size_t match)
+{
+    size_t length = VECTOR_COMPRESSION_MIN_MATCH;
+
+    while (position + length + sizeof(uint64_t) <= size) {
+        uint64_t difference = vector_compression_load64(input + position + length)
+                ^ vector_compression_load64(input + match + length);
+
+        if (difference != 0) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            return length + __builtin_ctzll(difference) / 8;
+#else
+            break;
+#endif
+        }
+
+        length += sizeof(uint64_t);
+    }
+
+    while (position + length < size && input[position + length] == input[match + length]) {
+        ++length;
+    }
+
+    return length;
+}
+
+/* Compresses size bytes, up to UINT32_MAX, into output, which must hold VECTOR_COMPRESSION_BOUND(size)
+ * bytes, and returns how many it wrote. Matches are found through a table of the last position where
+ * 4 bytes hashing to the same slot were seen, as fast as it gets and good enough for repeated words.
+ */
+size_t vector_compress(const char *input, size_t size, char *output)
+{
+    uint32_t table[1 << VECTOR_COMPRESSION_HASH_BITS] = {0}; /* Positions plus one, 0 being none. */
+    char *end = output;
+    size_t anchor = 0;
+    size_t misses = 0;
+
+    for (size_t i = 0; i + VECTOR_COMPRESSION_MIN_MATCH <= size;) {
+        uint32_t value = vector_compression_load32(input + i);
+        uint32_t *slot = &table[vector_compression_hash(value)];
+        size_t candidate = *slot;
+
+        *slot = (uint32_t) (i + 1);
+
+        if (candidate == 0 || i + 1 - candidate > VECTOR_COMPRESSION_MAX_OFFSET
+            || vector_compression_load32(input + candidate - 1) != value)
+        {
+            i += 1 + (misses++ >> VECTOR_COMPRESSION_SKIP_SHIFT);
+            continue;
+        }
+
+        size_t match = candidate - 1;
+        size_t length = vector_compression_match_length(input, size, i, match);
+
+        /* The match may start among the literals before it. */
+        for (; i > anchor && match > 0 && input[i - 1] == input[match - 1]; --i, --match) {
+            ++length;
+        }
+
+        end = vector_compression_write_sequence(end, input + anchor, i - anchor, i - match, length);
+        i += length;
+        anchor = i;
+        misses = 0;
+
+        if (i + VECTOR_COMPRESSION_MIN_MATCH <= size) {
+            table[vector_compression_hash(vector_compression_load32(input + i - 2))] = (uint32_t) (i - 1);
+        }
+    }
+
+    if (anchor < size) {
+        end = vector_compression_write_sequence(end, input + anchor, size - anchor, 0, 0);
+    }
+
+    return end - output;
+}
+
+static bool vector_compression_read_length(const unsigned char **input, const unsigned char *end, size_t *length)
+{
+    unsigned char byte;
+
+    do {
+        if (*input == end) {
+            return false;
+        }
+
+        byte = *(*input)++;
+        *length += byte;
+    } while (byte == 255);
+
+    return true;
+}
+
+/* Decompresses size bytes written by vector_compress() into output, checking that they make up exactly
+ * output_size bytes, and that no sequence reaches out of input or output, as broken files won't.
+ */
+bool vector_decompress(const char *input, size_t size, char *output, size_t output_size)
+{
+    const unsigned char *in = (const unsigned char *) input;
+    const unsigned char *end = in + size;
+    size_t written = 0;
+
+    while (in < end) {
+        unsigned token = *in++;
+        size_t literals = token >> 4;
+        size_t length = (token & 15) + VECTOR_COMPRESSION_MIN_MATCH;
+
+        if ((literals == 15 && !vector_compression_read_length(&in, end, &literals))
+            || literals > (size_t) (end - in) || literals > output_size - written)
+        {
+            return false;
+        }
+
+        /* Short copies are done 16 bytes at once, when there's room, the rest being written over later. */
+        if (literals <= VECTOR_COMPRESSION_SHORT_COPY && end - in >= VECTOR_COMPRESSION_SHORT_COPY
+            && output_size - written >= VECTOR_COMPRESSION_SHORT_COPY)
+        {
+            memcpy(output + written, in, VECTOR_COMPRESSION_SHORT_COPY);
+        } else {
+            memcpy(output + written, in, literals);
+        }
+
+        in += literals;
+        written += literals;
+
+        if (in == end) {
+            break;
+        } else if (end - in < 2) {
+            return false;
+        }
+
+        size_t offset = in[0] | (size_t) in[1] << 8;
+        in += 2;
+
+        if (((token & 15) == 15 && !vector_compression_read_length(&in, end, &length))
+            || offset == 0 || offset > written || length > output_size - written)
+        {
+            return false;
+        }
+
+        char *to = output + written;
+        const char *from = to - offset;
+
+        if (offset >= VECTOR_COMPRESSION_SHORT_COPY && length <= VECTOR_COMPRESSION_SHORT_COPY
+            && output_size - written >= VECTOR_COMPRESSION_SHORT_COPY)
+        {
+            memcpy(to, from, VECTOR_COMPRESSION_SHORT_COPY);
+            written += length;
+            continue;
+        }
+
+        /* Overlapping matches repeat the offset bytes before them, copied in chunks which double. */
+        for (size_t copied = 0; copied < length;) {
+            size_t chunk = copied + offset < length - copied ? copied + offset : length - copied;
+
+            memcpy(to + copied, from, chunk);
+            copied += chunk;
+        }
+
+        written += length;
+    }
+
+    return written == output_size;
+}
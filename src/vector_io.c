@@ -0,0 +1,561 @@
+#include "vector_io.h"
+#include "logger.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#define VECTOR_IO_DEFAULT_DEPTH 64
+#define VECTOR_IO_MAX_DEPTH 4096
+#define VECTOR_IO_THREADS 4 /* Blocking transfers done at once when io_uring is unavailable. */
+
+/* A transfer, from submission until its completion has run. iov and offset move forward as bytes
+ * are transferred, so a short transfer is resubmitted for what's left.
+ */
+typedef struct VectorIORequest {
+    struct VectorIORequest *next;
+    bool write;
+    int fd;
+    uint64_t offset;
+    struct iovec iov[VECTOR_IO_MAX_IOVECS];
+    int iov_count;
+    int error;
+    VectorIOCallback completion;
+    void *context;
+} VectorIORequest;
+
+/* A FIFO list of requests. */
+typedef struct {
+    VectorIORequest *first;
+    VectorIORequest **last;
+} VectorIOQueue;
+
+/* Requests are queued by vector_io_submit() and handed over in batches by vector_io_poll(), either to
+ * the kernel through an io_uring, or to a few threads calling pwritev() and preadv(). Completions
+ * are only run by vector_io_poll(), on the thread calling it.
+ */
+struct VectorIO {
+    size_t pending; /* Submitted, with a completion which hasn't run yet. */
+    VectorIOQueue queued;
+    bool io_uring;
+
+    /* Rings shared with the kernel. Only requests which fit in the completion ring are in flight. */
+    int ring_fd;
+    unsigned entries;
+    size_t in_flight;
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    void *sqes;
+    size_t sqes_size;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    void *cqes;
+
+    /* Threads doing blocking transfers, sharing the queues below under mutex. */
+    pthread_t threads[VECTOR_IO_THREADS];
+    size_t thread_count;
+    pthread_mutex_t mutex;
+    pthread_cond_t work;
+    pthread_cond_t done;
+    VectorIOQueue waiting;
+    VectorIOQueue completed;
+    bool stopping;
+};
+
+static void vector_io_queue_init(VectorIOQueue *queue)
+{
+    queue->first = NULL;
+    queue->last = &queue->first;
+}
+
+static void vector_io_queue_push(VectorIOQueue *queue, VectorIORequest *request)
+{
+    request->next = NULL;
+    *queue->last = request;
+    queue->last = &request->next;
+}
+
+static VectorIORequest *vector_io_queue_pop(VectorIOQueue *queue)
+{
+    VectorIORequest *request = queue->first;
+
+    if (request != NULL) {
+        queue->first = request->next;
+
+        if (queue->first == NULL) {
+            queue->last = &queue->first;
+        }
+    }
+
+    return request;
+}
+
+/* Moves every request of from to the end of to. */
+static void vector_io_queue_append(VectorIOQueue *to, VectorIOQueue *from)
+{
+    if (from->first != NULL) {
+        *to->last = from->first;
+        to->last = from->last;
+        vector_io_queue_init(from);
+    }
+}
+
+/* Accounts for transferred bytes, returning whether any are left. */
+static bool vector_io_advance(VectorIORequest *request, size_t transferred)
+{
+    int done = 0;
+    request->offset += transferred;
+
+    while (done < request->iov_count && transferred >= request->iov[done].iov_len) {
+        transferred -= request->iov[done].iov_len;
+        ++done;
+    }
+
+    request->iov_count -= done;
+    memmove(request->iov, request->iov + done, request->iov_count * sizeof(struct iovec));
+
+    if (request->iov_count > 0) {
+        request->iov[0].iov_base = (char *) request->iov[0].iov_base + transferred;
+        request->iov[0].iov_len -= transferred;
+    }
+
+    return request->iov_count > 0;
+}
+
+/* Transfers every byte of request, retrying after short transfers and interruptions. */
+static void vector_io_transfer(VectorIORequest *request)
+{
+    while (request->iov_count > 0) {
+        ssize_t transferred = request->write
+                ? pwritev(request->fd, request->iov, request->iov_count, (off_t) request->offset)
+                : preadv(request->fd, request->iov, request->iov_count, (off_t) request->offset);
+
+        if (transferred < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (transferred <= 0) {
+            request->error = transferred < 0 ? errno : EIO;
+            return;
+        }
+
+        vector_io_advance(request, transferred);
+    }
+}
+
+static void *vector_io_worker(void *argument)
+{
+    VectorIO *io = (VectorIO *) argument;
+
+    pthread_mutex_lock(&io->mutex);
+
+    for (;;) {
+        while (io->waiting.first == NULL && !io->stopping) {
+            pthread_cond_wait(&io->work, &io->mutex);
+        }
+
+        VectorIORequest *request = vector_io_queue_pop(&io->waiting);
+        if (request == NULL) {
+            break;
+        }
+
+        pthread_mutex_unlock(&io->mutex);
+        vector_io_transfer(request);
+        pthread_mutex_lock(&io->mutex);
+
+        vector_io_queue_push(&io->completed, request);
+        pthread_cond_signal(&io->done);
+    }
+
+    pthread_mutex_unlock(&io->mutex);
+    return NULL;
+}
+
+#if defined(__linux__)
+static bool vector_io_ring_setup(VectorIO *io, unsigned entries)
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    /* Missing from old kernels, or forbidden by kernel.io_uring_disabled or a seccomp filter. */
+    int fd = (int) syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) {
+        return false;
+    }
+
+    io->ring_fd = fd;
+    io->entries = params.sq_entries < params.cq_entries ? params.sq_entries : params.cq_entries;
+    io->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    io->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    io->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        io->sq_ring_size = io->sq_ring_size > io->cq_ring_size ? io->sq_ring_size : io->cq_ring_size;
+        io->cq_ring_size = 0;
+    }
+
+    io->sq_ring = mmap(NULL, io->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    io->cq_ring = io->cq_ring_size == 0 ? io->sq_ring : mmap(
+            NULL, io->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING
+    );
+    io->sqes = mmap(NULL, io->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+    if (io->sq_ring == MAP_FAILED || io->cq_ring == MAP_FAILED || io->sqes == MAP_FAILED) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to map io_uring rings. Error code: %i", errno);
+        return false;
+    }
+
+    char *sq_ring = (char *) io->sq_ring;
+    char *cq_ring = (char *) io->cq_ring;
+
+    io->sq_head = (unsigned *) (sq_ring + params.sq_off.head);
+    io->sq_tail = (unsigned *) (sq_ring + params.sq_off.tail);
+    io->sq_mask = (unsigned *) (sq_ring + params.sq_off.ring_mask);
+    io->sq_array = (unsigned *) (sq_ring + params.sq_off.array);
+    io->cq_head = (unsigned *) (cq_ring + params.cq_off.head);
+    io->cq_tail = (unsigned *) (cq_ring + params.cq_off.tail);
+    io->cq_mask = (unsigned *) (cq_ring + params.cq_off.ring_mask);
+    io->cqes = cq_ring + params.cq_off.cqes;
+
+    return true;
+}
+
+static void vector_io_ring_destroy(VectorIO *io)
+{
+    if (io->sqes != NULL && io->sqes != MAP_FAILED) {
+        munmap(io->sqes, io->sqes_size);
+    }
+
+    if (io->cq_ring_size > 0 && io->cq_ring != NULL && io->cq_ring != MAP_FAILED) {
+        munmap(io->cq_ring, io->cq_ring_size);
+    }
+
+    if (io->sq_ring != NULL && io->sq_ring != MAP_FAILED) {
+        munmap(io->sq_ring, io->sq_ring_size);
+    }
+
+    if (io->ring_fd >= 0) {
+        close(io->ring_fd);
+    }
+}
+
+/* Puts as many queued requests as the rings have room for in the submission ring, and submits them
+ * with a single system call, which also waits for wait_for completions. If that fails, the requests
+ * the kernel didn't take are taken out of the ring and moved to completed with the error.
+ */
+static bool vector_io_ring_submit(VectorIO *io, unsigned wait_for, VectorIOQueue *completed)
+{
+    struct io_uring_sqe *sqes = (struct io_uring_sqe *) io->sqes;
+    unsigned tail = *io->sq_tail;
+    unsigned count = 0;
+
+    while (io->queued.first != NULL && io->in_flight < io->entries) {
+        VectorIORequest *request = vector_io_queue_pop(&io->queued);
+        unsigned index = tail & *io->sq_mask;
+        struct io_uring_sqe *sqe = &sqes[index];
+
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = request->write ? IORING_OP_WRITEV : IORING_OP_READV;
+        sqe->fd = request->fd;
+        sqe->off = request->offset;
+        sqe->addr = (uint64_t) (uintptr_t) request->iov;
+        sqe->len = (unsigned) request->iov_count;
+        sqe->user_data = (uint64_t) (uintptr_t) request;
+        io->sq_array[index] = index;
+
+        ++tail;
+        ++count;
+        ++io->in_flight;
+    }
+
+    /* The kernel reads the entries once it sees the new tail. */
+    __atomic_store_n(io->sq_tail, tail, __ATOMIC_RELEASE);
+
+    while (count > 0 || wait_for > 0) {
+        int submitted = (int) syscall(
+                __NR_io_uring_enter, io->ring_fd, count, wait_for, wait_for > 0 ? IORING_ENTER_GETEVENTS : 0, NULL, 0
+        );
+
+        if (submitted < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (submitted < 0) {
+            int error = errno;
+            logger(ERROR, true, __func__, __LINE__, "Impossible to submit %u transfers to io_uring. Error code: %i", count, error);
+
+            /* Without SQPOLL, the kernel only takes entries during the call, so the ones after its head
+             * stay ours.
+             */
+            unsigned head = __atomic_load_n(io->sq_head, __ATOMIC_ACQUIRE);
+
+            for (unsigned i = head; i != tail; ++i) {
+                VectorIORequest *request = (VectorIORequest *) (uintptr_t) sqes[io->sq_array[i & *io->sq_mask]].user_data;
+                request->error = error;
+                vector_io_queue_push(completed, request);
+                --io->in_flight;
+            }
+
+            __atomic_store_n(io->sq_tail, head, __ATOMIC_RELEASE);
+            return false;
+        }
+
+        count -= (unsigned) submitted;
+        wait_for = 0;
+    }
+
+    return true;
+}
+
+/* Moves finished requests to completed, and the ones with bytes left back to the queue. */
+static void vector_io_ring_reap(VectorIO *io, VectorIOQueue *completed)
+{
+    struct io_uring_cqe *cqes = (struct io_uring_cqe *) io->cqes;
+    unsigned head = *io->cq_head;
+    unsigned tail = __atomic_load_n(io->cq_tail, __ATOMIC_ACQUIRE);
+
+    for (; head != tail; ++head) {
+        struct io_uring_cqe *cqe = &cqes[head & *io->cq_mask];
+        VectorIORequest *request = (VectorIORequest *) (uintptr_t) cqe->user_data;
+        --io->in_flight;
+
+        if (cqe->res == -EINTR || cqe->res == -EAGAIN) {
+            vector_io_queue_push(&io->queued, request);
+        } else if (cqe->res <= 0) {
+            request->error = cqe->res < 0 ? -cqe->res : EIO;
+            vector_io_queue_push(completed, request);
+        } else if (vector_io_advance(request, (size_t) cqe->res)) {
+            vector_io_queue_push(&io->queued, request);
+        } else {
+            vector_io_queue_push(completed, request);
+        }
+    }
+
+    __atomic_store_n(io->cq_head, head, __ATOMIC_RELEASE);
+}
+#endif
+
+/* queue_depth bounds the transfers in flight at once, 64 when 0. Transfers go through io_uring when
+ * the kernel allows it, unless threads_only asks for the pwritev() and preadv() fallback.
+ */
+VectorIO *vector_io_create(size_t queue_depth, bool threads_only)
+{
+    VectorIO *io = (VectorIO *) calloc(1, sizeof(VectorIO));
+
+    if (io == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for VectorIO. Error code: %i", errno);
+        return NULL;
+    }
+
+    queue_depth = queue_depth == 0 ? VECTOR_IO_DEFAULT_DEPTH : queue_depth;
+    queue_depth = queue_depth > VECTOR_IO_MAX_DEPTH ? VECTOR_IO_MAX_DEPTH : queue_depth;
+
+    vector_io_queue_init(&io->queued);
+    vector_io_queue_init(&io->waiting);
+    vector_io_queue_init(&io->completed);
+    pthread_mutex_init(&io->mutex, NULL);
+    pthread_cond_init(&io->work, NULL);
+    pthread_cond_init(&io->done, NULL);
+    io->ring_fd = -1;
+
+#if defined(__linux__)
+    if (!threads_only) {
+        io->io_uring = vector_io_ring_setup(io, (unsigned) queue_depth);
+
+        if (io->io_uring) {
+            return io;
+        }
+
+        vector_io_ring_destroy(io);
+        io->ring_fd = -1;
+        io->sq_ring = io->cq_ring = io->sqes = NULL;
+    }
+#endif
+
+    size_t threads = queue_depth < VECTOR_IO_THREADS ? queue_depth : VECTOR_IO_THREADS;
+
+    for (; io->thread_count < threads; ++io->thread_count) {
+        if (pthread_create(&io->threads[io->thread_count], NULL, vector_io_worker, io) != 0) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to start VectorIO thread #%li.", io->thread_count);
+            break;
+        }
+    }
+
+    if (io->thread_count == 0) {
+        vector_io_destroy(io);
+        return NULL;
+    }
+
+    return io;
+}
+
+/* Waits for every pending transfer, running their completions, before freeing io. */
+void vector_io_destroy(VectorIO *io)
+{
+    if (io == NULL) {
+        return;
+    }
+
+    vector_io_poll(io, true);
+
+    pthread_mutex_lock(&io->mutex);
+    io->stopping = true;
+    pthread_cond_broadcast(&io->work);
+    pthread_mutex_unlock(&io->mutex);
+
+    for (size_t i = 0; i < io->thread_count; ++i) {
+        pthread_join(io->threads[i], NULL);
+    }
+
+#if defined(__linux__)
+    if (io->io_uring) {
+        vector_io_ring_destroy(io);
+    }
+#endif
+
+    pthread_cond_destroy(&io->done);
+    pthread_cond_destroy(&io->work);
+    pthread_mutex_destroy(&io->mutex);
+    free(io);
+}
+
+bool vector_io_uses_io_uring(const VectorIO *io)
+{
+    return io != NULL && io->io_uring;
+}
+
+/* Queues a transfer of the bytes in iov, from or to fd at offset, which must stay valid until
+ * completion runs. Nothing is transferred before the next vector_io_poll().
+ */
+bool vector_io_submit(
+        VectorIO *io,
+        bool write,
+        int fd,
+        const struct iovec *iov,
+        int iov_count,
+        uint64_t offset,
+        VectorIOCallback completion,
+        void *context)
+{
+    if (iov_count > VECTOR_IO_MAX_IOVECS) {
+        logger(ERROR, true, __func__, __LINE__, "VectorIO transfers are limited to %i buffers, but %i were given.", VECTOR_IO_MAX_IOVECS, iov_count);
+        return false;
+    }
+
+    VectorIORequest *request = (VectorIORequest *) calloc(1, sizeof(VectorIORequest));
+
+    if (request == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for a VectorIO transfer. Error code: %i", errno);
+        return false;
+    }
+
+    request->write = write;
+    request->fd = fd;
+    request->offset = offset;
+    memcpy(request->iov, iov, iov_count * sizeof(struct iovec));
+    request->iov_count = iov_count;
+    request->completion = completion;
+    request->context = context;
+
+    /* Nothing to transfer is done right away, but still completed by vector_io_poll(). */
+    vector_io_advance(request, 0);
+    ++io->pending;
+
+    if (request->iov_count > 0) {
+        vector_io_queue_push(&io->queued, request);
+    } else {
+        pthread_mutex_lock(&io->mutex);
+        vector_io_queue_push(&io->completed, request);
+        pthread_mutex_unlock(&io->mutex);
+    }
+
+    return true;
+}
+
+static size_t vector_io_complete(VectorIO *io, VectorIOQueue *completed)
+{
+    size_t count = 0;
+
+    for (VectorIORequest *request; (request = vector_io_queue_pop(completed)) != NULL; ++count) {
+        if (request->error != 0) {
+            logger(
+                    ERROR, true, __func__, __LINE__,
+                    "Impossible to %s file descriptor %i at offset %li. Error code: %i",
+                    request->write ? "write to" : "read from", request->fd, (long) request->offset, request->error
+            );
+        }
+
+        --io->pending;
+        request->completion(request->context, request->error == 0);
+        free(request);
+    }
+
+    return count;
+}
+
+/* Hands queued transfers over and runs the completions of the finished ones, returning how many
+ * ran. With wait, returns once every transfer submitted, even by the completions, is complete.
+ */
+size_t vector_io_poll(VectorIO *io, bool wait)
+{
+    if (io == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "VectorIO is NULL.");
+        return 0;
+    }
+
+    size_t count = 0;
+    bool stalled = false;
+
+    do {
+        VectorIOQueue completed;
+        vector_io_queue_init(&completed);
+
+        /* Transfers with nothing to transfer are completed at submission. */
+        pthread_mutex_lock(&io->mutex);
+        vector_io_queue_append(&completed, &io->completed);
+
+        if (!io->io_uring) {
+            vector_io_queue_append(&io->waiting, &io->queued);
+            pthread_cond_broadcast(&io->work);
+
+            while (wait && completed.first == NULL && io->completed.first == NULL && io->pending > 0) {
+                pthread_cond_wait(&io->done, &io->mutex);
+            }
+
+            vector_io_queue_append(&completed, &io->completed);
+        }
+
+        pthread_mutex_unlock(&io->mutex);
+
+#if defined(__linux__)
+        if (io->io_uring) {
+            unsigned wait_for = wait && completed.first == NULL && io->pending > 0 ? 1 : 0;
+
+            /* The ring may be unusable, so waiting goes on only while transfers still complete. */
+            stalled = !vector_io_ring_submit(io, wait_for, &completed);
+            vector_io_ring_reap(io, &completed);
+            stalled = stalled && completed.first == NULL;
+        }
+#endif
+
+        count += vector_io_complete(io, &completed);
+    } while (wait && io->pending > 0 && !stalled);
+
+    return count;
+}
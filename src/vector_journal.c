@@ -0,0 +1,492 @@
+#include "vector_journal.h"
+#include "logger.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define VECTOR_JOURNAL_BUFFER_SIZE (64 * 1024) /* Records gathered before being written to the log. */
+#define VECTOR_JOURNAL_MIN_COMPACTION (1024 * 1024) /* Smaller logs aren't worth a new snapshot. */
+
+/* Leads both the snapshot and the log. A log only applies to the snapshot of the same generation. */
+typedef struct {
+    char magic[8];
+    uint64_t generation;
+} VectorJournalHeader;
+
+static const char vector_journal_snapshot_magic[8] = "LVJSNAP1";
+static const char vector_journal_log_magic[8] = "LVJLOG01";
+
+/* The snapshot lives at path, and the records logged since it was written at path.log. Records are
+ * gathered in buffer, written when it's full, and synced once sync_bytes of them were written.
+ */
+struct VectorJournal {
+    char *path;
+    char *log_path;
+    char *temporary_path;
+    int log_fd;
+    uint64_t generation;
+    uint64_t log_size; /* Header and records, including the buffered ones. */
+    uint64_t snapshot_size;
+    uint64_t unsynced;
+    size_t sync_bytes;
+    char *buffer;
+    size_t size;
+    size_t capacity;
+    size_t record; /* Where the record being built starts in buffer. */
+    bool stale; /* The vector was modified without a record, so only a new snapshot has it right. */
+    bool failed; /* Writing failed, so nothing is logged until a new snapshot is written. */
+};
+
+/* Records are padded to 8 bytes, so the numbers in them are aligned. */
+static size_t vector_journal_record_bytes(size_t size)
+{
+    return (sizeof(VectorJournalRecord) + size + 7) & ~(size_t) 7;
+}
+
+/* Multiplicative hash of size, then of everything after it, padding included, 8 bytes at a time.
+ * Records torn by a crash just have to fail it.
+ */
+static uint32_t vector_journal_checksum(const VectorJournalRecord *record)
+{
+    const uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+    const char *bytes = (const char *) &record->operation;
+    size_t size = vector_journal_record_bytes(record->size) - offsetof(VectorJournalRecord, operation);
+    uint64_t hash = (record->size + 1) * multiplier;
+
+    for (size_t i = 0; i < size; i += sizeof(uint64_t)) {
+        uint64_t chunk;
+
+        memcpy(&chunk, bytes + i, sizeof(chunk));
+        hash = (hash ^ chunk) * multiplier;
+        hash ^= hash >> 29;
+    }
+
+    return (uint32_t) (hash ^ (hash >> 32));
+}
+
+static bool vector_journal_read_all(int fd, void *buffer, size_t size, uint64_t offset)
+{
+    for (size_t done = 0; done < size;) {
+        ssize_t n = pread(fd, (char *) buffer + done, size - done, (off_t) (offset + done));
+
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            return false;
+        }
+
+        done += n;
+    }
+
+    return true;
+}
+
+static bool vector_journal_write_all(int fd, const void *buffer, size_t size, uint64_t offset)
+{
+    for (size_t done = 0; done < size;) {
+        ssize_t n = pwrite(fd, (const char *) buffer + done, size - done, (off_t) (offset + done));
+
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0) {
+            return false;
+        }
+
+        done += n;
+    }
+
+    return true;
+}
+
+/* A renamed file is only there for good once its directory is synced. */
+static void vector_journal_sync_directory(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+    char *directory = slash == NULL ? strdup(".") : strndup(path, slash == path ? 1 : (size_t) (slash - path));
+    int fd = directory == NULL ? -1 : open(directory, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    if (fd < 0 || fsync(fd) != 0) {
+        logger(WARN, true, __func__, __LINE__, "Impossible to sync the directory of: %s. Error code: %i", path, errno);
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    free(directory);
+}
+
+void vector_journal_close(VectorJournal *journal)
+{
+    if (journal == NULL) {
+        return;
+    }
+
+    if (journal->log_fd >= 0) {
+        close(journal->log_fd);
+    }
+
+    free(journal->buffer);
+    free(journal->temporary_path);
+    free(journal->log_path);
+    free(journal->path);
+    free(journal);
+}
+
+/* Opens the journal at path, creating its log if it's missing, and hands what has to be replayed over
+ * in contents. A missing snapshot counts as an empty one. Nothing is logged before vector_journal_start().
+ */
+VectorJournal *vector_journal_open(const char *path, size_t sync_bytes, VectorJournalContents *contents)
+{
+    VectorJournalContents empty = {0};
+    *contents = empty;
+    contents->snapshot_fd = -1;
+
+    VectorJournal *journal = (VectorJournal *) calloc(1, sizeof(VectorJournal));
+    size_t length = strlen(path);
+
+    if (journal == NULL || (journal->path = strdup(path)) == NULL
+        || (journal->log_path = (char *) malloc(length + 5)) == NULL
+        || (journal->temporary_path = (char *) malloc(length + 5)) == NULL)
+    {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for journal: %s. Error code: %i", path, errno);
+
+        if (journal != NULL) {
+            journal->log_fd = -1;
+            vector_journal_close(journal);
+        }
+
+        return NULL;
+    }
+
+    snprintf(journal->log_path, length + 5, "%s.log", path);
+    snprintf(journal->temporary_path, length + 5, "%s.tmp", path);
+    journal->sync_bytes = sync_bytes;
+
+    VectorJournalHeader header;
+    struct stat file;
+
+    contents->snapshot_fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (contents->snapshot_fd >= 0) {
+        if (fstat(contents->snapshot_fd, &file) != 0 || !vector_journal_read_all(contents->snapshot_fd, &header, sizeof(header), 0)
+            || memcmp(header.magic, vector_journal_snapshot_magic, sizeof(header.magic)) != 0)
+        {
+            logger(ERROR, true, __func__, __LINE__, "%s isn't a snapshot written by libvector.", path);
+            journal->log_fd = -1;
+            goto failed;
+        }
+
+        journal->generation = header.generation;
+        journal->snapshot_size = file.st_size;
+        contents->snapshot_offset = sizeof(header);
+        contents->snapshot_size = file.st_size - sizeof(header);
+    } else if (errno != ENOENT) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to open snapshot: %s. Error code: %i", path, errno);
+        journal->log_fd = -1;
+        goto failed;
+    }
+
+    journal->log_fd = open(journal->log_path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (journal->log_fd < 0 || fstat(journal->log_fd, &file) != 0) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to open journal: %s. Error code: %i", journal->log_path, errno);
+        goto failed;
+    }
+
+    /* A log of another generation was superseded by the snapshot, written just before the log was reset. */
+    if ((size_t) file.st_size >= sizeof(header) && vector_journal_read_all(journal->log_fd, &header, sizeof(header), 0)
+        && memcmp(header.magic, vector_journal_log_magic, sizeof(header.magic)) == 0 && header.generation == journal->generation)
+    {
+        contents->log_size = file.st_size - sizeof(header);
+        contents->log = (char *) malloc(contents->log_size > 0 ? contents->log_size : 1);
+
+        if (contents->log == NULL || !vector_journal_read_all(journal->log_fd, contents->log, contents->log_size, sizeof(header))) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to read journal: %s. Error code: %i", journal->log_path, errno);
+            goto failed;
+        }
+    }
+
+    return journal;
+
+failed:
+    vector_journal_discard(contents);
+    vector_journal_close(journal);
+    return NULL;
+}
+
+/* Reads size bytes of the snapshot, offset bytes after its header. */
+bool vector_journal_read(const VectorJournalContents *contents, void *buffer, size_t size, uint64_t offset)
+{
+    if (size == 0) {
+        return true;
+    }
+
+    if (offset + size > contents->snapshot_size
+        || !vector_journal_read_all(contents->snapshot_fd, buffer, size, contents->snapshot_offset + offset))
+    {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to read %li bytes of snapshot at offset: %li.", size, (long) offset);
+        return false;
+    }
+
+    return true;
+}
+
+/* Returns the record at offset bytes of the log, moving offset past it, or NULL if there's no whole
+ * record there, e.g., when the last one was torn by a crash.
+ */
+const VectorJournalRecord *vector_journal_next(const VectorJournalContents *contents, size_t *offset)
+{
+    size_t left = contents->log_size - *offset;
+
+    if (left < sizeof(VectorJournalRecord)) {
+        return NULL;
+    }
+
+    const VectorJournalRecord *record = (const VectorJournalRecord *) (contents->log + *offset);
+    size_t bytes = vector_journal_record_bytes(record->size);
+
+    if (record->size > left || bytes > left || vector_journal_checksum(record) != record->checksum) {
+        return NULL;
+    }
+
+    *offset += bytes;
+    return record;
+}
+
+void vector_journal_discard(VectorJournalContents *contents)
+{
+    if (contents->snapshot_fd >= 0) {
+        close(contents->snapshot_fd);
+    }
+
+    free(contents->log);
+    contents->log = NULL;
+    contents->snapshot_fd = -1;
+}
+
+/* Drops whatever follows the valid_size bytes of records replayed, and gets journal ready to log. */
+bool vector_journal_start(VectorJournal *journal, VectorJournalContents *contents, size_t valid_size)
+{
+    bool reset = contents->log == NULL;
+    size_t log_size = contents->log_size;
+
+    vector_journal_discard(contents);
+
+    if (reset || valid_size < log_size) {
+        VectorJournalHeader header = {{0}, journal->generation};
+        memcpy(header.magic, vector_journal_log_magic, sizeof(header.magic));
+
+        if (!reset) {
+            logger(
+                    WARN, true, __func__, __LINE__,
+                    "Dropping %li bytes of incomplete records at the end of journal: %s.",
+                    log_size - valid_size, journal->log_path
+            );
+        }
+
+        valid_size = reset ? 0 : valid_size;
+
+        if (ftruncate(journal->log_fd, (off_t) (sizeof(header) + valid_size)) != 0
+            || (reset && !vector_journal_write_all(journal->log_fd, &header, sizeof(header), 0))
+            || fdatasync(journal->log_fd) != 0)
+        {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to prepare journal: %s. Error code: %i", journal->log_path, errno);
+            return false;
+        }
+    }
+
+    journal->buffer = (char *) malloc(VECTOR_JOURNAL_BUFFER_SIZE);
+    if (journal->buffer == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for journal: %s. Error code: %i", journal->log_path, errno);
+        return false;
+    }
+
+    journal->capacity = VECTOR_JOURNAL_BUFFER_SIZE;
+    journal->log_size = sizeof(VectorJournalHeader) + valid_size;
+    return true;
+}
+
+static bool vector_journal_flush(VectorJournal *journal)
+{
+    if (journal->size > 0 && !vector_journal_write_all(journal->log_fd, journal->buffer, journal->size, journal->log_size - journal->size)) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to write to journal: %s. Error code: %i", journal->log_path, errno);
+        journal->failed = true;
+        return false;
+    }
+
+    journal->size = 0;
+    return true;
+}
+
+/* Starts a record, returning where its size bytes of items go, or NULL if it can't be logged. Then
+ * the journal is stale, or failed, until the next snapshot.
+ */
+char *vector_journal_reserve(VectorJournal *journal, uint32_t operation, size_t position, size_t count, size_t size)
+{
+    if (journal->stale || journal->failed) {
+        return NULL;
+    }
+
+    size_t bytes = vector_journal_record_bytes(size);
+
+    if (count > UINT32_MAX || size > UINT32_MAX) {
+        journal->stale = true;
+        return NULL;
+    }
+
+    if (journal->size + bytes > journal->capacity) {
+        if (!vector_journal_flush(journal)) {
+            return NULL;
+        }
+
+        if (bytes > journal->capacity) {
+            char *buffer = (char *) realloc(journal->buffer, bytes);
+
+            if (buffer == NULL) {
+                logger(ERROR, true, __func__, __LINE__, "Impossible to allocate %li bytes for a journal record. Error code: %i", bytes, errno);
+                journal->stale = true;
+                return NULL;
+            }
+
+            journal->buffer = buffer;
+            journal->capacity = bytes;
+        }
+    }
+
+    /* Zeroes the padding, before the items are copied over the rest of the last 8 bytes. */
+    VectorJournalRecord *record = (VectorJournalRecord *) (journal->buffer + journal->size);
+    memset(journal->buffer + journal->size + bytes - sizeof(uint64_t), 0, sizeof(uint64_t));
+    record->size = (uint32_t) size;
+    record->operation = operation;
+    record->count = (uint32_t) count;
+    record->position = position;
+    journal->record = journal->size;
+
+    return (char *) (record + 1);
+}
+
+/* Seals the record started last. Returns whether enough bytes were logged since the last sync for
+ * another one to be due.
+ */
+bool vector_journal_commit(VectorJournal *journal)
+{
+    VectorJournalRecord *record = (VectorJournalRecord *) (journal->buffer + journal->record);
+    size_t bytes = vector_journal_record_bytes(record->size);
+
+    record->checksum = vector_journal_checksum(record);
+
+    journal->size += bytes;
+    journal->log_size += bytes;
+    journal->unsynced += bytes;
+    return journal->sync_bytes > 0 && journal->unsynced >= journal->sync_bytes;
+}
+
+/* For modifications which can't be recorded: nothing else is logged until the next snapshot, so
+ * recovery never replays part of the history.
+ */
+void vector_journal_invalidate(VectorJournal *journal)
+{
+    journal->stale = true;
+}
+
+bool vector_journal_is_stale(const VectorJournal *journal)
+{
+    return journal->stale && !journal->failed;
+}
+
+/* Writes the buffered records, and waits for every record logged to be on disk. */
+bool vector_journal_sync(VectorJournal *journal)
+{
+    if (journal->failed || !vector_journal_flush(journal)) {
+        return false;
+    }
+
+    if (journal->unsynced > 0 && fdatasync(journal->log_fd) != 0) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to sync journal: %s. Error code: %i", journal->log_path, errno);
+        journal->failed = true;
+        return false;
+    }
+
+    journal->unsynced = 0;
+    return true;
+}
+
+/* Once the log outgrows the snapshot, replaying it costs more than writing a new snapshot did. */
+bool vector_journal_needs_compaction(const VectorJournal *journal)
+{
+    return journal->stale || journal->failed
+            || (journal->log_size >= VECTOR_JOURNAL_MIN_COMPACTION && journal->log_size > journal->snapshot_size);
+}
+
+/* Returns a file descriptor to write the new snapshot's items to, or -1. */
+int vector_journal_begin_snapshot(VectorJournal *journal)
+{
+    VectorJournalHeader header = {{0}, journal->generation + 1};
+    memcpy(header.magic, vector_journal_snapshot_magic, sizeof(header.magic));
+
+    int fd = open(journal->temporary_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd < 0 || !vector_journal_write_all(fd, &header, sizeof(header), 0) || lseek(fd, sizeof(header), SEEK_SET) < 0) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to write snapshot: %s. Error code: %i", journal->temporary_path, errno);
+
+        if (fd >= 0) {
+            close(fd);
+            unlink(journal->temporary_path);
+        }
+
+        journal->failed = true;
+        return -1;
+    }
+
+    return fd;
+}
+
+/* Replaces the snapshot with the one written to fd, and empties the log it supersedes. The rename
+ * commits the new snapshot: a crash before it leaves the old one and its log, and a crash after it
+ * a log of the old generation, which is ignored.
+ */
+bool vector_journal_end_snapshot(VectorJournal *journal, int fd, bool written)
+{
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat file;
+    written = written && fdatasync(fd) == 0 && fstat(fd, &file) == 0;
+    written = close(fd) == 0 && written;
+
+    if (!written || rename(journal->temporary_path, journal->path) != 0) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to write snapshot: %s. Error code: %i", journal->path, errno);
+        unlink(journal->temporary_path);
+        journal->failed = true;
+        return false;
+    }
+
+    vector_journal_sync_directory(journal->path);
+
+    /* Buffered records are in the snapshot too. */
+    ++journal->generation;
+    journal->snapshot_size = file.st_size;
+    journal->size = 0;
+    journal->unsynced = 0;
+    journal->stale = false;
+
+    VectorJournalHeader header = {{0}, journal->generation};
+    memcpy(header.magic, vector_journal_log_magic, sizeof(header.magic));
+
+    journal->failed = ftruncate(journal->log_fd, 0) != 0
+            || !vector_journal_write_all(journal->log_fd, &header, sizeof(header), 0)
+            || fdatasync(journal->log_fd) != 0;
+    journal->log_size = sizeof(header);
+
+    if (journal->failed) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to reset journal: %s. Error code: %i", journal->log_path, errno);
+    }
+
+    return !journal->failed;
+}
@@ -0,0 +1,644 @@
+#include "vector.h"
+#include "logger.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Items live in fixed-size blocks shared by every version that didn't modify them. A block is
+ * private to the draft stamped in owner; any other block is copied before being modified.
+ * references is only touched by writers, with the mutex held.
+ */
+typedef struct {
+    size_t references;
+    unsigned long owner;
+    size_t count; /* Initialized items. */
+    unsigned char items[];
+} VersionedBlock;
+
+struct VersionedSnapshot {
+    size_t offset;
+    size_t block_count;
+    size_t item_size;
+    VersionedBlock **blocks;
+    uint64_t retired_epoch;
+    struct VersionedSnapshot *next_retired;
+};
+
+struct VersionedVector {
+    _Atomic(VersionedSnapshot *) current;
+    VersionedSnapshot *draft;
+    unsigned long draft_generation;
+    VersionedSnapshot *retired;
+
+    /* Epoch-based reclamation: readers announce the epoch they pinned at (plus one, 0 meaning not
+     * pinned), and a retired version is only freed once every pinned reader announced a later epoch.
+     */
+    _Atomic uint64_t epoch;
+    _Atomic uint64_t *reader_epochs;
+    atomic_bool *reader_used;
+    size_t readers;
+
+    pthread_mutex_t mutex;
+    size_t item_size;
+    bool (*copy_item)(void *to, const void *from);
+    void (*free_item)(void *item);
+};
+
+/* StringVector-like item: item_size counts the \0 character. */
+typedef struct {
+    char *data;
+    size_t item_size;
+} VersionedString;
+
+static void *versioned_item(const VersionedSnapshot *snapshot, size_t position)
+{
+    const VersionedBlock *block = snapshot->blocks[position / VERSIONED_VECTOR_BLOCK_SIZE];
+    return (void *) &block->items[(position % VERSIONED_VECTOR_BLOCK_SIZE) * snapshot->item_size];
+}
+
+static void versioned_block_release(struct VersionedVector *vector, VersionedBlock *block)
+{
+    if (--block->references > 0) {
+        return;
+    }
+
+    if (vector->free_item != NULL) {
+        for (size_t i = 0; i < block->count; ++i) {
+            vector->free_item(&block->items[i * vector->item_size]);
+        }
+    }
+
+    free(block);
+}
+
+static void versioned_snapshot_release(struct VersionedVector *vector, VersionedSnapshot *snapshot)
+{
+    for (size_t i = 0; i < snapshot->block_count; ++i) {
+        versioned_block_release(vector, snapshot->blocks[i]);
+    }
+
+    free(snapshot->blocks);
+    free(snapshot);
+}
+
+static VersionedSnapshot *versioned_snapshot_create(struct VersionedVector *vector, size_t block_count)
+{
+    VersionedSnapshot *snapshot = (VersionedSnapshot *) calloc(1, sizeof(VersionedSnapshot));
+    if (snapshot == NULL) {
+        return NULL;
+    }
+
+    snapshot->blocks = (VersionedBlock **) malloc((block_count > 0 ? block_count : 1) * sizeof(VersionedBlock *));
+    if (snapshot->blocks == NULL) {
+        free(snapshot);
+        return NULL;
+    }
+
+    snapshot->block_count = block_count;
+    snapshot->item_size = vector->item_size;
+    return snapshot;
+}
+
+static struct VersionedVector *versioned_vector_create(size_t readers, size_t item_size,
+        bool (*copy_item)(void *, const void *), void (*free_item)(void *))
+{
+    struct VersionedVector *vector = (struct VersionedVector *) calloc(1, sizeof(struct VersionedVector));
+    if (vector == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for versioned vector. Error code: %i", errno);
+        return NULL;
+    }
+
+    vector->item_size = item_size;
+    vector->copy_item = copy_item;
+    vector->free_item = free_item;
+    vector->readers = readers;
+    vector->reader_epochs = (_Atomic uint64_t *) calloc(readers > 0 ? readers : 1, sizeof(*vector->reader_epochs));
+    vector->reader_used = (atomic_bool *) calloc(readers > 0 ? readers : 1, sizeof(*vector->reader_used));
+    VersionedSnapshot *empty = versioned_snapshot_create(vector, 0);
+
+    if (vector->reader_epochs == NULL || vector->reader_used == NULL || empty == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for versioned vector. Error code: %i", errno);
+        free(vector->reader_epochs);
+        free(vector->reader_used);
+        if (empty != NULL) {
+            free(empty->blocks);
+            free(empty);
+        }
+        free(vector);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < readers; ++i) {
+        atomic_init(&vector->reader_epochs[i], 0);
+        atomic_init(&vector->reader_used[i], false);
+    }
+
+    atomic_init(&vector->current, empty);
+    atomic_init(&vector->epoch, 0);
+    pthread_mutex_init(&vector->mutex, NULL);
+    return vector;
+}
+
+/* No reader may be pinned, nor writer running. */
+static void versioned_vector_destroy(struct VersionedVector *vector)
+{
+    if (vector == NULL) {
+        return;
+    }
+
+    versioned_snapshot_release(vector, atomic_load(&vector->current));
+
+    if (vector->draft != NULL) {
+        versioned_snapshot_release(vector, vector->draft);
+    }
+
+    while (vector->retired != NULL) {
+        VersionedSnapshot *next = vector->retired->next_retired;
+        versioned_snapshot_release(vector, vector->retired);
+        vector->retired = next;
+    }
+
+    pthread_mutex_destroy(&vector->mutex);
+    free(vector->reader_epochs);
+    free(vector->reader_used);
+    free(vector);
+}
+
+/* Returns the draft the next version is being built in, creating it from the current version
+ * (sharing all of its blocks) if needed. Called with the mutex held.
+ */
+static VersionedSnapshot *versioned_vector_draft(struct VersionedVector *vector)
+{
+    if (vector->draft != NULL) {
+        return vector->draft;
+    }
+
+    VersionedSnapshot *current = atomic_load_explicit(&vector->current, memory_order_relaxed);
+    VersionedSnapshot *draft = versioned_snapshot_create(vector, current->block_count);
+
+    if (draft == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for a new version. Error code: %i", errno);
+        return NULL;
+    }
+
+    draft->offset = current->offset;
+    for (size_t i = 0; i < current->block_count; ++i) {
+        draft->blocks[i] = current->blocks[i];
+        ++draft->blocks[i]->references;
+    }
+
+    vector->draft = draft;
+    ++vector->draft_generation;
+    return draft;
+}
+
+/* Makes block number index of the draft private to it, copying its first count items. */
+static VersionedBlock *versioned_vector_own_block(struct VersionedVector *vector, size_t index, size_t count)
+{
+    VersionedSnapshot *draft = vector->draft;
+    VersionedBlock *shared = draft->blocks[index];
+
+    if (shared->owner == vector->draft_generation) {
+        return shared;
+    }
+
+    VersionedBlock *block = (VersionedBlock *) malloc(sizeof(VersionedBlock) + VERSIONED_VECTOR_BLOCK_SIZE * vector->item_size);
+    if (block == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for a new block. Error code: %i", errno);
+        return NULL;
+    }
+
+    block->references = 1;
+    block->owner = vector->draft_generation;
+    block->count = 0;
+
+    for (; block->count < count; ++block->count) {
+        void *to = &block->items[block->count * vector->item_size];
+        const void *from = &shared->items[block->count * vector->item_size];
+
+        if (vector->copy_item == NULL) {
+            memcpy(to, from, vector->item_size);
+        } else if (!vector->copy_item(to, from)) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to copy block items. Error code: %i", errno);
+            ++block->references;
+            versioned_block_release(vector, block);
+            return NULL;
+        }
+    }
+
+    draft->blocks[index] = block;
+    versioned_block_release(vector, shared);
+    return block;
+}
+
+/* item is moved into the vector, it's up to the vector to free it from now on. */
+static bool versioned_vector_add(struct VersionedVector *vector, const void *item)
+{
+    pthread_mutex_lock(&vector->mutex);
+
+    VersionedSnapshot *draft = versioned_vector_draft(vector);
+    if (draft == NULL) {
+        pthread_mutex_unlock(&vector->mutex);
+        return false;
+    }
+
+    size_t index = draft->offset / VERSIONED_VECTOR_BLOCK_SIZE;
+    size_t slot = draft->offset % VERSIONED_VECTOR_BLOCK_SIZE;
+    VersionedBlock *block;
+
+    if (slot == 0) {
+        VersionedBlock **blocks = (VersionedBlock **) realloc(draft->blocks, (draft->block_count + 1) * sizeof(VersionedBlock *));
+        block = (VersionedBlock *) malloc(sizeof(VersionedBlock) + VERSIONED_VECTOR_BLOCK_SIZE * vector->item_size);
+
+        if (blocks != NULL) {
+            draft->blocks = blocks;
+        }
+
+        if (blocks == NULL || block == NULL) {
+            logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for a new block. Error code: %i", errno);
+            free(block);
+            pthread_mutex_unlock(&vector->mutex);
+            return false;
+        }
+
+        block->references = 1;
+        block->owner = vector->draft_generation;
+        block->count = 0;
+        draft->blocks[draft->block_count++] = block;
+    } else if ((block = versioned_vector_own_block(vector, index, slot)) == NULL) {
+        pthread_mutex_unlock(&vector->mutex);
+        return false;
+    }
+
+    memcpy(&block->items[slot * vector->item_size], item, vector->item_size);
+    ++block->count;
+    ++draft->offset;
+
+    pthread_mutex_unlock(&vector->mutex);
+    return true;
+}
+
+/* On success, item is moved into the vector. */
+static bool versioned_vector_replace(struct VersionedVector *vector, size_t position, const void *item)
+{
+    pthread_mutex_lock(&vector->mutex);
+
+    VersionedSnapshot *draft = versioned_vector_draft(vector);
+    if (draft == NULL || position >= draft->offset) {
+        if (draft != NULL) {
+            logger(ERROR, true, __func__, __LINE__, "There's no such item at position: %li.", position);
+        }
+
+        pthread_mutex_unlock(&vector->mutex);
+        return false;
+    }
+
+    size_t index = position / VERSIONED_VECTOR_BLOCK_SIZE;
+    VersionedBlock *block = versioned_vector_own_block(vector, index, draft->blocks[index]->count);
+
+    if (block == NULL) {
+        pthread_mutex_unlock(&vector->mutex);
+        return false;
+    }
+
+    void *old = &block->items[(position % VERSIONED_VECTOR_BLOCK_SIZE) * vector->item_size];
+    if (vector->free_item != NULL) {
+        vector->free_item(old);
+    }
+
+    memcpy(old, item, vector->item_size);
+
+    pthread_mutex_unlock(&vector->mutex);
+    return true;
+}
+
+static bool versioned_vector_pop(struct VersionedVector *vector)
+{
+    pthread_mutex_lock(&vector->mutex);
+
+    VersionedSnapshot *draft = versioned_vector_draft(vector);
+    if (draft == NULL || draft->offset == 0) {
+        pthread_mutex_unlock(&vector->mutex);
+        return false;
+    }
+
+    size_t position = draft->offset - 1;
+    size_t index = position / VERSIONED_VECTOR_BLOCK_SIZE;
+
+    if (position % VERSIONED_VECTOR_BLOCK_SIZE == 0) {
+        /* The block would be left empty, so the draft just stops referencing it. */
+        versioned_block_release(vector, draft->blocks[index]);
+        --draft->block_count;
+    } else {
+        /* Only the items staying are copied into the private block. */
+        VersionedBlock *block = versioned_vector_own_block(vector, index, position % VERSIONED_VECTOR_BLOCK_SIZE);
+
+        if (block == NULL) {
+            pthread_mutex_unlock(&vector->mutex);
+            return false;
+        }
+
+        if (block->count > position % VERSIONED_VECTOR_BLOCK_SIZE) {
+            --block->count;
+            if (vector->free_item != NULL) {
+                vector->free_item(&block->items[block->count * vector->item_size]);
+            }
+        }
+    }
+
+    --draft->offset;
+
+    pthread_mutex_unlock(&vector->mutex);
+    return true;
+}
+
+/* Frees every retired version no pinned reader can be using anymore. Called with the mutex held. */
+static void versioned_vector_reclaim(struct VersionedVector *vector)
+{
+    uint64_t oldest = UINT64_MAX;
+
+    for (size_t i = 0; i < vector->readers; ++i) {
+        uint64_t announced = atomic_load(&vector->reader_epochs[i]);
+
+        if (announced != 0 && announced - 1 < oldest) {
+            oldest = announced - 1;
+        }
+    }
+
+    VersionedSnapshot **link = &vector->retired;
+    while (*link != NULL) {
+        VersionedSnapshot *snapshot = *link;
+
+        if (snapshot->retired_epoch < oldest) {
+            *link = snapshot->next_retired;
+            versioned_snapshot_release(vector, snapshot);
+        } else {
+            link = &snapshot->next_retired;
+        }
+    }
+}
+
+static bool versioned_vector_publish(struct VersionedVector *vector)
+{
+    pthread_mutex_lock(&vector->mutex);
+
+    if (vector->draft != NULL) {
+        VersionedSnapshot *old = atomic_load_explicit(&vector->current, memory_order_relaxed);
+
+        atomic_store(&vector->current, vector->draft);
+        old->retired_epoch = atomic_fetch_add(&vector->epoch, 1);
+        old->next_retired = vector->retired;
+        vector->retired = old;
+        vector->draft = NULL;
+    }
+
+    versioned_vector_reclaim(vector);
+
+    pthread_mutex_unlock(&vector->mutex);
+    return true;
+}
+
+static bool versioned_vector_register_reader(struct VersionedVector *vector, size_t *reader)
+{
+    for (size_t i = 0; i < vector->readers; ++i) {
+        bool used = false;
+
+        if (atomic_compare_exchange_strong(&vector->reader_used[i], &used, true)) {
+            *reader = i;
+            return true;
+        }
+    }
+
+    logger(ERROR, true, __func__, __LINE__, "All %li reader slots of versioned vector: %p are taken.", vector->readers, vector);
+    return false;
+}
+
+static void versioned_vector_unregister_reader(struct VersionedVector *vector, size_t reader)
+{
+    atomic_store(&vector->reader_epochs[reader], 0);
+    atomic_store(&vector->reader_used[reader], false);
+}
+
+/* current is read after announcing the epoch, as a version retired before the announcement is
+ * visible may be freed already. Both are sequentially consistent, as are publishing and reclaiming,
+ * so either the publisher sees the announcement or the reader sees the newer version. epoch is
+ * acquired, so seeing it bumped means seeing the version that bump retired replaced too. Otherwise
+ * the reader could announce an epoch too late to keep the version it read.
+ */
+static const VersionedSnapshot *versioned_vector_pin(struct VersionedVector *vector, size_t reader)
+{
+    uint64_t epoch = atomic_load_explicit(&vector->epoch, memory_order_acquire);
+
+    atomic_store(&vector->reader_epochs[reader], epoch + 1);
+    return atomic_load(&vector->current);
+}
+
+static void versioned_vector_unpin(struct VersionedVector *vector, size_t reader)
+{
+    atomic_store_explicit(&vector->reader_epochs[reader], 0, memory_order_release);
+}
+
+static bool versioned_string_copy(void *to, const void *from)
+{
+    const VersionedString *source = (const VersionedString *) from;
+    VersionedString *destination = (VersionedString *) to;
+
+    destination->data = (char *) malloc(source->item_size);
+    if (destination->data == NULL) {
+        return false;
+    }
+
+    memcpy(destination->data, source->data, source->item_size);
+    destination->item_size = source->item_size;
+    return true;
+}
+
+static void versioned_string_free(void *item)
+{
+    free(((VersionedString *) item)->data);
+}
+
+static bool versioned_string_make(VersionedString *item, const char *value)
+{
+    size_t size = strlen(value) + 1;
+
+    item->data = (char *) malloc(size);
+    if (item->data == NULL) {
+        logger(ERROR, true, __func__, __LINE__, "Impossible to allocate memory for string value: %s. Error code: %i", value, errno);
+        return false;
+    }
+
+    memcpy(item->data, value, size);
+    item->item_size = size;
+    return true;
+}
+
+/* readers is the maximum number of threads reading at the same time. See versioned_*_register_reader(). */
+bool versioned_numeric_vector_init(VersionedNumericVector *vector, size_t readers)
+{
+    vector->versioned = versioned_vector_create(readers, sizeof(double), NULL, NULL);
+    return vector->versioned != NULL;
+}
+
+void versioned_numeric_vector_free(VersionedNumericVector *vector)
+{
+    versioned_vector_destroy(vector->versioned);
+    vector->versioned = NULL;
+}
+
+/* Writers' changes go to the next version, which readers don't see until it's published. */
+bool versioned_numeric_vector_add(VersionedNumericVector *vector, double value)
+{
+    return versioned_vector_add(vector->versioned, &value);
+}
+
+bool versioned_numeric_vector_replace(VersionedNumericVector *vector, size_t position, double new_value)
+{
+    return versioned_vector_replace(vector->versioned, position, &new_value);
+}
+
+bool versioned_numeric_vector_pop(VersionedNumericVector *vector)
+{
+    return versioned_vector_pop(vector->versioned);
+}
+
+/* Atomically makes the changes made so far the version new readers pin. */
+bool versioned_numeric_vector_publish(VersionedNumericVector *vector)
+{
+    return versioned_vector_publish(vector->versioned);
+}
+
+bool versioned_numeric_vector_register_reader(VersionedNumericVector *vector, size_t *reader)
+{
+    return versioned_vector_register_reader(vector->versioned, reader);
+}
+
+void versioned_numeric_vector_unregister_reader(VersionedNumericVector *vector, size_t reader)
+{
+    versioned_vector_unregister_reader(vector->versioned, reader);
+}
+
+/* Returns the latest published version, which stays valid until versioned_numeric_vector_unpin().
+ * Reading it takes neither locks nor atomics.
+ */
+const VersionedSnapshot *versioned_numeric_vector_pin(VersionedNumericVector *vector, size_t reader)
+{
+    return versioned_vector_pin(vector->versioned, reader);
+}
+
+void versioned_numeric_vector_unpin(VersionedNumericVector *vector, size_t reader)
+{
+    versioned_vector_unpin(vector->versioned, reader);
+}
+
+size_t versioned_snapshot_get_size(const VersionedSnapshot *snapshot)
+{
+    return snapshot->offset;
+}
+
+/* Returns -1 on failure, e.g., position >= snapshot bounds. */
+double versioned_numeric_snapshot_get_at(const VersionedSnapshot *snapshot, size_t position)
+{
+    if (position >= snapshot->offset) {
+        return -1;
+    }
+
+    return *(const double *) versioned_item(snapshot, position);
+}
+
+bool versioned_string_vector_init(VersionedStringVector *vector, size_t readers)
+{
+    vector->versioned = versioned_vector_create(readers, sizeof(VersionedString), versioned_string_copy, versioned_string_free);
+    return vector->versioned != NULL;
+}
+
+void versioned_string_vector_free(VersionedStringVector *vector)
+{
+    versioned_vector_destroy(vector->versioned);
+    vector->versioned = NULL;
+}
+
+bool versioned_string_vector_add(VersionedStringVector *vector, const char *value)
+{
+    VersionedString item;
+
+    if (!versioned_string_make(&item, value)) {
+        return false;
+    }
+
+    if (!versioned_vector_add(vector->versioned, &item)) {
+        free(item.data);
+        return false;
+    }
+
+    return true;
+}
+
+bool versioned_string_vector_replace(VersionedStringVector *vector, size_t position, const char *new_value)
+{
+    VersionedString item;
+
+    if (!versioned_string_make(&item, new_value)) {
+        return false;
+    }
+
+    if (!versioned_vector_replace(vector->versioned, position, &item)) {
+        free(item.data);
+        return false;
+    }
+
+    return true;
+}
+
+bool versioned_string_vector_pop(VersionedStringVector *vector)
+{
+    return versioned_vector_pop(vector->versioned);
+}
+
+bool versioned_string_vector_publish(VersionedStringVector *vector)
+{
+    return versioned_vector_publish(vector->versioned);
+}
+
+bool versioned_string_vector_register_reader(VersionedStringVector *vector, size_t *reader)
+{
+    return versioned_vector_register_reader(vector->versioned, reader);
+}
+
+void versioned_string_vector_unregister_reader(VersionedStringVector *vector, size_t reader)
+{
+    versioned_vector_unregister_reader(vector->versioned, reader);
+}
+
+const VersionedSnapshot *versioned_string_vector_pin(VersionedStringVector *vector, size_t reader)
+{
+    return versioned_vector_pin(vector->versioned, reader);
+}
+
+void versioned_string_vector_unpin(VersionedStringVector *vector, size_t reader)
+{
+    versioned_vector_unpin(vector->versioned, reader);
+}
+
+/* Returns NULL on failure, e.g., position >= snapshot bounds. */
+const char *versioned_string_snapshot_get_at(const VersionedSnapshot *snapshot, size_t position)
+{
+    if (position >= snapshot->offset) {
+        return NULL;
+    }
+
+    return ((const VersionedString *) versioned_item(snapshot, position))->data;
+}
+
+size_t versioned_string_snapshot_strlen(const VersionedSnapshot *snapshot, size_t position)
+{
+    if (position >= snapshot->offset) {
+        return 0;
+    }
+
+    return ((const VersionedString *) versioned_item(snapshot, position))->item_size - 1;
+}
@@ -0,0 +1,189 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector.h>
+
+/* The executable's malloc() and friends take precedence over libc's, for libvector too, so every
+ * allocation it makes is counted here before being handed over to glibc.
+ */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *pointer);
+
+static _Atomic size_t allocations;
+static _Atomic size_t allocated_bytes;
+static _Atomic size_t frees;
+static bool failed = false;
+
+void *malloc(size_t size)
+{
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&allocated_bytes, size, memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&allocated_bytes, count * size, memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size)
+{
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&allocated_bytes, size, memory_order_relaxed);
+    return __libc_realloc(pointer, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&allocated_bytes, size, memory_order_relaxed);
+    return __libc_memalign(alignment, size);
+}
+
+void free(void *pointer)
+{
+    if (pointer != NULL) {
+        atomic_fetch_add_explicit(&frees, 1, memory_order_relaxed);
+    }
+
+    __libc_free(pointer);
+}
+
+static void reset(void)
+{
+    atomic_store(&allocations, 0);
+    atomic_store(&allocated_bytes, 0);
+    atomic_store(&frees, 0);
+}
+
+/* Checks the allocations made since the last reset() against their upper bounds. */
+static void expect(const char *operation, bool succeeded, size_t max_allocations, size_t max_bytes)
+{
+    size_t made = atomic_load(&allocations);
+    size_t bytes = atomic_load(&allocated_bytes);
+
+    printf("[TEST]: %s: %li allocations, %li bytes.\n", operation, made, bytes);
+
+    if (succeeded && made <= max_allocations && bytes <= max_bytes) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(
+                stderr, "[TEST]: Failed! Expected at most %li allocations and %li bytes.\n",
+                max_allocations, max_bytes
+        );
+        failed = true;
+    }
+
+    reset();
+}
+
+static void numeric_vector_allocations(void)
+{
+    NumericVector vector;
+    NumericVector copy;
+    double values[100];
+
+    for (int i = 0; i < 100; ++i) {
+        values[i] = i;
+    }
+
+    reset();
+    expect("numeric_vector_init()", numeric_vector_init(&vector, 100), 1, 100 * sizeof(double));
+    expect("numeric_vector_add() with room", numeric_vector_add(&vector, 1), 0, 0);
+    expect("numeric_vector_add_array() with room", numeric_vector_add_array(&vector, values, 99), 0, 0);
+    expect("numeric_vector_add() when full", numeric_vector_add(&vector, 1), 1, 110 * sizeof(double));
+    expect("numeric_vector_get_at()", numeric_vector_get_at(&vector, 50) == 49, 0, 0);
+    expect("numeric_vector_insert() with room", numeric_vector_insert(&vector, 2, 50), 0, 0);
+    /* Erasing copies the items kept into a new array. */
+    expect("numeric_vector_erase()", numeric_vector_erase(&vector, 10, 10), 1, 100 * sizeof(double));
+    expect("numeric_vector_reserve()", numeric_vector_reserve(&vector, 100), 1, 210 * sizeof(double));
+    expect("numeric_vector_shrink_to_fit()", numeric_vector_shrink_to_fit(&vector), 1, 92 * sizeof(double));
+    expect("numeric_vector_copy() sharing", numeric_vector_copy(&vector, &copy, true), 1, sizeof(size_t));
+    expect("numeric_vector_add() to a shared vector", numeric_vector_add(&copy, 3), 2, 102 * sizeof(double));
+
+    numeric_vector_free(&copy);
+    reset();
+    expect("numeric_vector_copy() into an initialized vector", numeric_vector_init(&copy, 100)
+            && numeric_vector_copy(&vector, &copy, false), 1, 100 * sizeof(double));
+
+    numeric_vector_free(&copy);
+    numeric_vector_free(&vector);
+    expect("numeric_vector_free()", true, 0, 0);
+}
+
+static void string_vector_allocations(void)
+{
+    StringVector vector;
+    StringVector copy;
+    const char *values[100];
+
+    for (int i = 0; i < 100; ++i) {
+        values[i] = "value";
+    }
+
+    reset();
+    expect("string_vector_init()", string_vector_init(&vector, 100), 2, 100 * (sizeof(char *) + sizeof(size_t)));
+    expect("string_vector_add() with room", string_vector_add(&vector, "value"), 1, 6);
+    expect("string_vector_add_array() with room", string_vector_add_array(&vector, values, 99), 4, 99 * 6 + 72);
+    expect("string_vector_add() when full", string_vector_add(&vector, "value"), 3, 110 * (sizeof(char *) + sizeof(size_t)) + 6);
+    expect("string_vector_get_at()", strcmp(string_vector_get_at(&vector, 50), "value") == 0, 0, 0);
+    expect("string_vector_insert() with room", string_vector_insert(&vector, "inserted", 50), 1, 9);
+    expect("string_vector_replace() fitting in place", string_vector_replace(&vector, 50, "replace"), 0, 0);
+    expect("string_vector_replace() not fitting", string_vector_replace(&vector, 50, "a longer value"), 1, 15);
+    expect("string_vector_erase()", string_vector_erase(&vector, 10, 10), 2, 100 * (sizeof(char *) + sizeof(size_t)));
+
+    char *popped = string_vector_pop(&vector);
+    expect("string_vector_pop() of an item of its own", popped != NULL, 0, 0);
+    free(popped);
+    reset();
+
+    expect("string_vector_copy() sharing", string_vector_copy(&vector, &copy, true), 1, sizeof(size_t));
+    expect("string_vector_add() to a shared vector", string_vector_add(&copy, "value"), 7, 2400);
+
+    string_vector_free(&copy);
+    reset();
+    expect("string_vector_clear_retaining()", string_vector_clear_retaining(&vector, 1024), 1, 100 * sizeof(size_t));
+    expect("string_vector_add() reusing a slot", string_vector_add(&vector, "value"), 0, 0);
+
+    string_vector_free(&vector);
+    expect("string_vector_free()", true, 0, 0);
+
+    StringPool *pool = string_pool_create(false);
+    bool pooled = pool != NULL && string_vector_init(&vector, 100) && string_vector_use_pool(&vector, pool);
+    string_pool_release(pool);
+
+    for (int i = 0; pooled && i < 100; ++i) {
+        pooled = string_vector_add(&vector, "value");
+    }
+
+    for (int i = 0; pooled && i < 100; ++i) {
+        pooled = string_vector_erase(&vector, 0, 1);
+    }
+
+    pooled = pooled && string_vector_reserve(&vector, 100);
+    reset();
+    for (int i = 0; pooled && i < 100; ++i) {
+        pooled = string_vector_add(&vector, "value");
+    }
+
+    expect("100 string_vector_add() from a warm StringPool", pooled, 0, 0);
+    string_vector_free(&vector);
+    reset();
+}
+
+int main(void)
+{
+    printf("[TEST]: Counting allocations made by %s.\n", libvector_version());
+
+    numeric_vector_allocations();
+    string_vector_allocations();
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -1,6 +1,116 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <vector.h>
 
+#define CONCURRENT_THREADS 4
+#define CONCURRENT_READERS 2
+#define CONCURRENT_ADDS 10000
+#define VERSIONED_ITEMS 1000
+
+static void *add_concurrently(void *vector)
+{
+    for (int i = 1; i <= CONCURRENT_ADDS; ++i) {
+        concurrent_numeric_vector_add((ConcurrentNumericVector *) vector, i);
+    }
+
+    return NULL;
+}
+
+typedef struct {
+    ConcurrentNumericVector *vector;
+    atomic_bool *adding;
+    bool ok;
+} ConcurrentReader;
+
+/* Every number a reader can see must be written already, and adds only write 1 to CONCURRENT_ADDS. */
+static bool concurrent_numbers_written(const double *numbers, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        if (numbers[i] < 1 || numbers[i] > CONCURRENT_ADDS) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void *read_concurrently(void *arg)
+{
+    ConcurrentReader *reader = (ConcurrentReader *) arg;
+    size_t seen = 0;
+
+    while (atomic_load(reader->adding)) {
+        size_t size = concurrent_numeric_vector_get_size(reader->vector);
+
+        for (; seen < size && reader->ok; ++seen) {
+            double number = concurrent_numeric_vector_get_at(reader->vector, seen);
+            reader->ok = concurrent_numbers_written(&number, 1);
+        }
+    }
+
+    return NULL;
+}
+
+static double square(double value, void *context)
+{
+    (void) context;
+    return value * value;
+}
+
+static double sum(double accumulator, double value, void *context)
+{
+    (void) context;
+    return accumulator + value;
+}
+
+static void count_success(void *context, bool succeeded)
+{
+    *(int *) context += succeeded ? 1 : 0;
+}
+
+/* Adds 1..CONCURRENT_ADDS, in ascending order, to a shard of its own. */
+static void *add_to_shard(void *vector)
+{
+    NumericVector *shard = sharded_numeric_vector_claim_shard((ShardedNumericVector *) vector);
+
+    for (int i = 1; shard != NULL && i <= CONCURRENT_ADDS; ++i) {
+        numeric_vector_add(shard, i);
+    }
+
+    return NULL;
+}
+
+/* Every published version holds VERSIONED_ITEMS copies of the same value. */
+static void *read_versions(void *vector)
+{
+    VersionedNumericVector *versioned = (VersionedNumericVector *) vector;
+    size_t reader;
+    long inconsistent = 0;
+
+    if (!versioned_numeric_vector_register_reader(versioned, &reader)) {
+        return (void *) 1;
+    }
+
+    for (int i = 0; i < 2000; ++i) {
+        const VersionedSnapshot *snapshot = versioned_numeric_vector_pin(versioned, reader);
+        double first = versioned_numeric_snapshot_get_at(snapshot, 0);
+
+        for (size_t j = 0; j < versioned_snapshot_get_size(snapshot); ++j) {
+            inconsistent += versioned_numeric_snapshot_get_at(snapshot, j) != first;
+        }
+
+        versioned_numeric_vector_unpin(versioned, reader);
+    }
+
+    versioned_numeric_vector_unregister_reader(versioned, reader);
+    return (void *) inconsistent;
+}
+
 int main(void)
 {
     printf("Running %s.\n", libvector_version());
@@ -192,6 +302,421 @@ int main(void)
         fprintf(stderr, "[TEST]: Failed!\n");
     }
 
+    printf("[TEST]: Adding to ConcurrentNumericVector from %i threads while %i read it.\n", CONCURRENT_THREADS, CONCURRENT_READERS);
+    ConcurrentNumericVector shared;
+    NumericVector frozen;
+    NumericVector partial;
+    pthread_t threads[CONCURRENT_THREADS];
+    pthread_t reader_threads[CONCURRENT_READERS];
+    ConcurrentReader concurrent_readers[CONCURRENT_READERS];
+    atomic_bool adding = true;
+    concurrent_numeric_vector_init(&shared, 3);
+    for (int i = 0; i < CONCURRENT_READERS; ++i) {
+        concurrent_readers[i] = (ConcurrentReader) { &shared, &adding, true };
+        pthread_create(&reader_threads[i], NULL, read_concurrently, &concurrent_readers[i]);
+    }
+    for (int i = 0; i < CONCURRENT_THREADS; ++i) {
+        pthread_create(&threads[i], NULL, add_concurrently, &shared);
+    }
+
+    bool readers_ok = concurrent_numeric_vector_snapshot(&shared, &partial)
+        && concurrent_numbers_written(partial.data, partial.offset);
+    numeric_vector_free(&partial);
+
+    for (int i = 0; i < CONCURRENT_THREADS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    atomic_store(&adding, false);
+    for (int i = 0; i < CONCURRENT_READERS; ++i) {
+        pthread_join(reader_threads[i], NULL);
+        readers_ok = readers_ok && concurrent_readers[i].ok;
+    }
+
+    if (readers_ok && concurrent_numeric_vector_freeze(&shared, &frozen)) {
+        double sum = 0;
+        for (size_t i = 0; i < frozen.offset; ++i) {
+            sum += numeric_vector_get_at(&frozen, i);
+        }
+
+        if (frozen.offset == CONCURRENT_THREADS * CONCURRENT_ADDS
+            && sum == CONCURRENT_THREADS * (CONCURRENT_ADDS * (CONCURRENT_ADDS + 1.0) / 2))
+        {
+            printf("[TEST]: Passed!\n");
+        } else {
+            fprintf(stderr, "[TEST]: Failed!\n");
+            return 1;
+        }
+
+        numeric_vector_free(&frozen);
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    printf("[TEST]: Mapping and reducing NumericVector in parallel.\n");
+    NumericVector big;
+    numeric_vector_init(&big, 1000000);
+    for (int i = 0; i < 1000000; ++i) {
+        numeric_vector_add(&big, i % 100);
+    }
+
+    double parallel_sum = 0;
+    double serial_sum = 0;
+    double two_threads_sum = 0;
+    for (size_t i = 0; i < big.offset; ++i) {
+        serial_sum += big.data[i] * big.data[i];
+    }
+
+    if (numeric_vector_parallel_map(&big, square, NULL)
+        && numeric_vector_parallel_reduce(&big, sum, 0, NULL, &parallel_sum)
+        && libvector_set_threads(2)
+        && numeric_vector_parallel_reduce(&big, sum, 0, NULL, &two_threads_sum)
+        && parallel_sum == serial_sum && two_threads_sum == parallel_sum)
+    {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    libvector_set_threads(0);
+    numeric_vector_free(&big);
+
+    printf("[TEST]: Merging ShardedNumericVector shards.\n");
+    ShardedNumericVector sharded;
+    NumericVector merged;
+    NumericVector merged_sorted;
+    bool sharded_ok = sharded_numeric_vector_init(&sharded, CONCURRENT_THREADS, 16);
+
+    for (int i = 0; sharded_ok && i < CONCURRENT_THREADS; ++i) {
+        pthread_create(&threads[i], NULL, add_to_shard, &sharded);
+    }
+    for (int i = 0; sharded_ok && i < CONCURRENT_THREADS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    sharded_ok = sharded_ok && sharded_numeric_vector_claim_shard(&sharded) == NULL
+        && sharded_numeric_vector_get_size(&sharded) == CONCURRENT_THREADS * CONCURRENT_ADDS
+        && sharded_numeric_vector_merge(&sharded, &merged, true)
+        && sharded_numeric_vector_merge_sorted(&sharded, &merged_sorted, true);
+
+    for (size_t i = 0; sharded_ok && i < CONCURRENT_THREADS * CONCURRENT_ADDS; ++i) {
+        sharded_ok = numeric_vector_get_at(&merged, i) == i % CONCURRENT_ADDS + 1
+            && numeric_vector_get_at(&merged_sorted, i) == i / CONCURRENT_THREADS + 1;
+    }
+
+    if (sharded_ok && merged.offset == CONCURRENT_THREADS * CONCURRENT_ADDS) {
+        printf("[TEST]: Passed!\n");
+        numeric_vector_free(&merged);
+        numeric_vector_free(&merged_sorted);
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    sharded_numeric_vector_free(&sharded);
+
+    printf("[TEST]: Reading VersionedNumericVector while publishing new versions.\n");
+    VersionedNumericVector versioned;
+    pthread_t readers[CONCURRENT_THREADS];
+    bool versioned_ok = versioned_numeric_vector_init(&versioned, CONCURRENT_THREADS);
+
+    for (int i = 0; versioned_ok && i < VERSIONED_ITEMS; ++i) {
+        versioned_ok = versioned_numeric_vector_add(&versioned, 0);
+    }
+
+    versioned_ok = versioned_ok && versioned_numeric_vector_publish(&versioned);
+    for (int i = 0; i < CONCURRENT_THREADS; ++i) {
+        pthread_create(&readers[i], NULL, read_versions, &versioned);
+    }
+
+    for (int value = 1; versioned_ok && value <= 200; ++value) {
+        for (size_t i = 0; versioned_ok && i < VERSIONED_ITEMS; ++i) {
+            versioned_ok = versioned_numeric_vector_replace(&versioned, i, value);
+        }
+
+        versioned_ok = versioned_ok && versioned_numeric_vector_publish(&versioned);
+    }
+
+    for (int i = 0; i < CONCURRENT_THREADS; ++i) {
+        void *inconsistent;
+        pthread_join(readers[i], &inconsistent);
+        versioned_ok = versioned_ok && inconsistent == NULL;
+    }
+
+    versioned_ok = versioned_ok && versioned_numeric_vector_pop(&versioned) && versioned_numeric_vector_publish(&versioned);
+
+    size_t reader;
+    if (versioned_ok && versioned_numeric_vector_register_reader(&versioned, &reader)) {
+        const VersionedSnapshot *snapshot = versioned_numeric_vector_pin(&versioned, reader);
+        versioned_ok = versioned_snapshot_get_size(snapshot) == VERSIONED_ITEMS - 1
+            && versioned_numeric_snapshot_get_at(snapshot, VERSIONED_ITEMS - 2) == 200
+            && versioned_numeric_snapshot_get_at(snapshot, VERSIONED_ITEMS - 1) == -1;
+        versioned_numeric_vector_unpin(&versioned, reader);
+        versioned_numeric_vector_unregister_reader(&versioned, reader);
+    } else {
+        versioned_ok = false;
+    }
+
+    if (versioned_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    versioned_numeric_vector_free(&versioned);
+
+    printf("[TEST]: Sharing NumericVector's data until a copy is modified.\n");
+    NumericVector original;
+    NumericVector snapshot;
+    size_t shared_before, materialized_before, shared_after, materialized_after;
+    libvector_get_copy_stats(&shared_before, &materialized_before);
+
+    bool cow_ok = numeric_vector_init(&original, 4) && numeric_vector_add(&original, 1) && numeric_vector_add(&original, 2)
+        && numeric_vector_copy(&original, &snapshot, true) && snapshot.data == original.data
+        && numeric_vector_replace(&original, 0, 10) && snapshot.data != original.data
+        && numeric_vector_get_at(&snapshot, 0) == 1 && numeric_vector_get_at(&original, 0) == 10
+        && numeric_vector_add(&snapshot, 3) && snapshot.offset == 3 && original.offset == 2;
+
+    libvector_get_copy_stats(&shared_after, &materialized_after);
+    if (cow_ok && shared_after == shared_before + 1 && materialized_after == materialized_before + 1) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    numeric_vector_free(&original);
+    numeric_vector_free(&snapshot);
+
+    printf("[TEST]: Moving and releasing NumericVector's items.\n");
+    NumericVector movable;
+    NumericVector moved;
+    size_t released_size = 0;
+    bool move_ok = numeric_vector_init(&movable, 2) && numeric_vector_add(&movable, 4) && numeric_vector_add(&movable, 2)
+        && numeric_vector_move(&movable, &moved) && movable.data == NULL && moved.offset == 2;
+
+    double *released = move_ok ? numeric_vector_release(&moved, &released_size) : NULL;
+    if (move_ok && released != NULL && released_size == 2 && released[0] == 4 && released[1] == 2 && moved.data == NULL) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    free(released);
+
+    printf("[TEST]: Parsing numbers from a buffer and a pipe into NumericVector.\n");
+    NumericVector parsed;
+    const char text[] = "1.5, -2e3\n 0.1,,7\r\n3.141592653589793238462643383279 -inf,4.9e-324";
+    double expected[] = { 1.5, -2e3, 0.1, 7, 3.141592653589793238462643383279, -INFINITY, 4.9e-324 };
+    int pipe_fds[2];
+
+    bool parse_ok = numeric_vector_init(&parsed, 2) && numeric_vector_parse(&parsed, text, sizeof(text) - 1, ',')
+        && parsed.offset == 7 && memcmp(parsed.data, expected, sizeof(expected)) == 0
+        && !numeric_vector_parse(&parsed, "8,9,x", 5, ',') && parsed.offset == 7
+        && pipe(pipe_fds) == 0 && write(pipe_fds[1], "10 11\n", 6) == 6 && close(pipe_fds[1]) == 0
+        && numeric_vector_parse_fd(&parsed, pipe_fds[0], ' ') && close(pipe_fds[0]) == 0
+        && parsed.offset == 9 && numeric_vector_get_at(&parsed, 8) == 11;
+
+    if (parse_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    numeric_vector_free(&parsed);
+
+    printf("[TEST]: Writing NumericVector's numbers to a pipe.\n");
+    NumericVector written;
+    VectorWriteOptions csv = { ",", "\n", false, 0 };
+    VectorWriteOptions two_decimals = { " ", "", true, 2 };
+    char output[256] = {0};
+    ssize_t output_size = 0;
+
+    bool write_ok = numeric_vector_init(&written, 5) && numeric_vector_add(&written, 0.1) && numeric_vector_add(&written, 1e21)
+        && numeric_vector_add(&written, -2.5) && numeric_vector_add(&written, 1.0 / 3) && numeric_vector_add(&written, 5e-324)
+        && pipe(pipe_fds) == 0 && numeric_vector_write(&written, pipe_fds[1], &csv)
+        && numeric_vector_write(&written, pipe_fds[1], &two_decimals) && close(pipe_fds[1]) == 0
+        && (output_size = read(pipe_fds[0], output, sizeof(output) - 1)) > 0 && close(pipe_fds[0]) == 0
+        && strcmp(output, "0.1,1e+21,-2.5,0.3333333333333333,5e-324\n0.10 1000000000000000000000.00 -2.50 0.33 0.00") == 0
+        && numeric_vector_parse(&written, output, strchr(output, '\n') - output, ',')
+        && memcmp(written.data, written.data + 5, 5 * sizeof(double)) == 0;
+
+    if (write_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    numeric_vector_free(&written);
+
+    /* Both ways of doing the transfers: io_uring when the kernel allows it, and threads. */
+    for (int threads_only = 0; threads_only <= 1; ++threads_only) {
+        printf("[TEST]: Saving and loading NumericVectors asynchronously, %s.\n", threads_only ? "with threads" : "with io_uring if available");
+        NumericVector saved;
+        NumericVector loaded;
+        NumericVector loaded_later;
+        char saved_path[] = "/tmp/libvector_save_XXXXXX";
+        int saved_fd = mkstemp(saved_path);
+        VectorIO *io = vector_io_create(8, threads_only);
+        uint64_t first_size = 0;
+        uint64_t second_size = 0;
+        uint64_t loaded_size = 0;
+        int succeeded = 0;
+
+        bool save_ok = saved_fd >= 0 && io != NULL && numeric_vector_init(&saved, 1000) && numeric_vector_init(&loaded, 1)
+            && numeric_vector_init(&loaded_later, 1) && numeric_vector_add(&loaded_later, 7);
+        for (int i = 0; save_ok && i < 1000; ++i) {
+            save_ok = numeric_vector_add(&saved, i * 0.5);
+        }
+
+        /* The first save keeps the numbers it was given, even though they're changed right after. */
+        save_ok = save_ok && numeric_vector_save_async(io, &saved, saved_fd, 0, &first_size, count_success, &succeeded)
+            && numeric_vector_replace(&saved, 0, -1) && numeric_vector_pop(&saved) == 999 * 0.5
+            && numeric_vector_save_async(io, &saved, saved_fd, first_size, &second_size, count_success, &succeeded)
+            && vector_io_poll(io, true) == 2 && succeeded == 2
+            && numeric_vector_load_async(io, &loaded, saved_fd, 0, &loaded_size, count_success, &succeeded)
+            && numeric_vector_load_async(io, &loaded_later, saved_fd, first_size, NULL, count_success, &succeeded)
+            && vector_io_poll(io, true) == 4 && succeeded == 4 && loaded_size == first_size
+            && loaded.offset == 1000 && numeric_vector_get_at(&loaded, 0) == 0 && numeric_vector_get_at(&loaded, 999) == 999 * 0.5
+            && loaded_later.offset == 1000 && numeric_vector_get_at(&loaded_later, 0) == 7 && numeric_vector_get_at(&loaded_later, 1) == -1
+            && memcmp(loaded_later.data + 2, saved.data + 1, 998 * sizeof(double)) == 0
+            && !numeric_vector_load_async(io, &loaded, saved_fd, 4, NULL, NULL, NULL)
+            && numeric_vector_load_async(io, &loaded, saved_fd, 4, NULL, count_success, &succeeded)
+            && vector_io_poll(io, true) == 1 && succeeded == 4 && loaded.offset == 1000;
+
+        vector_io_destroy(io);
+        if (saved_fd >= 0) {
+            close(saved_fd);
+            unlink(saved_path);
+        }
+
+        if (save_ok) {
+            printf("[TEST]: Passed!\n");
+        } else {
+            fprintf(stderr, "[TEST]: Failed!\n");
+            return 1;
+        }
+
+        numeric_vector_free(&saved);
+        numeric_vector_free(&loaded);
+        numeric_vector_free(&loaded_later);
+    }
+
+    printf("[TEST]: Recovering NumericVector from its journal.\n");
+    NumericVector journaled;
+    NumericVector recovered;
+    char journal_directory[] = "/tmp/libvector_journal_XXXXXX";
+    char journal_path[64] = {0};
+    char log_path[64] = {0};
+    double journal_numbers[] = { 1.5, 2.5, 3.5 };
+    size_t before_torn = 0;
+
+    bool journal_ok = mkdtemp(journal_directory) != NULL
+        && snprintf(journal_path, sizeof(journal_path), "%s/numbers", journal_directory) > 0
+        && snprintf(log_path, sizeof(log_path), "%s.log", journal_path) > 0
+        && numeric_vector_init(&journaled, 4) && numeric_vector_open_journal(&journaled, journal_path, 4096)
+        && journaled.offset == 0 && !numeric_vector_open_journal(&journaled, journal_path, 0);
+    for (int i = 0; journal_ok && i < 100; ++i) {
+        journal_ok = numeric_vector_add(&journaled, i);
+    }
+
+    /* Every kind of record, replayed after reopening. */
+    journal_ok = journal_ok && numeric_vector_add_array(&journaled, journal_numbers, 3) && numeric_vector_insert(&journaled, -5, 5)
+        && numeric_vector_replace(&journaled, 0, -1) && numeric_vector_erase(&journaled, 10, 5) && numeric_vector_pop(&journaled) == 3.5
+        && numeric_vector_parse(&journaled, "7 8 9", 5, ' ') && numeric_vector_close_journal(&journaled)
+        && numeric_vector_init(&recovered, 1) && numeric_vector_open_journal(&recovered, journal_path, 0)
+        && recovered.offset == journaled.offset && recovered.offset == 100 + 3 + 1 - 5 - 1 + 3
+        && memcmp(recovered.data, journaled.data, recovered.offset * sizeof(double)) == 0;
+
+    /* Mapping can't be logged, so a snapshot is written by the next modification. */
+    journal_ok = journal_ok && numeric_vector_compact_journal(&recovered) && numeric_vector_add(&recovered, 10)
+        && numeric_vector_parallel_map(&recovered, square, NULL) && numeric_vector_add(&recovered, 11)
+        && numeric_vector_clear(&journaled) && numeric_vector_copy(&recovered, &journaled, false)
+        && numeric_vector_close_journal(&recovered) && numeric_vector_clear(&recovered)
+        && numeric_vector_open_journal(&recovered, journal_path, 0) && recovered.offset == journaled.offset
+        && memcmp(recovered.data, journaled.data, recovered.offset * sizeof(double)) == 0;
+
+    /* A record torn by a crash is dropped, along with whatever follows it. */
+    before_torn = recovered.offset;
+    journal_ok = journal_ok && numeric_vector_add(&recovered, 12) && numeric_vector_sync_journal(&recovered)
+        && numeric_vector_close_journal(&recovered) && truncate(log_path, 8 + 8 + 24 + 8 - 3) == 0
+        && numeric_vector_clear(&recovered) && numeric_vector_open_journal(&recovered, journal_path, 0)
+        && recovered.offset == before_torn && numeric_vector_add(&recovered, 13) && numeric_vector_close_journal(&recovered)
+        && numeric_vector_clear(&recovered) && numeric_vector_open_journal(&recovered, journal_path, 0)
+        && recovered.offset == before_torn + 1 && numeric_vector_get_last(&recovered) == 13;
+
+    /* Clearing a ShardedNumericVector clears the journals of its shards too. */
+    ShardedNumericVector journaled_shards;
+    char shard_path[64] = {0};
+    char shard_log_path[64] = {0};
+    NumericVector *journaled_shard = NULL;
+
+    journal_ok = journal_ok && snprintf(shard_path, sizeof(shard_path), "%s/shard", journal_directory) > 0
+        && snprintf(shard_log_path, sizeof(shard_log_path), "%s.log", shard_path) > 0
+        && sharded_numeric_vector_init(&journaled_shards, 2, 4)
+        && (journaled_shard = sharded_numeric_vector_get_shard(&journaled_shards, 0)) != NULL
+        && numeric_vector_open_journal(journaled_shard, shard_path, 0) && numeric_vector_add(journaled_shard, 1)
+        && numeric_vector_add(journaled_shard, 2) && sharded_numeric_vector_clear(&journaled_shards)
+        && numeric_vector_add(journaled_shard, 3) && numeric_vector_close_journal(journaled_shard)
+        && numeric_vector_close_journal(&recovered) && numeric_vector_clear(&recovered)
+        && numeric_vector_open_journal(&recovered, shard_path, 0)
+        && recovered.offset == 1 && numeric_vector_get_first(&recovered) == 3 && numeric_vector_close_journal(&recovered);
+
+    if (journaled_shard != NULL) {
+        sharded_numeric_vector_free(&journaled_shards);
+    }
+
+    unlink(shard_path);
+    unlink(shard_log_path);
+
+    if (journal_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    numeric_vector_free(&journaled);
+    numeric_vector_free(&recovered);
+    unlink(journal_path);
+    unlink(log_path);
+    rmdir(journal_directory);
+
+    printf("[TEST]: Reserving spaces in a partly filled NumericVector.\n");
+    NumericVector partly_filled;
+
+    /* Only the items added are kept, not the whole capacity. */
+    bool reserve_ok = numeric_vector_init(&partly_filled, 10) && numeric_vector_add(&partly_filled, 1)
+        && numeric_vector_add(&partly_filled, 2) && numeric_vector_add(&partly_filled, 3)
+        && numeric_vector_reserve(&partly_filled, 5) && partly_filled.offset == 3 && partly_filled.capacity == 15
+        && numeric_vector_get_at(&partly_filled, 0) == 1 && numeric_vector_get_last(&partly_filled) == 3
+        && numeric_vector_add(&partly_filled, 4) && partly_filled.offset == 4 && numeric_vector_get_at(&partly_filled, 3) == 4;
+
+    /* Neither an empty vector nor a full one gets items it wasn't given. */
+    NumericVector empty_reserved, full_reserved;
+    reserve_ok = reserve_ok && numeric_vector_init(&empty_reserved, 4) && numeric_vector_reserve(&empty_reserved, 4)
+        && empty_reserved.offset == 0 && empty_reserved.capacity == 8 && numeric_vector_init(&full_reserved, 2)
+        && numeric_vector_add(&full_reserved, 5) && numeric_vector_add(&full_reserved, 6)
+        && numeric_vector_reserve(&full_reserved, 1) && full_reserved.offset == 2 && full_reserved.capacity == 3
+        && numeric_vector_get_last(&full_reserved) == 6;
+
+    numeric_vector_free(&empty_reserved);
+    numeric_vector_free(&full_reserved);
+
+    if (reserve_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    numeric_vector_free(&partly_filled);
+
     printf("[TEST]: Clearing vector.\n");
     if (numeric_vector_clear(&numbers)) {
         printf("[TEST]: Passed!\n");
@@ -1,7 +1,14 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <vector.h>
 
+static void count_success(void *context, bool succeeded)
+{
+    *(int *) context += succeeded ? 1 : 0;
+}
+
 int main(void)
 {
     printf("Running %s.\n", libvector_version());
@@ -185,6 +192,782 @@ int main(void)
         fprintf(stderr, "[TEST]: Shrink failed. Can't proceed!\n");
     }
 
+    printf("[TEST]: Erasing ranges that aren't at the tail, or run past it, from a shrunk StringVector.\n");
+    StringVector letters;
+    const char *some_letters[] = { "a", "b", "c", "d", "e" };
+    bool erase_ok = string_vector_init(&letters, 5) && string_vector_add_array(&letters, some_letters, 5)
+        && string_vector_shrink_to_fit(&letters) && string_vector_erase(&letters, 1, 2)
+        && letters.offset == 3 && letters.capacity >= 3 && strcmp(string_vector_get_at(&letters, 1), "d") == 0
+        && strcmp(string_vector_get_at(&letters, 2), "e") == 0 && string_vector_erase(&letters, 1, 2)
+        && letters.offset == 1 && letters.capacity >= 1 && string_vector_add(&letters, "f")
+        && strcmp(string_vector_get_at(&letters, 1), "f") == 0;
+
+    StringVector tail;
+    erase_ok = erase_ok && string_vector_init(&tail, 5) && string_vector_add_array(&tail, some_letters, 5)
+        && string_vector_shrink_to_fit(&tail) && string_vector_erase(&tail, 3, 4) && tail.offset == 3
+        && tail.capacity >= 3 && strcmp(string_vector_get_at(&tail, 2), "c") == 0;
+
+    string_vector_free(&letters);
+    string_vector_free(&tail);
+
+    if (erase_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    printf("[TEST]: Adding arrays of strings with a single allocation each.\n");
+    StringVector cities;
+    const char *some_cities[] = { "Lima", "Quito", "Bogota" };
+    const char *more_cities[] = { "Caracas!", "Santiago, Chile" };
+    const size_t more_lengths[] = { 7, 8 };
+    if (string_vector_init(&cities, 2)
+        && string_vector_add_array(&cities, some_cities, 3)
+        && string_vector_add_sized_array(&cities, more_cities, more_lengths, 2)
+        && string_vector_replace(&cities, 0, "Havana")
+        && string_vector_strlen(&cities, 4) == 8)
+    {
+        char *popped = string_vector_pop(&cities);
+        printf("[TEST]: Passed!\n");
+        printf("Pop-ed item: %s.\n", popped);
+        free(popped);
+        printf("[TEST]: Printing StringVector.\n");
+        string_vector_print(&cities);
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    string_vector_free(&cities);
+
+    printf("[TEST]: Freeing a batch along with the last of its items.\n");
+    StringVector batched;
+    VectorMemoryUsage batched_usage;
+    const char *batched_values[] = { "one", "two", "three" };
+    bool batched_ok = string_vector_init(&batched, 3) && string_vector_add_array(&batched, batched_values, 3)
+        && batched.batch_count == 1 && string_vector_erase(&batched, 0, 1)
+        && string_vector_replace(&batched, 0, "a value not fitting in the batch") && batched.batch_count == 1
+        && string_vector_memory_usage(&batched, &batched_usage) && batched_usage.slack >= 8;
+
+    /* The bytes of erased and replaced items are slack until the batch goes. */
+    char *batched_popped = batched_ok ? string_vector_pop(&batched) : NULL;
+    batched_ok = batched_ok && batched_popped != NULL && strcmp(batched_popped, "three") == 0
+        && batched.batch_count == 0 && strcmp(string_vector_get_at(&batched, 0), "a value not fitting in the batch") == 0;
+    free(batched_popped);
+    string_vector_free(&batched);
+
+    if (batched_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    printf("[TEST]: Editing StringGapVector around its cursor.\n");
+    StringGapVector lines = {0};
+    string_gap_vector_add(&lines, "first");
+    string_gap_vector_add(&lines, "third");
+    string_gap_vector_insert(&lines, "second", 1);
+    string_gap_vector_insert(&lines, "zeroth", 0);
+    string_gap_vector_erase(&lines, 3, 1);
+    string_gap_vector_add(&lines, "last");
+    string_gap_vector_print(&lines);
+
+    StringVector flattened;
+    if (string_gap_vector_get_at(&lines, 2) != NULL
+        && string_gap_vector_strlen(&lines, 3) == 4
+        && string_gap_vector_to_string_vector(&lines, &flattened, true))
+    {
+        printf("[TEST]: Passed!\n");
+        printf("[TEST]: Printing StringVector.\n");
+        string_vector_print(&flattened);
+        string_vector_free(&flattened);
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    string_gap_vector_free(&lines);
+
+    printf("[TEST]: Splitting a buffer into a StringViewVector.\n");
+    const char lines_buffer[] = "alpha\nbeta\n\ngamma\n";
+    StringViewVector views = {0};
+    StringVector owned;
+    if (string_view_vector_split(&views, lines_buffer, sizeof(lines_buffer) - 1, '\n')
+        && views.offset == 4
+        && string_view_vector_get_at(&views, 1) == lines_buffer + 6
+        && string_view_vector_strlen(&views, 2) == 0
+        && string_view_vector_to_string_vector(&views, &owned, true))
+    {
+        printf("[TEST]: Passed!\n");
+        string_view_vector_print(&views);
+        printf("[TEST]: Printing StringVector.\n");
+        string_vector_print(&owned);
+        string_vector_free(&owned);
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    string_view_vector_free(&views);
+
+    printf("[TEST]: Looking up strings through the hash index.\n");
+    StringVector words = {0};
+    char word[16];
+    for (int i = 0; i < 1000; ++i) {
+        snprintf(word, sizeof(word), "word%i", i);
+        string_vector_add(&words, word);
+    }
+
+    size_t found_at = 0;
+    bool index_ok = string_vector_enable_index(&words)
+        && string_vector_find(&words, "word500", &found_at) && found_at == 500
+        && string_vector_erase(&words, 10, 5)
+        && string_vector_find(&words, "word500", &found_at) && found_at == 495
+        && !string_vector_contains(&words, "word12")
+        && string_vector_insert(&words, "word12", 0)
+        && string_vector_find(&words, "word12", &found_at) && found_at == 0
+        && string_vector_replace(&words, 1, "word999")
+        && string_vector_find(&words, "word999", &found_at) && found_at == 1
+        && !string_vector_contains(&words, "word0");
+
+    free(string_vector_pop(&words));
+    index_ok = index_ok && string_vector_find(&words, "word999", &found_at) && found_at == 1;
+
+    if (index_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    string_vector_free(&words);
+
+    printf("[TEST]: Looking up duplicates through the hash index.\n");
+    StringVector duplicates = {0};
+    for (int i = 0; i < 200; ++i) {
+        string_vector_add(&duplicates, i % 2 == 0 ? "even" : "odd");
+    }
+
+    /* Whatever is erased or replaced, the first of the remaining copies must be found. */
+    bool duplicates_ok = string_vector_enable_index(&duplicates)
+        && string_vector_find(&duplicates, "odd", &found_at) && found_at == 1
+        && string_vector_erase(&duplicates, 0, 3)
+        && string_vector_find(&duplicates, "odd", &found_at) && found_at == 0
+        && string_vector_find(&duplicates, "even", &found_at) && found_at == 1
+        && string_vector_replace(&duplicates, 0, "other")
+        && string_vector_find(&duplicates, "odd", &found_at) && found_at == 2;
+
+    free(string_vector_take_at(&duplicates, 1));
+    duplicates_ok = duplicates_ok
+        && string_vector_find(&duplicates, "even", &found_at) && found_at == 2
+        && string_vector_insert(&duplicates, "even", 0)
+        && string_vector_find(&duplicates, "even", &found_at) && found_at == 0
+        && string_vector_find(&duplicates, "odd", &found_at) && found_at == 2
+        && string_vector_erase(&duplicates, 0, 1)
+        && string_vector_find(&duplicates, "even", &found_at) && found_at == 2;
+
+    if (duplicates_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    string_vector_free(&duplicates);
+
+    printf("[TEST]: Sorting StringVector.\n");
+    StringVector unsorted = {0};
+    const char *to_sort[] = { "pear", "apple", "pineapple", "apple", "", "pineapples", "banana" };
+    size_t permutation[7];
+    string_vector_init(&unsorted, 7);
+    string_vector_add_array(&unsorted, to_sort, 7);
+    if (string_vector_sort_permutation(&unsorted, permutation, true)
+        && permutation[0] == 4 && permutation[1] == 1 && permutation[2] == 3
+        && string_vector_sort(&unsorted, false)
+        && strcmp(string_vector_get_at(&unsorted, 5), "pineapple") == 0
+        && string_vector_strlen(&unsorted, 6) == 10)
+    {
+        printf("[TEST]: Passed!\n");
+        printf("[TEST]: Printing StringVector.\n");
+        string_vector_print(&unsorted);
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    string_vector_free(&unsorted);
+
+    printf("[TEST]: Stable sorting of many identical items.\n");
+    StringVector identical = {0};
+    const char *identical_words[] = { "same", "twin", "identical-item" };
+    size_t identical_permutation[3000];
+    for (size_t i = 0; i < 3000; ++i) {
+        string_vector_add(&identical, identical_words[(i * 7) % 3]);
+    }
+
+    bool identical_ok = string_vector_sort_permutation(&identical, identical_permutation, true);
+    for (size_t i = 1; identical_ok && i < 3000; ++i) {
+        int order = strcmp(string_vector_get_at(&identical, identical_permutation[i - 1]),
+                string_vector_get_at(&identical, identical_permutation[i]));
+        identical_ok = order < 0 || (order == 0 && identical_permutation[i - 1] < identical_permutation[i]);
+    }
+
+    if (identical_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    string_vector_free(&identical);
+
+    printf("[TEST]: Copying and freeing a big StringVector in parallel.\n");
+    StringVector big = {0};
+    StringVector big_copy;
+    for (int i = 0; i < 200000; ++i) {
+        snprintf(word, sizeof(word), "item%i", i);
+        string_vector_add(&big, word);
+    }
+
+    libvector_set_threads(3);
+    bool parallel_ok = string_vector_parallel_copy(&big, &big_copy, true) && big_copy.offset == big.offset;
+    for (size_t i = 0; parallel_ok && i < big.offset; i += 997) {
+        parallel_ok = strcmp(string_vector_get_at(&big, i), string_vector_get_at(&big_copy, i)) == 0
+            && string_vector_strlen(&big, i) == string_vector_strlen(&big_copy, i);
+    }
+
+    if (parallel_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    string_vector_parallel_free(&big);
+    string_vector_parallel_free(&big_copy);
+
+    printf("[TEST]: Freeing items of a StringPool which isn't shared in parallel.\n");
+    StringPool *big_pool = string_pool_create(false);
+    StringVector big_pooled;
+    bool big_pooled_ok = big_pool != NULL && string_vector_init(&big_pooled, 1)
+        && string_vector_use_pool(&big_pooled, big_pool);
+    string_pool_release(big_pool);
+
+    for (int i = 0; big_pooled_ok && i < 200000; ++i) {
+        snprintf(word, sizeof(word), "item%i", i);
+        big_pooled_ok = string_vector_add(&big_pooled, word);
+    }
+
+    /* The pool isn't locked, so its items must not be freed by several threads. */
+    if (big_pooled_ok) {
+        string_vector_parallel_free(&big_pooled);
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    libvector_set_threads(0);
+
+    printf("[TEST]: Merging ShardedStringVector shards.\n");
+    ShardedStringVector sharded;
+    StringVector merged;
+    StringVector merged_sorted;
+    const char *expected_merge[] = { "b", "d", "a", "c", "e" };
+    const char *expected_sorted[] = { "a", "b", "c", "d", "e" };
+    bool sharded_ok = sharded_string_vector_init(&sharded, 3, 1)
+        && string_vector_add(sharded_string_vector_get_shard(&sharded, 0), "b")
+        && string_vector_add(sharded_string_vector_get_shard(&sharded, 0), "d")
+        && string_vector_add(sharded_string_vector_get_shard(&sharded, 2), "a")
+        && string_vector_add(sharded_string_vector_get_shard(&sharded, 2), "c")
+        && string_vector_add(sharded_string_vector_get_shard(&sharded, 2), "e")
+        && sharded_string_vector_merge(&sharded, &merged, true)
+        && sharded_string_vector_merge_sorted(&sharded, &merged_sorted, true);
+
+    for (size_t i = 0; sharded_ok && i < 5; ++i) {
+        sharded_ok = strcmp(string_vector_get_at(&merged, i), expected_merge[i]) == 0
+            && strcmp(string_vector_get_at(&merged_sorted, i), expected_sorted[i]) == 0
+            && string_vector_strlen(&merged_sorted, i) == 1;
+    }
+
+    if (sharded_ok && merged.offset == 5 && merged_sorted.offset == 5) {
+        printf("[TEST]: Passed!\n");
+        string_vector_free(&merged);
+        string_vector_free(&merged_sorted);
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    sharded_string_vector_free(&sharded);
+
+    printf("[TEST]: Pinning VersionedStringVector versions.\n");
+    VersionedStringVector versioned;
+    size_t reader;
+    bool versioned_ok = versioned_string_vector_init(&versioned, 1)
+        && versioned_string_vector_register_reader(&versioned, &reader);
+
+    for (int i = 0; versioned_ok && i < 100; ++i) {
+        snprintf(word, sizeof(word), "item%i", i);
+        versioned_ok = versioned_string_vector_add(&versioned, word);
+    }
+
+    versioned_ok = versioned_ok && versioned_string_vector_publish(&versioned);
+    if (versioned_ok) {
+        const VersionedSnapshot *old = versioned_string_vector_pin(&versioned, reader);
+
+        /* The pinned version must neither change nor be freed while a new one is published. */
+        versioned_ok = versioned_string_vector_replace(&versioned, 70, "replaced")
+            && versioned_string_vector_pop(&versioned)
+            && versioned_string_vector_publish(&versioned)
+            && versioned_snapshot_get_size(old) == 100
+            && strcmp(versioned_string_snapshot_get_at(old, 70), "item70") == 0
+            && strcmp(versioned_string_snapshot_get_at(old, 99), "item99") == 0;
+        versioned_string_vector_unpin(&versioned, reader);
+
+        const VersionedSnapshot *new = versioned_string_vector_pin(&versioned, reader);
+        versioned_ok = versioned_ok && versioned_snapshot_get_size(new) == 99
+            && strcmp(versioned_string_snapshot_get_at(new, 70), "replaced") == 0
+            && versioned_string_snapshot_strlen(new, 70) == 8
+            && strcmp(versioned_string_snapshot_get_at(new, 10), "item10") == 0
+            && versioned_string_snapshot_get_at(new, 99) == NULL;
+        versioned_string_vector_unpin(&versioned, reader);
+    }
+
+    if (versioned_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    versioned_string_vector_free(&versioned);
+
+    printf("[TEST]: Sharing StringVector's items until a copy is modified.\n");
+    StringVector original = {0};
+    StringVector snapshot;
+    StringVector snapshot2;
+    size_t shared_before, materialized_before, shared_after, materialized_after;
+    libvector_get_copy_stats(&shared_before, &materialized_before);
+
+    bool cow_ok = string_vector_add(&original, "one") && string_vector_add(&original, "two")
+        && string_vector_copy(&original, &snapshot, true) && string_vector_copy(&snapshot, &snapshot2, true)
+        && snapshot.data == original.data && snapshot2.data == original.data;
+
+    /* The original lets its items go, while both copies keep them. */
+    string_vector_free(&original);
+    cow_ok = cow_ok && strcmp(string_vector_get_at(&snapshot, 1), "two") == 0
+        && string_vector_replace(&snapshot, 1, "three")
+        && strcmp(string_vector_get_at(&snapshot, 1), "three") == 0
+        && strcmp(string_vector_get_at(&snapshot2, 1), "two") == 0;
+
+    string_vector_free(&snapshot);
+    cow_ok = cow_ok && string_vector_add(&snapshot2, "four") && snapshot2.offset == 3;
+
+    libvector_get_copy_stats(&shared_after, &materialized_after);
+    if (cow_ok && shared_after == shared_before + 2 && materialized_after == materialized_before + 1) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    string_vector_free(&snapshot2);
+
+    printf("[TEST]: Handing strings over to StringVector and taking them back.\n");
+    StringVector owner = {0};
+    StringVector moved;
+    char *adopted = strdup("adopted");
+    char *replacement = strdup("replacement");
+    size_t released_size = 0;
+
+    bool owned_ok = string_vector_add_owned(&owner, adopted, 7) && owner.data[0] == adopted
+        && string_vector_add(&owner, "copied") && string_vector_add(&owner, "last")
+        && string_vector_enable_index(&owner)
+        && string_vector_replace_owned(&owner, 1, replacement, 11) && owner.data[1] == replacement;
+
+    char *taken = owned_ok ? string_vector_take_at(&owner, 0) : NULL;
+    owned_ok = owned_ok && taken == adopted && owner.offset == 2
+        && strcmp(string_vector_get_at(&owner, 0), "replacement") == 0
+        && string_vector_find(&owner, "last", &position) && position == 1
+        && !string_vector_contains(&owner, "adopted")
+        && string_vector_move(&owner, &moved) && owner.data == NULL && moved.offset == 2;
+    free(taken);
+
+    char **released = owned_ok ? string_vector_release(&moved, &released_size) : NULL;
+    owned_ok = owned_ok && released != NULL && released_size == 2 && moved.data == NULL
+        && strcmp(released[0], "replacement") == 0 && strcmp(released[1], "last") == 0;
+
+    for (size_t i = 0; released != NULL && i < released_size; ++i) {
+        free(released[i]);
+    }
+    free(released);
+
+    if (owned_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    printf("[TEST]: Reusing item buffers kept by a retaining clear.\n");
+    StringVector slots;
+    bool slots_ok = string_vector_init(&slots, 3) && string_vector_add(&slots, "a rather long first value")
+        && string_vector_add(&slots, "second") && string_vector_add(&slots, "third");
+
+    /* Only the first two buffers fit in the cap, the third one is freed. The first one is reused by a
+     * shorter value and keeps its size, the second one is too small for the next value.
+     */
+    slots_ok = slots_ok && string_vector_clear_retaining(&slots, 33) && slots.offset == 0 && slots.spares == 2
+        && string_vector_add(&slots, "short") && slots.buffer_sizes[0] == 26 && slots.item_sizes[0] == 6
+        && string_vector_add(&slots, "longer than second") && slots.buffer_sizes[1] == 19
+        && slots.spares == 0 && strcmp(string_vector_get_at(&slots, 0), "short") == 0
+        && strcmp(string_vector_get_at(&slots, 1), "longer than second") == 0;
+
+    slots_ok = slots_ok && string_vector_replace(&slots, 1, "smaller") && slots.buffer_sizes[1] == 19
+        && slots.item_sizes[1] == 8 && strcmp(string_vector_get_at(&slots, 1), "smaller") == 0;
+
+    /* Buffers are counted by their size, not their items', so only the first one fits now. */
+    slots_ok = slots_ok && string_vector_clear_retaining(&slots, 30) && slots.spares == 1
+        && slots.data[1] == NULL && string_vector_add(&slots, "a rather long first value")
+        && slots.buffer_sizes[0] == 26 && strcmp(string_vector_get_at(&slots, 0), "a rather long first value") == 0;
+
+    if (slots_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    string_vector_free(&slots);
+
+    printf("[TEST]: Allocating items from a StringPool.\n");
+    StringPool *pool = string_pool_create(true);
+    StringVector pooled;
+    char long_value[5000];
+    memset(long_value, 'x', sizeof(long_value) - 1);
+    long_value[sizeof(long_value) - 1] = '\0';
+
+    bool pooled_ok = pool != NULL && string_vector_init(&pooled, 4) && string_vector_use_pool(&pooled, pool);
+    string_pool_release(pool);
+
+    pooled_ok = pooled_ok && string_vector_add(&pooled, "pooled") && string_vector_add(&pooled, long_value)
+        && string_vector_insert(&pooled, "first", 0) && string_vector_replace(&pooled, 1, "a longer pooled value");
+    char *freed_buffer = pooled_ok ? pooled.data[0] : NULL;
+
+    /* Popped and taken items are plain allocations, whatever they were allocated with. */
+    char *taken_item = pooled_ok ? string_vector_take_at(&pooled, 0) : NULL;
+    char *popped_item = pooled_ok ? string_vector_pop(&pooled) : NULL;
+    pooled_ok = pooled_ok && taken_item != NULL && strcmp(taken_item, "first") == 0
+        && popped_item != NULL && strcmp(popped_item, long_value) == 0
+        && string_vector_add(&pooled, "again") && pooled.data[1] == freed_buffer
+        && strcmp(string_vector_get_at(&pooled, 0), "a longer pooled value") == 0;
+    free(taken_item);
+    free(popped_item);
+
+    if (pooled_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    string_vector_free(&pooled);
+
+    printf("[TEST]: Keeping StringPools in copies of vectors using them.\n");
+    StringPool *single_pool = string_pool_create(false);
+    StringPool *shared_pool = string_pool_create(true);
+    StringVector single_pooled, single_copy, shared_pooled, shared_copy;
+
+    /* A pool which isn't shared stays with its vector, the copy having items of its own. */
+    bool pool_copy_ok = single_pool != NULL && shared_pool != NULL
+        && string_vector_init(&single_pooled, 2) && string_vector_use_pool(&single_pooled, single_pool)
+        && string_vector_add(&single_pooled, "x") && string_vector_copy(&single_pooled, &single_copy, true)
+        && single_copy.data != single_pooled.data && single_copy.pool == NULL
+        && string_vector_add(&single_pooled, "y") && single_pooled.pool == single_pool && single_copy.offset == 1
+        && string_vector_init(&shared_pooled, 2) && string_vector_use_pool(&shared_pooled, shared_pool)
+        && string_vector_add(&shared_pooled, "x") && string_vector_copy(&shared_pooled, &shared_copy, true)
+        && shared_copy.data == shared_pooled.data && string_vector_add(&shared_pooled, "y")
+        && shared_pooled.pool == shared_pool && shared_copy.pool == shared_pool
+        && strcmp(string_vector_get_first(&single_copy), "x") == 0 && strcmp(string_vector_get_last(&shared_pooled), "y") == 0;
+
+    string_pool_release(single_pool);
+    string_pool_release(shared_pool);
+
+    if (pool_copy_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    string_vector_free(&single_pooled);
+    string_vector_free(&single_copy);
+    string_vector_free(&shared_pooled);
+    string_vector_free(&shared_copy);
+
+    printf("[TEST]: Measuring the memory used by vectors.\n");
+    libvector_track_memory(true);
+    StringVector measured;
+    StringVector measured_copy;
+    NumericVector measured_numbers;
+    VectorMemoryUsage usage, copy_usage, numbers_usage, all_usage;
+    size_t tracked_vectors = 0;
+
+    bool usage_ok = string_vector_init(&measured, 4) && string_vector_add(&measured, "one")
+        && string_vector_add(&measured, "three") && string_vector_copy(&measured, &measured_copy, true)
+        && numeric_vector_init(&measured_numbers, 8) && numeric_vector_add(&measured_numbers, 1)
+        && string_vector_memory_usage(&measured, &usage) && string_vector_memory_usage(&measured_copy, &copy_usage)
+        && numeric_vector_memory_usage(&measured_numbers, &numbers_usage)
+        && libvector_get_memory_usage(&all_usage, &tracked_vectors);
+
+    /* The copy shares measured's items, so they're added up once. */
+    usage_ok = usage_ok && usage.payload == 10 && usage.slots == 2 * sizeof(char *)
+        && usage.slack >= 2 * sizeof(char *) && usage.metadata >= 4 * sizeof(size_t)
+        && usage.total == usage.payload + usage.slots + usage.metadata + usage.slack + usage.overhead
+        && copy_usage.total == usage.total && numbers_usage.payload == sizeof(double)
+        && numbers_usage.slack == 7 * sizeof(double) && numbers_usage.slots == 0
+        && tracked_vectors == 3 && all_usage.total == usage.total + numbers_usage.total;
+
+    string_vector_free(&measured);
+    string_vector_free(&measured_copy);
+    numeric_vector_free(&measured_numbers);
+    usage_ok = usage_ok && libvector_get_memory_usage(&all_usage, &tracked_vectors)
+        && tracked_vectors == 0 && all_usage.total == 0;
+    libvector_track_memory(false);
+
+    if (usage_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    printf("[TEST]: Mapping a file's lines into StringVector, with and without an index, and into StringViewVector.\n");
+    char lines_path[] = "/tmp/libvector_lines_XXXXXX";
+    char index_path[sizeof(lines_path) + 6];
+    const char file_lines[] = "alpha\nbeta\n\na line longer than sixteen bytes\ngamma";
+    int lines_fd = mkstemp(lines_path);
+    snprintf(index_path, sizeof(index_path), "%s.index", lines_path);
+
+    bool mapped_ok = lines_fd >= 0 && write(lines_fd, file_lines, sizeof(file_lines) - 1) == (ssize_t) (sizeof(file_lines) - 1);
+    if (lines_fd >= 0) {
+        close(lines_fd);
+    }
+
+    for (int pass = 0; mapped_ok && pass < 3; ++pass) {
+        StringVector mapped;
+
+        /* The second pass builds the index, the third one reads it. */
+        mapped_ok = string_vector_map_file(&mapped, lines_path, pass == 0 ? NULL : index_path)
+            && mapped.offset == 5 && strcmp(string_vector_get_at(&mapped, 0), "alpha") == 0
+            && strcmp(string_vector_get_at(&mapped, 1), "beta") == 0 && string_vector_strlen(&mapped, 2) == 0
+            && strcmp(string_vector_get_at(&mapped, 3), "a line longer than sixteen bytes") == 0
+            && strcmp(string_vector_get_at(&mapped, 4), "gamma") == 0 && string_vector_strlen(&mapped, 4) == 5
+            && string_vector_replace(&mapped, 0, "omega") && string_vector_replace(&mapped, 1, "a longer beta")
+            && string_vector_erase(&mapped, 2, 1) && string_vector_add(&mapped, "delta")
+            && strcmp(string_vector_get_at(&mapped, 1), "a longer beta") == 0
+            && strcmp(string_vector_get_at(&mapped, 4), "delta") == 0;
+
+        string_vector_free(&mapped);
+    }
+
+    /* Views point right into the shared, read-only mapping, where lines still end with \n. */
+    StringViewVector mapped_views;
+    bool views_mapped = mapped_ok && string_view_vector_map_file(&mapped_views, lines_path);
+    mapped_ok = views_mapped && mapped_views.offset == 5
+        && string_view_vector_strlen(&mapped_views, 3) == 32 && string_view_vector_get_at(&mapped_views, 0) == mapped_views.mapped
+        && memcmp(string_view_vector_get_at(&mapped_views, 0), "alpha\n", 6) == 0
+        && memcmp(string_view_vector_get_at(&mapped_views, 4), "gamma", 5) == 0;
+    if (views_mapped) {
+        string_view_vector_free(&mapped_views);
+    }
+
+    unlink(lines_path);
+    unlink(index_path);
+
+    if (mapped_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    printf("[TEST]: Writing StringVector's items to a file.\n");
+    StringVector exported;
+    VectorWriteOptions comma_separated = { ", ", "", false, 0 };
+    char exported_path[] = "/tmp/libvector_export_XXXXXX";
+    char exported_text[8192] = {0};
+    int exported_fd = mkstemp(exported_path);
+
+    /* The long item is written without being copied into the output buffer. */
+    bool export_ok = exported_fd >= 0 && string_vector_init(&exported, 3) && string_vector_add(&exported, "first")
+        && string_vector_add(&exported, long_value) && string_vector_add(&exported, "last")
+        && string_vector_write(&exported, exported_fd, &comma_separated)
+        && pread(exported_fd, exported_text, sizeof(exported_text) - 1, 0) == (ssize_t) (sizeof(long_value) - 1 + 13)
+        && strncmp(exported_text, "first, xxx", 10) == 0 && strcmp(exported_text + sizeof(long_value) + 6, ", last") == 0;
+
+    if (exported_fd >= 0) {
+        close(exported_fd);
+        unlink(exported_path);
+    }
+
+    if (export_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    string_vector_free(&exported);
+
+    printf("[TEST]: Saving and loading StringVectors asynchronously.\n");
+    StringVector checkpointed;
+    StringVector restored;
+    char checkpoint_path[] = "/tmp/libvector_checkpoint_XXXXXX";
+    int checkpoint_fd = mkstemp(checkpoint_path);
+    VectorIO *io = vector_io_create(0, false);
+    uint64_t checkpoint_size = 0;
+    uint64_t restored_size = 0;
+    int checkpoints = 0;
+
+    /* The items are copied when the save is queued, so the vector may be freed before it's done. */
+    bool checkpoint_ok = checkpoint_fd >= 0 && io != NULL && string_vector_init(&checkpointed, 3) && string_vector_init(&restored, 1)
+        && string_vector_add(&checkpointed, "first") && string_vector_add(&checkpointed, "") && string_vector_add(&checkpointed, long_value)
+        && string_vector_save_async(io, &checkpointed, checkpoint_fd, 100, &checkpoint_size, count_success, &checkpoints)
+        && checkpoint_size == 24 + 3 * 8 + 6 + 1 + sizeof(long_value);
+    string_vector_free(&checkpointed);
+
+    checkpoint_ok = checkpoint_ok && string_vector_add(&restored, "kept") && string_vector_enable_index(&restored)
+        && vector_io_poll(io, true) == 1 && checkpoints == 1
+        && string_vector_load_async(io, &restored, checkpoint_fd, 100, &restored_size, count_success, &checkpoints)
+        && vector_io_poll(io, true) == 2 && checkpoints == 2 && restored_size == checkpoint_size && restored.offset == 4
+        && strcmp(string_vector_get_at(&restored, 1), "first") == 0 && string_vector_strlen(&restored, 2) == 0
+        && strcmp(string_vector_get_at(&restored, 3), long_value) == 0 && string_vector_contains(&restored, "first")
+        && string_vector_load_async(io, &restored, checkpoint_fd, 0, NULL, count_success, &checkpoints)
+        && vector_io_poll(io, true) == 1 && checkpoints == 2 && restored.offset == 4;
+
+    vector_io_destroy(io);
+    if (checkpoint_fd >= 0) {
+        close(checkpoint_fd);
+        unlink(checkpoint_path);
+    }
+
+    if (checkpoint_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    string_vector_free(&restored);
+
+    printf("[TEST]: Recovering StringVector from its journal.\n");
+    StringVector journaled;
+    StringVector recovered;
+    char journal_directory[] = "/tmp/libvector_journal_XXXXXX";
+    char journal_path[64] = {0};
+    char log_path[64] = {0};
+    const char *journal_values[] = { "delta", "", "echo" };
+    char *journal_owned = strdup("owned");
+    char *journal_replacement = strdup("replacement");
+    char *journal_popped = NULL;
+    char *journal_taken = NULL;
+
+    bool journal_ok = mkdtemp(journal_directory) != NULL
+        && snprintf(journal_path, sizeof(journal_path), "%s/strings", journal_directory) > 0
+        && snprintf(log_path, sizeof(log_path), "%s.log", journal_path) > 0
+        && string_vector_init(&journaled, 2) && string_vector_open_journal(&journaled, journal_path, 0)
+        && string_vector_add(&journaled, "alpha") && string_vector_add(&journaled, long_value)
+        && string_vector_add_owned(&journaled, journal_owned, 5) && string_vector_add_array(&journaled, journal_values, 3)
+        && string_vector_insert(&journaled, "bravo", 1) && string_vector_replace(&journaled, 0, "a much longer alpha")
+        && string_vector_replace_owned(&journaled, 3, journal_replacement, 11) && string_vector_erase(&journaled, 4, 2)
+        && (journal_taken = string_vector_take_at(&journaled, 1)) != NULL && (journal_popped = string_vector_pop(&journaled)) != NULL
+        && string_vector_copy(&journaled, &journaled, false) && string_vector_close_journal(&journaled)
+        && string_vector_init(&recovered, 1) && string_vector_open_journal(&recovered, journal_path, 0)
+        && recovered.offset == journaled.offset && recovered.offset == 6;
+    for (size_t i = 0; journal_ok && i < recovered.offset; ++i) {
+        journal_ok = strcmp(string_vector_get_at(&recovered, i), string_vector_get_at(&journaled, i)) == 0;
+    }
+
+    /* Sorting can't be logged, so the journal is compacted when closed. */
+    journal_ok = journal_ok && strcmp(journal_taken, "bravo") == 0 && strcmp(journal_popped, "echo") == 0
+        && string_vector_sort(&recovered, true) && string_vector_close_journal(&recovered) && string_vector_clear(&recovered)
+        && string_vector_open_journal(&recovered, journal_path, 0) && recovered.offset == 6
+        && strcmp(string_vector_get_at(&recovered, 1), "a much longer alpha") == 0 && strcmp(string_vector_get_at(&recovered, 5), long_value) == 0
+        && string_vector_clear_retaining(&recovered, 1024) && string_vector_add(&recovered, "after clearing")
+        && string_vector_close_journal(&recovered) && string_vector_clear(&recovered)
+        && string_vector_open_journal(&recovered, journal_path, 0) && recovered.offset == 1
+        && strcmp(string_vector_get_first(&recovered), "after clearing") == 0;
+
+    free(journal_taken);
+    free(journal_popped);
+
+    if (journal_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    string_vector_free(&journaled);
+    string_vector_free(&recovered);
+    unlink(journal_path);
+    unlink(log_path);
+    rmdir(journal_directory);
+
+    printf("[TEST]: Saving StringVector compressed and loading slices of it.\n");
+    StringVector uncompressed;
+    StringVector sliced;
+    char compressed_path[] = "/tmp/libvector_compressed_XXXXXX";
+    int compressed_fd = mkstemp(compressed_path);
+    char compressed_item[64];
+    uint64_t compressed_size = 0;
+    size_t compressed_bytes = 0;
+    size_t compressed_count = 0;
+
+    bool compressed_ok = compressed_fd >= 0 && string_vector_init(&uncompressed, 1) && string_vector_init(&sliced, 1);
+    for (int i = 0; compressed_ok && i < 20000; ++i) {
+        snprintf(compressed_item, sizeof(compressed_item), "item number %i of a repetitive vector", i);
+        compressed_ok = string_vector_add(&uncompressed, i % 1000 == 0 ? "" : (i == 15000 ? long_value : compressed_item));
+        compressed_bytes += string_vector_strlen(&uncompressed, i);
+    }
+
+    /* 20000 items span several blocks, and the slice starts and ends in the middle of blocks. */
+    compressed_ok = compressed_ok && string_vector_save_compressed(&uncompressed, compressed_fd, 100, &compressed_size)
+        && compressed_size < compressed_bytes / 4 && string_vector_count_compressed(compressed_fd, 100, &compressed_count)
+        && compressed_count == 20000 && string_vector_add(&sliced, "kept")
+        && string_vector_load_compressed(&sliced, compressed_fd, 100, 12345, 5000) && sliced.offset == 5001
+        && string_vector_load_compressed(&sliced, compressed_fd, 100, 20000, 0) && sliced.offset == 5001
+        && !string_vector_load_compressed(&sliced, compressed_fd, 100, 19999, 2)
+        && !string_vector_load_compressed(&sliced, compressed_fd, 0, 0, 1) && sliced.offset == 5001;
+    for (size_t i = 0; compressed_ok && i < 5000; ++i) {
+        compressed_ok = strcmp(string_vector_get_at(&sliced, i + 1), string_vector_get_at(&uncompressed, i + 12345)) == 0;
+    }
+
+    compressed_ok = compressed_ok && string_vector_clear(&sliced)
+        && string_vector_load_compressed(&sliced, compressed_fd, 100, 0, 20000) && sliced.offset == 20000;
+    for (size_t i = 0; compressed_ok && i < 20000; ++i) {
+        compressed_ok = strcmp(string_vector_get_at(&sliced, i), string_vector_get_at(&uncompressed, i)) == 0;
+    }
+
+    if (compressed_fd >= 0) {
+        close(compressed_fd);
+        unlink(compressed_path);
+    }
+
+    if (compressed_ok) {
+        printf("[TEST]: Passed!\n");
+    } else {
+        fprintf(stderr, "[TEST]: Failed!\n");
+        return 1;
+    }
+
+    string_vector_free(&uncompressed);
+    string_vector_free(&sliced);
+
     printf("[TEST]: Clearing vector.\n");
     if (string_vector_clear(&names)) {
         printf("[TEST]: Passed!\n");